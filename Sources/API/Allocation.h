@@ -0,0 +1,102 @@
+// =======================================================================================
+// Allocation.h : The memory allocation counter shared between all UCSO modules.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace UCSO
+{
+	typedef struct Allocations
+	{
+		int count = 0;
+		long long bytes = 0;
+	} AllocationCounter;
+
+	// The counter of the current thread, or nullptr if the allocations aren't counted
+	inline AllocationCounter*& GetAllocationCounter()
+	{
+		static thread_local AllocationCounter* counter = nullptr;
+		return counter;
+	}
+
+	inline void CountAllocation(size_t size)
+	{
+		AllocationCounter* counter = GetAllocationCounter();
+
+		if (counter) { counter->count++; counter->bytes += size; }
+	}
+
+	// Allocates the memory of the counted containers
+	inline void* CountedAllocate(size_t size)
+	{
+		CountAllocation(size);
+
+		void* memory = malloc(size ? size : 1);
+
+		if (!memory) throw std::bad_alloc();
+
+		return memory;
+	}
+
+	// The same as _strdup, but the allocation is counted
+	inline char* CountedDuplicate(const char* string)
+	{
+		CountAllocation(strlen(string) + 1);
+
+		return _strdup(string);
+	}
+
+	// Allocates the container memory with CountedAllocate. The API and the cargo DLL use it instead of replacing operator new, which belongs to the whole module
+	template<class Type> struct CountingAllocator
+	{
+		typedef Type value_type;
+
+		CountingAllocator() = default;
+		template<class Other> CountingAllocator(const CountingAllocator<Other>&) { }
+
+		Type* allocate(size_t count) { return static_cast<Type*>(CountedAllocate(count * sizeof(Type))); }
+		void deallocate(Type* memory, size_t) { free(memory); }
+
+		template<class Other> bool operator==(const CountingAllocator<Other>&) const { return true; }
+		template<class Other> bool operator!=(const CountingAllocator<Other>&) const { return false; }
+	};
+
+	template<class Type> using CountedVector = std::vector<Type, CountingAllocator<Type>>;
+	template<class Key, class Value> using CountedMap = std::map<Key, Value, std::less<Key>, CountingAllocator<std::pair<const Key, Value>>>;
+	typedef std::basic_string<char, std::char_traits<char>, CountingAllocator<char>> CountedString;
+
+	// Counts the allocations of the current thread from its construction to its destruction
+	class AllocationScope
+	{
+	public:
+		AllocationScope(AllocationCounter& counter) : previousCounter(GetAllocationCounter()) { GetAllocationCounter() = &counter; }
+
+		~AllocationScope() { GetAllocationCounter() = previousCounter; }
+
+	private:
+		AllocationCounter* previousCounter;
+	};
+}
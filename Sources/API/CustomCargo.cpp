@@ -41,7 +41,16 @@ const char* UCSO::CustomCargo::SetSpawnName(const char* spawnName)
 { 
 	std::string name = spawnName;
 	UCSO::SetSpawnName(name);
-	return _strdup(name.c_str());
+	return UCSO::CountedDuplicate(name.c_str());
 }
 
-void UCSO::CustomCargo::SetGroundRotation(VESSELSTATUS2& status, double spawnHeight) { UCSO::SetGroundRotation(status, spawnHeight); }
\ No newline at end of file
+void UCSO::CustomCargo::SetGroundRotation(VESSELSTATUS2& status, double spawnHeight) { UCSO::SetGroundRotation(status, spawnHeight); }
+
+const char* UCSO::CustomCargo::GetScenarioItem(const char* line, const char* item)
+{
+	ScenarioLine scenarioLine;
+
+	if (!TokenizeScenarioLine(line, scenarioLine) || !scenarioLine.IsKey(item)) return nullptr;
+
+	return scenarioLine.value;
+}
\ No newline at end of file
@@ -115,6 +115,16 @@ namespace UCSO
 
 		virtual ~CustomCargo();
 
+		// The methods added after version 1.1.1 are added after the destructor, so the older methods keep their virtual table order.
+
+		// This method will compare the scenario line key with an item name, without copying the line.
+		// This is useful for reading the cargo items in clbkLoadStateEx, and passing the other lines to ParseScenarioLineEx.
+		// Parameters:
+		//	line: the scenario line, as read by oapiReadScenario_nextline.
+		//	item: the item name (e.g. Unpacked).
+		// Returns the item value (the rest of the line after the key) if the line key is the item, nullptr if not.
+		virtual const char* GetScenarioItem(const char* line, const char* item);
+
 	private:
 		CustomCargoAPI* customCargoAPI;
 	};
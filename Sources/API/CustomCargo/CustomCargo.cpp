@@ -20,10 +20,43 @@
 // =======================================================================================
 
 #include "CustomCargo.h"
+#include "../Trace.h"
+#include "../Runtime.h"
+
+typedef UCSO::TraceFunction (*GetTraceFunction)();
 
 std::vector<UCSO::CustomCargo*> customCargoes;
 
-void AddCustomCargo(UCSO::CustomCargo* cargo) { customCargoes.push_back(cargo); }
+// Gets the trace function from the cargo DLL once. The DLL is kept loaded, as it holds the trace buffer
+void LoadTraceFunction()
+{
+	// The static initialization is thread safe, so the DLL is loaded once even if the cargoes are added on different threads
+	static const bool traceLoaded = []()
+	{
+		HINSTANCE cargoDll = LoadLibraryA("Modules/UCSO/Cargo.dll");
+
+		if (!cargoDll) return false;
+
+		GetTraceFunction GetCargoTraceFunction = reinterpret_cast<GetTraceFunction>(GetProcAddress(cargoDll, "GetUCSOTraceFunction"));
+
+		if (GetCargoTraceFunction) UCSO::TraceScope::GetTraceFunction() = GetCargoTraceFunction();
+
+		return true;
+	}();
+
+	static_cast<void>(traceLoaded);
+}
+
+void AddCustomCargo(UCSO::CustomCargo* cargo)
+{
+	LoadTraceFunction();
+
+	UCSO::TraceScope traceScope("CustomCargo::AddCustomCargo");
+
+	customCargoes.push_back(cargo);
+
+	if (UCSO::RuntimeStatistics* runtime = UCSO::GetRuntimeStatistics()) runtime->customCargoCount = int(customCargoes.size());
+}
 
 void DeleteCustomCargo(UCSO::CustomCargo* cargo)
 {
@@ -31,10 +64,13 @@ void DeleteCustomCargo(UCSO::CustomCargo* cargo)
 	std::vector<UCSO::CustomCargo*>::iterator it = find(customCargoes.begin(), customCargoes.end(), cargo);
 	// If found, delete it
 	if (it != customCargoes.end()) customCargoes.erase(it);
+
+	if (UCSO::RuntimeStatistics* runtime = UCSO::GetRuntimeStatistics()) runtime->customCargoCount = int(customCargoes.size());
 }
 
 UCSO::CustomCargo* GetCustomCargo(OBJHANDLE handle)
 {
+	// It isn't traced, as the API calls it for every vessel it checks
 	for (auto const& cargo : customCargoes) if (cargo->GetCargoHandle() == handle) return cargo;
 	return nullptr;
 };
\ No newline at end of file
@@ -21,6 +21,7 @@
 
 #pragma once
 #include <vector>
+#include <algorithm>
 #include "../CustomCargo.h"
 
 DLLCLBK void AddCustomCargo(UCSO::CustomCargo* cargo);
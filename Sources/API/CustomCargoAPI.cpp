@@ -25,25 +25,41 @@ UCSO::CustomCargoAPI::CustomCargoAPI(CustomCargo* customCargo)
 {
 	this->customCargo = customCargo;
 
-	// Load the custom cargo DLL
-	customCargoDll = LoadLibraryA("Modules/UCSO/CustomCargo.dll");
-
-	if (customCargoDll)
-	{
-		AddCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "AddCustomCargo"));
-
-		DeleteCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "DeleteCustomCargo"));
-	}
+	const RegistryFunctions& registry = GetRegistryFunctions();
 
 	// If the DLL is loaded and both functions are found
-	if (AddCustomCargo && DeleteCustomCargo) AddCustomCargo(customCargo);
+	if (registry.AddCustomCargo && registry.DeleteCustomCargo) registry.AddCustomCargo(customCargo);
 	else
 	{
-		if (customCargoDll) FreeLibrary(customCargoDll);
 		oapiWriteLog("UCSO Fatal Error: Couldn't load the custom cargo API");
 		// Kill Orbiter
 		throw;
 	}
 }
 
-UCSO::CustomCargoAPI::~CustomCargoAPI() { DeleteCustomCargo(customCargo); FreeLibrary(customCargoDll); }
\ No newline at end of file
+UCSO::CustomCargoAPI::~CustomCargoAPI() { GetRegistryFunctions().DeleteCustomCargo(customCargo); }
+
+const UCSO::CustomCargoAPI::RegistryFunctions& UCSO::CustomCargoAPI::GetRegistryFunctions()
+{
+	// The static initialization is thread safe, so the DLL is loaded once even if the cargoes are created on different threads
+	static const RegistryFunctions registry = []()
+	{
+		RegistryFunctions functions;
+
+		// Load the custom cargo DLL. It's kept loaded, as it holds the registered cargoes
+		HINSTANCE customCargoDll = LoadLibraryA("Modules/UCSO/CustomCargo.dll");
+
+		if (customCargoDll)
+		{
+			functions.AddCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "AddCustomCargo"));
+
+			functions.DeleteCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "DeleteCustomCargo"));
+
+			if (!functions.AddCustomCargo || !functions.DeleteCustomCargo) FreeLibrary(customCargoDll);
+		}
+
+		return functions;
+	}();
+
+	return registry;
+}
\ No newline at end of file
@@ -35,8 +35,13 @@ namespace UCSO
 
 		typedef void (*CustomCargoFunction)(CustomCargo*);
 
-		HINSTANCE customCargoDll;
-		CustomCargoFunction AddCustomCargo = nullptr;
-		CustomCargoFunction DeleteCustomCargo = nullptr;
+		// The custom cargo DLL functions, which are resolved once for all custom cargoes in the module
+		struct RegistryFunctions
+		{
+			CustomCargoFunction AddCustomCargo = nullptr;
+			CustomCargoFunction DeleteCustomCargo = nullptr;
+		};
+
+		static const RegistryFunctions& GetRegistryFunctions();
 	};
 }
\ No newline at end of file
@@ -22,6 +22,16 @@
 #pragma once
 #include <Orbitersdk.h>
 #include <string>
+#include <sstream>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include "Vessel.h"
+#include "Trace.h"
+#include "Allocation.h"
+#include "Runtime.h"
 
 namespace UCSO
 {
@@ -44,18 +54,295 @@ namespace UCSO
 		int unpackingDelay;
 	} DataStruct;
 
-	static void SetSpawnName(std::string& name)
+	// The cargo record, which is kept instead of the cargo vessel when the cargo is stored
+	typedef struct Record
 	{
-		for (int index = 0; ++index;)
+		std::string name;
+		std::string className;
+		double mass;
+		DataStruct dataStruct;
+	} CargoRecord;
+
+	// Writes the cargo record mass and data to the stream, as the same data is read by ReadCargoRecord
+	inline void WriteCargoRecord(std::ostream& stream, const CargoRecord& record)
+	{
+		const DataStruct& dataStruct = record.dataStruct;
+
+		stream << record.mass << ' ' << dataStruct.type << ' ' << dataStruct.netMass;
+
+		switch (dataStruct.type)
+		{
+		case Vessel::RESOURCE:
+			stream << ' ' << dataStruct.resource;
+
+			break;
+		case Vessel::UNPACKABLE_ONLY:
+		case Vessel::PACKABLE_UNPACKABLE:
+			stream << ' ' << dataStruct.unpackingType << ' ' << dataStruct.spawnCount << ' ' << dataStruct.unpacked << ' ' << dataStruct.breathable;
+
+			switch (dataStruct.unpackingType)
+			{
+			case Vessel::UCSO_RESOURCE:
+				stream << ' ' << dataStruct.resource;
+
+				break;
+			case Vessel::ORBITER_VESSEL:
+				stream << ' ' << dataStruct.spawnModule << ' ' << dataStruct.unpackingMode;
+
+				if (dataStruct.unpackingMode == Vessel::DELAYING) stream << ' ' << dataStruct.unpackingDelay;
+
+				break;
+			}
+
+			break;
+		default:
+			break;
+		}
+	}
+
+	// Reads the cargo record mass and data from the stream. Returns false if the data is invalid
+	inline bool ReadCargoRecord(std::istream& stream, CargoRecord& record)
+	{
+		DataStruct& dataStruct = record.dataStruct;
+
+		stream >> record.mass >> dataStruct.type >> dataStruct.netMass;
+
+		switch (dataStruct.type)
+		{
+		case Vessel::RESOURCE:
+			stream >> dataStruct.resource;
+
+			break;
+		case Vessel::UNPACKABLE_ONLY:
+		case Vessel::PACKABLE_UNPACKABLE:
+			stream >> dataStruct.unpackingType >> dataStruct.spawnCount >> dataStruct.unpacked >> dataStruct.breathable;
+
+			switch (dataStruct.unpackingType)
+			{
+			case Vessel::UCSO_RESOURCE:
+				stream >> dataStruct.resource;
+
+				break;
+			case Vessel::ORBITER_VESSEL:
+				stream >> dataStruct.spawnModule >> dataStruct.unpackingMode;
+
+				if (dataStruct.unpackingMode == Vessel::DELAYING) stream >> dataStruct.unpackingDelay;
+
+				break;
+			}
+
+			break;
+		default:
+			break;
+		}
+
+		return !stream.fail();
+	}
+
+	// The first bytes of the inventory snapshot files, which include the format version
+	const char INVENTORY_SNAPSHOT_MAGIC[8] = { 'U', 'C', 'S', 'O', 'I', 'N', 'V', '1' };
+
+	// Writes the cargo records to an inventory snapshot, as the same data is read by ReadInventorySnapshot
+	inline std::string WriteInventorySnapshot(const std::map<int, CargoRecord>& recordMap)
+	{
+		std::string buffer(INVENTORY_SNAPSHOT_MAGIC, sizeof(INVENTORY_SNAPSHOT_MAGIC));
+
+		auto write = [&buffer](const auto& value) { buffer.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+		auto writeString = [&buffer, &write](const std::string& value)
+		{
+			uint16_t length = static_cast<uint16_t>(std::min(value.size(), size_t(UINT16_MAX)));
+
+			write(length);
+			buffer.append(value, 0, length);
+		};
+
+		write(static_cast<uint32_t>(recordMap.size()));
+
+		for (auto const& recordPair : recordMap)
+		{
+			const CargoRecord& record = recordPair.second;
+			const DataStruct& dataStruct = record.dataStruct;
+
+			write(static_cast<int32_t>(recordPair.first));
+			writeString(record.name);
+			writeString(record.className);
+			write(record.mass);
+
+			write(static_cast<int32_t>(dataStruct.type));
+			write(dataStruct.netMass);
+			writeString(dataStruct.resource);
+			write(static_cast<int32_t>(dataStruct.unpackingType));
+			write(static_cast<int32_t>(dataStruct.spawnCount));
+			write(static_cast<uint8_t>((dataStruct.unpacked ? 1 : 0) | (dataStruct.breathable ? 2 : 0)));
+			write(dataStruct.unpackedHeight);
+			writeString(dataStruct.spawnName);
+			writeString(dataStruct.spawnModule);
+			write(static_cast<int32_t>(dataStruct.unpackingMode));
+			write(static_cast<int32_t>(dataStruct.unpackingDelay));
+		}
+
+		return buffer;
+	}
+
+	// Reads the cargo records from an inventory snapshot. Returns false if the snapshot is invalid, and the records are left unchanged
+	inline bool ReadInventorySnapshot(const char* data, size_t size, std::map<int, CargoRecord>& recordMap)
+	{
+		size_t offset = 0;
+
+		// Each read fails if the value is past the end of the snapshot
+		auto read = [&](auto& value)
 		{
-			// Add the index to the string. c_str() is used to avoid a bug
-			std::string spawnName = name.c_str() + std::to_string(index);
+			if (size - offset < sizeof(value)) return false;
+
+			memcpy(&value, data + offset, sizeof(value));
+			offset += sizeof(value);
+
+			return true;
+		};
+
+		auto readString = [&](std::string& value)
+		{
+			uint16_t length;
+
+			if (!read(length) || size - offset < length) return false;
+
+			value.assign(data + offset, length);
+			offset += length;
+
+			return true;
+		};
+
+		char magic[sizeof(INVENTORY_SNAPSHOT_MAGIC)];
+		uint32_t count;
+
+		if (!read(magic) || memcmp(magic, INVENTORY_SNAPSHOT_MAGIC, sizeof(magic)) || !read(count)) return false;
+
+		std::map<int, CargoRecord> readMap;
+
+		for (uint32_t index = 0; index < count; index++)
+		{
+			int32_t slot, type, unpackingType, spawnCount, unpackingMode, unpackingDelay;
+			uint8_t flags;
+
+			CargoRecord record;
+			DataStruct& dataStruct = record.dataStruct;
+
+			if (!(read(slot) && readString(record.name) && readString(record.className) && read(record.mass) &&
+				read(type) && read(dataStruct.netMass) && readString(dataStruct.resource) && read(unpackingType) &&
+				read(spawnCount) && read(flags) && read(dataStruct.unpackedHeight) && readString(dataStruct.spawnName) &&
+				readString(dataStruct.spawnModule) && read(unpackingMode) && read(unpackingDelay))) return false;
+
+			dataStruct.type = type;
+			dataStruct.unpackingType = unpackingType;
+			dataStruct.spawnCount = spawnCount;
+			dataStruct.unpacked = (flags & 1) != 0;
+			dataStruct.breathable = (flags & 2) != 0;
+			dataStruct.unpackingMode = unpackingMode;
+			dataStruct.unpackingDelay = unpackingDelay;
+
+			readMap[slot] = std::move(record);
+		}
+
+		recordMap = std::move(readMap);
+
+		return true;
+	}
+
+	// Escapes the vessel name for a file name. The letters, the digits, '-' and '.' are kept, and the other characters are written as %XX,
+	// so the escaped name has no path separators, spaces or underscores
+	inline std::string EscapeFileName(const std::string& name)
+	{
+		static const char digits[] = "0123456789ABCDEF";
+
+		std::string escapedName;
+
+		for (char character : name)
+		{
+			uint8_t byte = uint8_t(character);
+
+			if (isalnum(byte) || byte == '-' || byte == '.') escapedName += character;
+			else
+			{
+				escapedName += '%';
+				escapedName += digits[byte >> 4];
+				escapedName += digits[byte & 15];
+			}
+		}
+
+		return escapedName;
+	}
+
+	// Hashes the scenario line key with FNV-1a. The hashes of the known keys are computed at compile time, to be used as switch cases
+	constexpr uint32_t HashScenarioKey(const char* key, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+
+		for (size_t index = 0; index < length; ++index) hash = (hash ^ uint8_t(key[index])) * 16777619u;
+
+		return hash;
+	}
+
+	template<size_t length> constexpr uint32_t HashScenarioKey(const char(&key)[length]) { return HashScenarioKey(key, length - 1); }
+
+	// A scenario line split in place into its key and its value, so the line isn't copied
+	struct ScenarioLine
+	{
+		const char* key = nullptr;
+		size_t keyLength = 0;
+		const char* value = nullptr; // The rest of the line after the key
+		uint32_t keyHash = 0;
+
+		// Compares the key, as different keys can have the same hash
+		bool IsKey(const char* name) const { return strlen(name) == keyLength && !strncmp(key, name, keyLength); }
+
+		int GetInt() const { return int(strtol(value, nullptr, 10)); }
+
+		double GetFloat() const { return strtod(value, nullptr); }
+	};
+
+	// Splits the scenario line into its key and its value. Returns false if the line is empty
+	inline bool TokenizeScenarioLine(const char* line, ScenarioLine& scenarioLine)
+	{
+		while (isspace(uint8_t(*line))) ++line;
+
+		if (!*line) return false;
+
+		scenarioLine.key = line;
+
+		while (*line && !isspace(uint8_t(*line))) ++line;
+
+		scenarioLine.keyLength = line - scenarioLine.key;
+		scenarioLine.keyHash = HashScenarioKey(scenarioLine.key, scenarioLine.keyLength);
+
+		while (isspace(uint8_t(*line))) ++line;
+
+		scenarioLine.value = line;
+
+		return true;
+	}
+
+	// The name can be a counted string, so the cargo steps count the allocations of the spawned names.
+	// The probing starts from startIndex, so a batch of the same name can continue after the last taken index. Returns the taken index
+	template<class String> int SetSpawnName(String& name, int startIndex = 1)
+	{
+		TraceScope traceScope("SetSpawnName");
+
+		// c_str() is used to avoid a bug
+		String spawnName = name.c_str();
+		size_t nameLength = spawnName.size();
+
+		for (int index = startIndex;; ++index)
+		{
+			// Replace the previous index, so the string isn't allocated again for every probe
+			spawnName.resize(nameLength);
+			spawnName += std::to_string(index).c_str();
 			// If the spawn name doesn't exists
-			if (!oapiGetVesselByName(&spawnName[0])) { name = spawnName; return; }
+			if (!oapiGetVesselByName(&spawnName[0])) { name = spawnName; return index; }
 		}
 	}
 
-	static MATRIX3 RotationMatrix(VECTOR3 angles)
+	inline MATRIX3 RotationMatrix(VECTOR3 angles)
 	{
 		MATRIX3 m;
 		MATRIX3 RM_X, RM_Y, RM_Z;
@@ -69,12 +356,20 @@ namespace UCSO
 		return m;
 	}
 
-	static void SetGroundRotation(VESSELSTATUS2& status, double height)
+	// Single axis rotations, which are the same as RotationMatrix with the other angles set to 0, with 2 instead of 6 trigonometric calls
+	inline MATRIX3 RotationMatrixX(double angle) { double c = cos(angle), s = sin(angle); return _M(1, 0, 0, 0, c, -s, 0, s, c); }
+
+	inline MATRIX3 RotationMatrixY(double angle) { double c = cos(angle), s = sin(angle); return _M(c, 0, s, 0, 1, 0, -s, 0, c); }
+
+	inline MATRIX3 RotationMatrixZ(double angle) { double c = cos(angle), s = sin(angle); return _M(c, -s, 0, s, c, 0, 0, 0, 1); }
+
+	inline void SetGroundRotation(VESSELSTATUS2& status, double height)
 	{
-		MATRIX3 rot1 = RotationMatrix({ 0, PI05 - status.surf_lng, 0 });
-		MATRIX3 rot2 = RotationMatrix({ -status.surf_lat, 0, 0 });
-		MATRIX3 rot3 = RotationMatrix({ 0, 0, PI + status.surf_hdg });
-		MATRIX3 rot4 = RotationMatrix({ PI05, 0, 0 });
+		MATRIX3 rot1 = RotationMatrixY(PI05 - status.surf_lng);
+		MATRIX3 rot2 = RotationMatrixX(-status.surf_lat);
+		MATRIX3 rot3 = RotationMatrixZ(PI + status.surf_hdg);
+		// The last rotation doesn't depend on the status
+		static const MATRIX3 rot4 = RotationMatrixX(PI05);
 		MATRIX3 RotMatrix_Def = mul(rot1, mul(rot2, mul(rot3, rot4)));
 
 		status.arot.x = atan2(RotMatrix_Def.m23, RotMatrix_Def.m33);
@@ -0,0 +1,71 @@
+// =======================================================================================
+// Runtime.h : The live runtime figures shared between all UCSO modules.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <Orbitersdk.h>
+
+namespace UCSO
+{
+	// The live runtime figures, which are kept in the cargo DLL and updated by all modules.
+	// The counts are always updated. The times are only measured while the timing is enabled (e.g. by the diagnostics MFD).
+	struct RuntimeStatistics
+	{
+		bool timing = false;
+
+		int carrierCount = 0;         // The vessels which use the vessels' API
+		int slotCount = 0;            // The slots set by these vessels
+		int cargoCount[4] = { };      // The cargoes by the cargo type (static, resource, packable and unpackable, unpackable only)
+		int customCargoCount = 0;     // The custom cargoes in the custom cargo registry
+
+		int awakeCount = 0;           // The cargoes which weren't landed or had a pending unpacking in the last frame
+		int settledCount = 0;         // The landed cargoes without a pending unpacking in the last frame
+
+		double frameTime = 0;         // The step time of all cargoes in the last frame in microseconds
+
+		// The names are copied, as the vessel DLL which made the call can be unloaded
+		char slowestCall[32] = { };   // The slowest API method in the last second
+		double slowestCallTime = 0;   // Its wall time in microseconds
+		char windowSlowestCall[32] = { }; // The slowest API method in the current second
+		double windowSlowestCallTime = 0;
+
+		int meshCacheHits = 0;        // The pallet packed mesh lookups which were found in the cache
+		int meshCacheMisses = 0;      // The pallet packed mesh lookups which read the configuration file
+	};
+
+	typedef RuntimeStatistics* (*GetRuntimeStatisticsFunction)();
+
+	// Gets the runtime figures from the cargo DLL once, or nullptr if UCSO isn't installed. The DLL is kept loaded, as it holds the figures
+	inline RuntimeStatistics* GetRuntimeStatistics()
+	{
+		static RuntimeStatistics* runtime = []() -> RuntimeStatistics*
+		{
+			HINSTANCE cargoDll = LoadLibraryA("Modules/UCSO/Cargo.dll");
+
+			if (!cargoDll) return nullptr;
+
+			GetRuntimeStatisticsFunction GetCargoRuntime = reinterpret_cast<GetRuntimeStatisticsFunction>(GetProcAddress(cargoDll, "GetUCSORuntimeStatistics"));
+
+			return GetCargoRuntime ? GetCargoRuntime() : nullptr;
+		}();
+
+		return runtime;
+	}
+}
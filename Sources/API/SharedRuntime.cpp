@@ -0,0 +1,109 @@
+// =======================================================================================
+// SharedRuntime.cpp : The shared runtime's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include "SharedRuntime.h"
+#include "..\Cargo\CargoConfig.h"
+
+namespace
+{
+	// The runtime of the modules which couldn't load the cargo DLL, so the API instances work without UCSO as before
+	class MissingRuntime : public UCSO::SharedRuntime
+	{
+	public:
+		const char* GetVersion() override { return nullptr; }
+		CustomCargoFunction GetCustomCargoFunction() override { return nullptr; }
+		UCSO::RuntimeStatistics* GetStatistics() override { return nullptr; }
+		UCSO::TraceFunction GetTraceFunction() override { return nullptr; }
+		bool FlushTrace() override { return false; }
+		bool GetDrainUnpackedResources() override { return false; }
+		double GetContainerMass() override { return UCSO::DEFAULT_CONTAINER_MASS; }
+
+		std::shared_ptr<const UCSO::CargoCatalog::Snapshot> GetCargoSnapshot() override { return snapshot; }
+		std::shared_ptr<const UCSO::CargoCatalog::Snapshot> UpdateCargoCatalog() override { return snapshot; }
+		void RegisterVessel(UCSO::Vessel*, OBJHANDLE, int) override { }
+		int GetInterfaceVersion(UCSO::Vessel*) override { return 0; }
+		UCSO::Vessel* GetRegisteredVessel(OBJHANDLE) override { return nullptr; }
+		OBJHANDLE GetRegisteredHandle(UCSO::Vessel*) override { return nullptr; }
+
+	private:
+		std::shared_ptr<const UCSO::CargoCatalog::Snapshot> snapshot = std::make_shared<UCSO::CargoCatalog::Snapshot>();
+	};
+}
+
+UCSO::SharedRuntime* UCSO::SharedRuntime::instance = nullptr;
+HINSTANCE UCSO::SharedRuntime::cargoDll = nullptr;
+int UCSO::SharedRuntime::refCount = 0;
+std::mutex UCSO::SharedRuntime::instanceMutex;
+
+UCSO::SharedRuntime* UCSO::SharedRuntime::Acquire()
+{
+	std::lock_guard<std::mutex> lock(instanceMutex);
+
+	// If the module has the runtime already
+	if (refCount++ > 0) return instance;
+
+	// Load cargo DLL. It's kept loaded until the last reference, as it holds the runtime and the trace buffer
+	cargoDll = LoadLibraryA("Modules/UCSO/Cargo.dll");
+
+	AcquireRuntimeFunction AcquireCargoRuntime = nullptr;
+
+	if (cargoDll) AcquireCargoRuntime = reinterpret_cast<AcquireRuntimeFunction>(GetProcAddress(cargoDll, "AcquireUCSORuntime"));
+
+	// If the DLL isn't loaded or the function couldn't be found
+	if (!AcquireCargoRuntime)
+	{
+		if (cargoDll) FreeLibrary(cargoDll);
+		cargoDll = nullptr;
+
+		static MissingRuntime missingRuntime;
+		instance = &missingRuntime;
+	}
+	else instance = AcquireCargoRuntime();
+
+	if (!instance->GetVersion()) oapiWriteLog("UCSO API Warning: Couldn't load the cargo API");
+
+	// Trace the API methods of this module if the tracing is enabled
+	TraceScope::GetTraceFunction() = instance->GetTraceFunction();
+
+	return instance;
+}
+
+void UCSO::SharedRuntime::Release()
+{
+	std::lock_guard<std::mutex> lock(instanceMutex);
+
+	// If this isn't the last reference of the module
+	if (--refCount > 0) return;
+
+	// Stop the tracing before the cargo DLL which has the trace function is freed
+	TraceScope::GetTraceFunction() = nullptr;
+
+	instance = nullptr;
+
+	if (!cargoDll) return;
+
+	ReleaseRuntimeFunction ReleaseCargoRuntime = reinterpret_cast<ReleaseRuntimeFunction>(GetProcAddress(cargoDll, "ReleaseUCSORuntime"));
+
+	if (ReleaseCargoRuntime) ReleaseCargoRuntime();
+
+	FreeLibrary(cargoDll);
+	cargoDll = nullptr;
+}
@@ -0,0 +1,88 @@
+// =======================================================================================
+// SharedRuntime.h : The UCSO modules and data shared by all vessels' API instances.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <mutex>
+
+#include "Trace.h"
+#include "Runtime.h"
+#include "CustomCargo.h"
+#include "..\Cargo\CargoCatalog.h"
+
+typedef UCSO::CustomCargo* (*CustomCargoFunction)(OBJHANDLE);
+
+namespace UCSO
+{
+	class Vessel;
+
+	// The custom cargo DLL and the available cargoes, which the cargo DLL loads once for the whole process.
+	// Each module gets it with its first API instance and releases it with the last one, so the instances only reference it.
+	class SharedRuntime
+	{
+	public:
+		// Gets the runtime and adds a reference to it. The first reference of the module loads the cargo DLL
+		static SharedRuntime* Acquire();
+
+		// Removes a reference. The last reference of the module frees the cargo DLL, which deletes the runtime with the last module
+		static void Release();
+
+		// The UCSO version, or nullptr if UCSO isn't installed
+		virtual const char* GetVersion() = 0;
+		virtual CustomCargoFunction GetCustomCargoFunction() = 0;
+		virtual RuntimeStatistics* GetStatistics() = 0;
+		virtual TraceFunction GetTraceFunction() = 0;
+		virtual bool FlushTrace() = 0;
+
+		// The UCSO_Config.cfg settings which the API uses, as the cargo DLL read them for the cargoes
+		virtual bool GetDrainUnpackedResources() = 0;
+		virtual double GetContainerMass() = 0;
+
+		virtual std::shared_ptr<const CargoCatalog::Snapshot> GetCargoSnapshot() = 0;
+
+		// Applies the cargo file changes and returns the latest snapshot
+		virtual std::shared_ptr<const CargoCatalog::Snapshot> UpdateCargoCatalog() = 0;
+
+		// The API instances of all modules with their interface version, so an instance calls the methods of another module's instance only if it has them.
+		// The version 0 removes the instance.
+		virtual void RegisterVessel(Vessel* vessel, OBJHANDLE hVessel, int interfaceVersion) = 0;
+
+		// The interface version of the instance, or 0 if it isn't registered
+		virtual int GetInterfaceVersion(Vessel* vessel) = 0;
+
+		// The registered instance of the vessel, or nullptr if it isn't registered
+		virtual Vessel* GetRegisteredVessel(OBJHANDLE hVessel) = 0;
+
+		// The vessel of the registered instance, or nullptr if it isn't registered
+		virtual OBJHANDLE GetRegisteredHandle(Vessel* vessel) = 0;
+
+	protected:
+		virtual ~SharedRuntime() = default;
+
+	private:
+		static SharedRuntime* instance;
+		static HINSTANCE cargoDll;
+		static int refCount;
+		static std::mutex instanceMutex;
+	};
+}
+
+typedef UCSO::SharedRuntime* (*AcquireRuntimeFunction)();
+typedef void (*ReleaseRuntimeFunction)();
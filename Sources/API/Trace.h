@@ -0,0 +1,140 @@
+// =======================================================================================
+// Trace.h : The tracing buffer and scope shared between all UCSO modules.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <Orbitersdk.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace UCSO
+{
+	// Adds a begin or an end event to the trace buffer. The name is copied, so it can be in a module which is freed before the flush
+	typedef void (*TraceFunction)(const char* name, bool begin);
+
+	// A fixed size ring of trace events, which can be written from any thread without locks.
+	// The oldest events are overwritten if the buffer is full.
+	class TraceBuffer
+	{
+	public:
+		TraceBuffer(size_t size) : size(size ? size : 1), events(new Event[this->size]), startTime(std::chrono::steady_clock::now()) { }
+
+		void AddEvent(const char* name, bool begin)
+		{
+			uint64_t index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+			Event& event = events[index % size];
+
+			// The sequence is odd while the event is written, so Flush skips it
+			event.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+
+			strncpy(event.name, name, NAME_SIZE - 1);
+			event.name[NAME_SIZE - 1] = '\0';
+			event.begin = begin;
+			event.time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+			event.threadId = GetCurrentThreadId();
+
+			event.sequence.store(index * 2 + 2, std::memory_order_release);
+		}
+
+		// Writes the buffered events to the file in the Chrome trace format. Returns false if the file couldn't be opened
+		bool Flush(const char* fileName)
+		{
+			FILE* file = fopen(fileName, "w");
+
+			if (!file) return false;
+
+			fprintf(file, "{\"traceEvents\":[");
+
+			uint64_t endIndex = writeIndex.load(std::memory_order_acquire);
+			uint64_t startIndex = endIndex > size ? endIndex - size : 0;
+			bool first = true;
+
+			for (uint64_t index = startIndex; index < endIndex; ++index)
+			{
+				Event& event = events[index % size];
+
+				// Copy the event, then check it wasn't being written or overwritten meanwhile
+				uint64_t sequence = event.sequence.load(std::memory_order_acquire);
+
+				char name[NAME_SIZE];
+				memcpy(name, event.name, NAME_SIZE);
+				bool begin = event.begin;
+				long long time = event.time;
+				DWORD threadId = event.threadId;
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (sequence != index * 2 + 2 || event.sequence.load(std::memory_order_relaxed) != sequence) continue;
+
+				fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"UCSO\",\"ph\":\"%s\",\"ts\":%lld,\"pid\":1,\"tid\":%lu}",
+					first ? "" : ",", name, begin ? "B" : "E", time, static_cast<unsigned long>(threadId));
+
+				first = false;
+			}
+
+			fprintf(file, "\n]}\n");
+			fclose(file);
+
+			return true;
+		}
+
+	private:
+		static const size_t NAME_SIZE = 48; // Longer names are cut, so it fits the longest UCSO method name
+
+		struct Event
+		{
+			std::atomic<uint64_t> sequence{ 0 };
+			char name[NAME_SIZE] = { };
+			bool begin = false;
+			long long time = 0;
+			DWORD threadId = 0;
+		};
+
+		size_t size;
+		std::unique_ptr<Event[]> events;
+		std::atomic<uint64_t> writeIndex{ 0 };
+		std::chrono::steady_clock::time_point startTime;
+	};
+
+	// Adds a begin event on its construction and an end event on its destruction, if the tracing is enabled
+	class TraceScope
+	{
+	public:
+		TraceScope(const char* name) : name(name), traceFunction(GetTraceFunction()) { if (traceFunction) traceFunction(name, true); }
+
+		~TraceScope() { if (traceFunction) traceFunction(name, false); }
+
+		// The trace function of this module, or nullptr if the tracing is disabled
+		static TraceFunction& GetTraceFunction()
+		{
+			static TraceFunction traceFunction = nullptr;
+			return traceFunction;
+		}
+
+	private:
+		const char* name;
+		TraceFunction traceFunction;
+	};
+}
@@ -40,18 +40,32 @@ namespace UCSO
 			GRAPPLE_FAILED             // The grapple or addition failed.
 		};
 
-		// The release result as returned from ReleaseCargo, UnpackCargo, and DeleteCargo methods.
+		// The release result as returned from ReleaseCargo, UnpackCargo, DeleteCargo, and StoreDepotCargo methods.
 		enum ReleaseResult
 		{
 			RELEASE_SUCCEEDED = 0,   // The cargo is released, unpacked, or deleted successfully.
 			NO_EMPTY_POSITION,       // There is no empty position near the vessel for release on the ground for ReleaseCargo,
-									 // Or no unpackable cargo in the unpacking range for UnpackCargo.
+									 // Or no unpackable cargo in the unpacking range for UnpackCargo, or no depot in the grapple range for StoreDepotCargo.
 		    RELEASE_SLOT_EMPTY,      // The passed slot is empty, or all slots are empty if -1 is passed. Not for UnpackCargo.
 			RELEASE_SLOT_CLOSED,     // The passed slot (or all slots) door is closed. Not for UnpackCargo.
 			RELEASE_SLOT_UNDEFINED,  // The passed slot (or all slots) is undefiend or invalid. Not for UnpackCargo.
 			RELEASE_FAILED           // The release, unpacking, or deletion failed.
 		};
 
+		// The transfer result as returned from TransferCargo method.
+		enum TransferResult
+		{
+			TRANSFER_SUCCEEDED = 0,            // The cargo is transferred successfully.
+			TRANSFER_NOT_IN_RANGE,             // The target vessel isn't in the grapple range, or it's invalid.
+			TRANSFER_MAX_MASS_EXCEEDED,        // The target maximum one cargo mass will be exceeded if the cargo is transferred.
+			TRANSFER_MAX_TOTAL_MASS_EXCEEDED,  // The target maximum total cargo mass will be exceeded if the cargo is transferred.
+			TRANSFER_SLOT_EMPTY,               // The passed source slot is empty, or all source slots are empty if -1 is passed.
+			TRANSFER_SLOT_OCCUPIED,            // The passed target slot (or all target slots) is occupied.
+			TRANSFER_SLOT_CLOSED,              // The passed source or target slot (or all slots) door is closed.
+			TRANSFER_SLOT_UNDEFINED,           // The passed source or target slot (or all slots) is undefiend or invalid.
+			TRANSFER_FAILED                    // The transfer failed.
+		};
+
 		// Cargo type as returned from GetCargoInfo method.
 		enum CargoType
 		{
@@ -102,6 +116,51 @@ namespace UCSO
 			int unpackingDelay;          // The unpacking delay in seconds.
 		} CargoInfo;
 
+		// The manifest entry as passed to LoadManifest method.
+		typedef struct
+		{
+			const char* cargoName;       // The cargo name as returned from GetAvailableCargoName method. If nullptr is passed, the index is used.
+			int index;                   // The cargo index. Used only if the cargo name is nullptr.
+			int slot;                    // The slot number. If -1 is passed, the first empty slot which isn't used by a previous entry will be used.
+		} ManifestEntry;
+
+		// The API method as passed to GetStatistics method.
+		enum StatisticsMethod
+		{
+			ADD_CARGO_METHOD = 0,
+			GRAPPLE_CARGO_METHOD,
+			RELEASE_CARGO_METHOD,
+			PACK_CARGO_METHOD,
+			UNPACK_CARGO_METHOD,
+			DELETE_CARGO_METHOD,
+			TRANSFER_CARGO_METHOD,
+			DRAIN_CARGO_RESOURCE_METHOD,
+			DRAIN_STATION_OR_UNPACKED_RESOURCE_METHOD,
+			GET_NEAREST_BREATHABLE_CARGO_METHOD,
+			PULL_DEPOT_CARGO_METHOD,
+			STORE_DEPOT_CARGO_METHOD,
+			LOAD_MANIFEST_METHOD,
+			ACCEPT_TRANSFERRED_CARGO_METHOD,
+			METHOD_COUNT
+		};
+
+		// The API method statistics as returned from GetStatistics method, since the statistics were enabled.
+		typedef struct
+		{
+			int callCount;            // The count of the method calls.
+			double totalTime;         // The total wall time of the calls in seconds.
+			double maxTime;           // The longest call wall time in seconds.
+			int vesselsVisited;       // The count of the vessels visited while searching the vessels list.
+			int candidatesConsidered; // The count of the vessels in the search range which were checked further.
+			int attachmentExceptions; // The count of the exceptions caught while checking the slot attachment handles.
+			int filesOpened;          // The count of the configuration files opened while searching for stations.
+			int vesselsCreated;       // The count of the created vessels.
+			int vesselsDeleted;       // The count of the deleted vessels.
+			int allocationCount;      // The count of the memory allocations made by the API containers and strings. The cargo data copies,
+			                          // Whose strings are allocated by the cargo module, aren't counted.
+			long long allocatedBytes; // The total size of the memory allocations in bytes.
+		} MethodStatistics;
+
 		// Performs one-time initialization of UCSO vessel API. It can be called from your vessel's constructor.
 		// Parameters:
 		//	vessel: pointer to the calling vessel.
@@ -109,6 +168,10 @@ namespace UCSO
 		// NOTE: Don't forget to delete the returned object when you no longer need it (e.g. in your vessel's destructor).
 		static UCSO::Vessel* CreateInstance(VESSEL* vessel);
 
+		// The version of this interface, which increases when methods are added at its end.
+		// An instance calls the added methods of another vessel's instance only if that vessel is built with the same or a later version.
+		static const int INTERFACE_VERSION = 1;
+
 		// Returns the UCSO version, or nullptr if UCSO isn't installed.
 		virtual const char* GetUCSOVersion() = 0;
 
@@ -182,6 +245,7 @@ namespace UCSO
 		virtual void SetBreathableRange(double breathableRange) = 0;
 
 		// Returns the available cargo count which is the number of cargoes in Config\Vessels\UCSO folder, or 0 is UCSO isn't installed.
+		// The cargo files added or removed while the simulation runs are found once per frame.
 		virtual int GetAvailableCargoCount() = 0;
 
 		// Returns the cargo name from the passed index, which is the filename from Config\Vessels\UCSO folder without .cfg,
@@ -288,6 +352,148 @@ namespace UCSO
 
 		virtual ~Vessel() { }
 
+		// The methods added after version 1.1.1. New methods are added at the end only, after the destructor,
+		// so the virtual table order of the older methods doesn't change for the vessels built against an older header.
+
+		// Sets the virtual cargo mode.
+		// In this mode, added and grappled cargoes aren't kept as Orbiter vessels. Each cargo is stored in its slot as a record,
+		// And its mass is added to the vessel empty mass. The cargo vessel is created again when the cargo is released.
+		// Custom cargoes are always kept as Orbiter vessels. Disabling the mode doesn't affect the already stored cargoes.
+		// If enabled, call SaveVirtualCargo and LoadVirtualCargo methods to keep the stored cargoes in the scenario.
+		// Parameters:
+		//	virtualCargo: true to enable the virtual cargo mode, false to disable. The default value is false.
+		virtual void SetVirtualCargo(bool virtualCargo) = 0;
+
+		// Saves the virtual cargoes to the scenario. It should be called from your vessel's clbkSaveState method.
+		// Parameters:
+		//	scn: the scenario file handle.
+		virtual void SaveVirtualCargo(FILEHANDLE scn) = 0;
+
+		// Loads a virtual cargo from the scenario. It should be called from your vessel's clbkLoadStateEx method for every line.
+		// Parameters:
+		//	line: the scenario line.
+		// Returns true if the line is a virtual cargo line, or false if not. If false is returned, pass the line to ParseScenarioLineEx.
+		virtual bool LoadVirtualCargo(const char* line) = 0;
+
+		// Gets the count of the cargoes stored in the nearest depot in the range set by SetGrappleRange method.
+		// Parameters:
+		//	cargoName: the cargo name, which is the filename from Config\Vessels\UCSO folder without .cfg. If nullptr is passed, any cargo will be counted.
+		//	resource: the resource name, must be lowercase. If nullptr is passed, any cargo will be counted.
+		// Returns the cargo count, or 0 if no depot in the grapple range is found.
+		virtual int GetDepotCargoCount(const char* cargoName = nullptr, const char* resource = nullptr) = 0;
+
+		// Pulls cargoes from the nearest depot in the range set by SetGrappleRange method to the empty slots.
+		// The lightest matching cargoes are pulled first, and the maximum cargo mass and the maximum total cargo mass are respected.
+		// If the virtual cargo mode is enabled, the cargoes are stored in the slots as records.
+		// Parameters:
+		//	count: the count of cargoes to pull.
+		//	cargoName: the cargo name, which is the filename from Config\Vessels\UCSO folder without .cfg. If nullptr is passed, any cargo will be pulled.
+		//	resource: the resource name, must be lowercase. If nullptr is passed, any cargo will be pulled.
+		// Returns the count of the pulled cargoes, which is lower than the passed count if the depot or the empty slots run out.
+		virtual int PullDepotCargo(int count, const char* cargoName = nullptr, const char* resource = nullptr) = 0;
+
+		// Stores the cargo in the passed slot in the nearest depot in the range set by SetGrappleRange method. Custom cargoes can't be stored.
+		// Parameters:
+		//	slot: the slot number. If -1 is passed, the first occupied slot will be used.
+		// Returns the result as the ReleaseResult enum.
+		virtual ReleaseResult StoreDepotCargo(int slot = -1) = 0;
+
+		// Sets the cargo pallets mode.
+		// In this mode, packed cargoes released on the ground next to another cargo are merged with it into one pallet vessel.
+		// The pallet keeps the cargoes as records with their meshes, so a storage yard doesn't need a vessel for every cargo.
+		// Pallet cargoes are grappled by GrappleCargo method as normal cargoes regardless of this mode, and they split from the pallet when grappled.
+		// Custom cargoes and cargoes which are unpacked automatically after release are never merged.
+		// Parameters:
+		//	cargoPallets: true to enable the cargo pallets mode, false to disable. The default value is false.
+		virtual void SetCargoPallets(bool cargoPallets) = 0;
+
+		// Transfers the cargo in the passed slot directly to the passed slot of another UCSO vessel, without releasing and grappling it.
+		// The cargo must be in the range set by SetGrappleRange method of the target vessel, and its slot doors and mass limits are respected.
+		// The target vessel must be built with this UCSO version or later, otherwise TRANSFER_FAILED is returned.
+		// Parameters:
+		//	targetVessel: the target vessel UCSO instance, as returned from CreateInstance method.
+		//	fromSlot: the source slot number. If -1 is passed, the first occupied slot will be used.
+		//	toSlot: the target slot number. If -1 is passed, the first empty target slot will be used.
+		// Returns the result as the TransferResult enum.
+		virtual TransferResult TransferCargo(Vessel* targetVessel, int fromSlot = -1, int toSlot = -1) = 0;
+
+		// Enables or disables the API statistics, which measure the time and the work of the API methods.
+		// When disabled, the API methods don't measure anything. Enabling the statistics again resets them.
+		// Parameters:
+		//	enabled: true to enable the statistics, false to disable. The default value is false.
+		virtual void SetStatistics(bool enabled) = 0;
+
+		// Gets the statistics of the passed API method.
+		// Parameters:
+		//	method: the API method as the StatisticsMethod enum.
+		// Returns the method statistics as the MethodStatistics struct, or an empty struct if the method is invalid.
+		virtual MethodStatistics GetStatistics(StatisticsMethod method) = 0;
+
+		// Writes the trace of UCSO methods to UCSO_Trace.json in the Orbiter folder, which can be opened in chrome://tracing or Perfetto.
+		// The trace is written automatically when the simulation ends. Tracing is enabled in the UCSO configuration file.
+		// Returns true if the trace is written, false if the tracing is disabled or the file couldn't be written.
+		virtual bool FlushTrace() = 0;
+
+		// Starts or stops recording the API calls which change the cargoes or the settings to a binary operation log.
+		// Each call is recorded with its arguments, a hash of the slots state before it, and its result.
+		// Parameters:
+		//	fileName: the log file path from the Orbiter folder. If nullptr is passed, the recording stops.
+		// Returns true if the recording is started or stopped, false if the file couldn't be opened.
+		virtual bool SetOperationLog(const char* fileName) = 0;
+
+		// Loads an operation log to replay it on this vessel. Load the same scenario the log was recorded in before starting the replay.
+		// Parameters:
+		//	fileName: the log file path from the Orbiter folder.
+		// Returns true if the log is loaded, false if the file couldn't be read or isn't an operation log.
+		virtual bool StartReplay(const char* fileName) = 0;
+
+		// Replays the logged calls whose simulation time has passed. It should be called from clbkPreStep while replaying.
+		// Differences in the state hash or in the results are written to Orbiter.log, and a summary is written when the replay finishes.
+		// TransferCargo calls find the target vessel by its name. The cargoes transferred to this vessel are accepted when the source vessel's replay
+		// transfers them, so replay the logs of both vessels.
+		// Returns the count of the calls left to replay, or 0 if the replay is finished or not started.
+		virtual int UpdateReplay() = 0;
+
+		// Returns the generation of the available cargo list, which increases when a file is added to or removed from Config\Vessels\UCSO folder.
+		// The list is updated when GetAvailableCargoCount is called, so the indices don't change between the calls in the same generation.
+		virtual int GetAvailableCargoGeneration() = 0;
+
+		// Sets the inventory snapshot mode.
+		// In this mode, SaveVirtualCargo writes all the virtual cargoes to one binary file in Scenarios\UCSO_Inventory folder,
+		// and only the file name is written to the scenario. The file name includes a hash of the cargoes, so each saved state has its own file.
+		// Only the 8 newest files of each vessel are kept, so the scenarios saved before them load without their virtual cargoes.
+		// LoadVirtualCargo reads both the snapshot files and the virtual cargo lines, so the mode can be changed for existing scenarios.
+		// Parameters:
+		//	inventorySnapshot: true to enable the inventory snapshot mode, false to disable. The default value is false.
+		virtual void SetInventorySnapshot(bool inventorySnapshot) = 0;
+
+		// Adds the cargoes of the passed manifest to the slots in one batch.
+		// All the entries are checked first against the slots and the mass limits, including the entries before them,
+		// And then the valid entries are added. The result of each entry is the same as the result of AddCargo method.
+		// Parameters:
+		//	entries: the manifest entries array.
+		//	count: the entries count.
+		//	results: the results array, which must have the same count as the entries. Each result is set as the GrappleResult enum.
+		// Returns the count of the added cargoes.
+		virtual int LoadManifest(const ManifestEntry* entries, int count, GrappleResult* results) = 0;
+
+		// Adds the cargoes of the passed manifest file to the slots in one batch, as LoadManifest method.
+		// Each line of the file has a cargo name, and optionally a slot number. Empty lines and lines starting with ; are skipped.
+		// Parameters:
+		//	fileName: the manifest file path from the Orbiter folder.
+		//	results: the results array, or nullptr if the results aren't needed. The first resultCount results are set as the GrappleResult enum.
+		//	resultCount: the results array count.
+		// Returns the count of the added cargoes, or -1 if the file couldn't be read.
+		virtual int LoadManifestFile(const char* fileName, GrappleResult* results = nullptr, int resultCount = 0) = 0;
+
+		// Takes a cargo transferred from another UCSO vessel. It's called by TransferCargo method of the source vessel, not by the vessel code.
+		// The range, the slot door, and the mass limits are checked, then the cargo is attached to the slot, or stored in it in the virtual cargo mode.
+		// Parameters:
+		//	cargoHandle: the cargo vessel handle. The source vessel has detached it, and attaches it again if the transfer fails.
+		//	slot: the slot number. If -1 is passed, the first empty slot will be used.
+		// Returns the result as the TransferResult enum.
+		virtual TransferResult AcceptTransferredCargo(OBJHANDLE cargoHandle, int slot = -1) = 0;
+
 	protected:
 		// The constructor has a protected access to prevent incorrect instantiation by the vessel code.
 		// Always use the static CreateInstance method to create an instance of UCSO.
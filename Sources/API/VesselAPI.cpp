@@ -20,10 +20,28 @@
 // =======================================================================================
 
 #include "VesselAPI.h"
+#include <sstream>
+#include <algorithm>
 #include <filesystem>
+#include <cstdio>
+#include <set>
 
 void ExceptionHandler(unsigned int u, EXCEPTION_POINTERS* pExp) { throw; }
 
+// The first bytes of the operation log files, which include the format version
+const char OPERATION_LOG_MAGIC[8] = { 'U', 'C', 'S', 'O', 'O', 'P', 'L', '1' };
+
+const char INVENTORY_SNAPSHOT_FOLDER[] = "Scenarios/UCSO_Inventory";
+
+// The count of the newest inventory snapshots kept for each vessel, so the snapshots of the older scenarios don't pile up
+const size_t INVENTORY_SNAPSHOT_LIMIT = 8;
+
+// The first interface version which has AcceptTransferredCargo
+const int ACCEPT_TRANSFER_INTERFACE_VERSION = 1;
+
+// The simulation time in seconds a replayed AcceptTransferredCargo call waits for the source vessel's replay to transfer the cargo
+const double ACCEPT_REPLAY_TIMEOUT = 1;
+
 UCSO::Vessel* UCSO::Vessel::CreateInstance(VESSEL* vessel) { return new VesselAPI(vessel); }
 
 VesselAPI::VesselAPI(VESSEL* vessel)
@@ -33,43 +51,42 @@ VesselAPI::VesselAPI(VESSEL* vessel)
 
 	this->vessel = vessel;
 
-	// Load cargo DLL
-	HINSTANCE ucsoDll = LoadLibraryA("Modules/UCSO/Cargo.dll");
-
-	// If the DLL is loaded
-	if (ucsoDll)
-	{
-		GetVersionFunction GetCargoVersion = reinterpret_cast<GetVersionFunction>(GetProcAddress(ucsoDll, "GetUCSOVersion"));
+	sharedRuntime = UCSO::SharedRuntime::Acquire();
 
-		// If the function is found, set the version
-		if (GetCargoVersion) version = GetCargoVersion();
+	version = sharedRuntime->GetVersion();
+	runtime = sharedRuntime->GetStatistics();
+	GetCustomCargo = sharedRuntime->GetCustomCargoFunction();
+	drainUnpackedResources = sharedRuntime->GetDrainUnpackedResources();
+	containerMass = sharedRuntime->GetContainerMass();
 
-		FreeLibrary(ucsoDll);
-	} 
+	// Count this vessel in the runtime figures
+	if (runtime) runtime->carrierCount++;
 
-	if (!version) oapiWriteLog("UCSO API Warning: Couldn't load the cargo API");
+	// Take the available cargo list if UCSO is installed
+	if (version) availableCargo = sharedRuntime->GetCargoSnapshot();
 
-	// Load custom cargo DLL
-	customCargoDll = LoadLibraryA("Modules/UCSO/CustomCargo.dll");
+	// Register this instance, so the other modules know its interface version
+	sharedRuntime->RegisterVessel(this, vessel->GetHandle(), INTERFACE_VERSION);
+}
 
-	if (customCargoDll) GetCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "GetCustomCargo"));
+VesselAPI::~VesselAPI()
+{
+	if (operationLog) fclose(operationLog);
 
-	// If the DLL isn't loaded or the function couldn't be found
-	if (!GetCustomCargo) 
+	if (runtime)
 	{
-		if (customCargoDll) FreeLibrary(customCargoDll);
+		runtime->carrierCount--;
+		runtime->slotCount -= int(attachsMap.size());
+	}
 
-		oapiWriteLog("UCSO API Warning: Couldn't load the custom cargo API");
+	sharedRuntime->RegisterVessel(this, nullptr, 0);
 
-		version = nullptr;
-	}
+	// The snapshot is deleted by the cargo DLL, so it's released before the DLL can be freed
+	availableCargo.reset();
 
-	// Set the available cargo list if UCSO is installed
-	if (version) InitAvailableCargo();
+	UCSO::SharedRuntime::Release();
 }
 
-VesselAPI::~VesselAPI() { if (customCargoDll) FreeLibrary(customCargoDll); }
-
 const char* VesselAPI::GetUCSOVersion() { return version; }
 
 bool VesselAPI::SetSlotAttachment(int slot, ATTACHMENTHANDLE attachmentHandle, bool opened)
@@ -80,11 +97,16 @@ bool VesselAPI::SetSlotAttachment(int slot, ATTACHMENTHANDLE attachmentHandle, b
 	if (attachsMap.find(slot) != attachsMap.end() && !attachmentHandle) 
 	{
 		attachsMap.erase(slot);
+
+		if (runtime) runtime->slotCount--;
+
 		return true;
 	}
 	// If the attachment handle isn't NULL and the attachment is valid
 	else if (attachmentHandle && CheckAttachment(attachmentHandle)) 
 	{ 
+		if (runtime && attachsMap.find(slot) == attachsMap.end()) runtime->slotCount++;
+
 		attachsMap[slot] = { opened, attachmentHandle };
 		return true;
 	}
@@ -94,93 +116,312 @@ bool VesselAPI::SetSlotAttachment(int slot, ATTACHMENTHANDLE attachmentHandle, b
 
 void VesselAPI::SetSlotDoor(bool opened, int slot)
 {
+	LogSetting(SET_SLOT_DOOR_OPERATION, slot, opened);
+
 	// Set every slot door status if -1 is passed
 	if (slot == -1) for (auto& [slot, data] : attachsMap) data.opened = opened;
 	// If the slot exists
 	else if (attachsMap.find(slot) != attachsMap.end()) attachsMap[slot].opened = opened;
 }
 
-void VesselAPI::SetMaxCargoMass(double maxCargoMass) { this->maxCargoMass = maxCargoMass; }
+void VesselAPI::SetMaxCargoMass(double maxCargoMass)
+{
+	LogSetting(SET_MAX_CARGO_MASS_OPERATION, 0, maxCargoMass);
 
-void VesselAPI::SetMaxTotalCargoMass(double maxTotalCargoMass) { this->maxTotalCargoMass = maxTotalCargoMass; }
+	this->maxCargoMass = maxCargoMass;
+}
 
-void VesselAPI::SetEVAMode(bool evaMode) { this->evaMode = evaMode; }
+void VesselAPI::SetMaxTotalCargoMass(double maxTotalCargoMass)
+{
+	LogSetting(SET_MAX_TOTAL_CARGO_MASS_OPERATION, 0, maxTotalCargoMass);
 
-void VesselAPI::SetGrappleRange(double grappleRange) { this->grappleRange = grappleRange; }
+	this->maxTotalCargoMass = maxTotalCargoMass;
+}
 
-void VesselAPI::SetReleaseVelocity(double releaseVelocity) { this->releaseVelocity = releaseVelocity; }
+void VesselAPI::SetEVAMode(bool evaMode)
+{
+	LogSetting(SET_EVA_MODE_OPERATION, 0, evaMode);
 
-void VesselAPI::SetCargoRowLength(int rowLength) { this->rowLength = rowLength; }
+	this->evaMode = evaMode;
+}
 
-void VesselAPI::SetUnpackingRange(double unpackingRange) { this->unpackingRange = unpackingRange; }
+void VesselAPI::SetGrappleRange(double grappleRange)
+{
+	LogSetting(SET_GRAPPLE_RANGE_OPERATION, 0, grappleRange);
 
-void VesselAPI::SetResourceRange(double resourceRange) { this->resourceRange = resourceRange; }
+	this->grappleRange = grappleRange;
+}
 
-void VesselAPI::SetBreathableRange(double breathableRange) { this->breathableRange = breathableRange; }
+void VesselAPI::SetReleaseVelocity(double releaseVelocity)
+{
+	LogSetting(SET_RELEASE_VELOCITY_OPERATION, 0, releaseVelocity);
 
-int VesselAPI::GetAvailableCargoCount() { return (version ? availableCargoList.size() : 0); }
+	this->releaseVelocity = releaseVelocity;
+}
 
-const char* VesselAPI::GetAvailableCargoName(int index)
+void VesselAPI::SetCargoRowLength(int rowLength)
 {
-	// If the index is invalid (lower than 0 or higher than the list size)
-	if (index < 0 || index >= static_cast<int>(availableCargoList.size())) return nullptr;
+	LogSetting(SET_CARGO_ROW_LENGTH_OPERATION, 0, rowLength);
 
-	return availableCargoList[index].c_str();
+	this->rowLength = rowLength;
 }
 
-VesselAPI::CargoInfo VesselAPI::GetCargoInfo(int slot)
+void VesselAPI::SetUnpackingRange(double unpackingRange)
 {
-	// If the slot isn't defined, isn't valid, or empty
-	if (attachsMap.empty() || attachsMap.find(slot) == attachsMap.end() || 
-		!CheckAttachment(attachsMap[slot].attachHandle) || !VerifySlot(slot)) return CargoInfo();
+	LogSetting(SET_UNPACKING_RANGE_OPERATION, 0, unpackingRange);
 
-	// Get the attached cargo
-	VESSEL* cargoVessel = oapiGetVesselInterface(vessel->GetAttachmentStatus(attachsMap[slot].attachHandle));
+	this->unpackingRange = unpackingRange;
+}
 
-	CargoInfo cargoInfo;
+void VesselAPI::SetResourceRange(double resourceRange)
+{
+	LogSetting(SET_RESOURCE_RANGE_OPERATION, 0, resourceRange);
 
-	cargoInfo.valid = true;
-	cargoInfo.name = cargoVessel->GetName();
-	cargoInfo.mass = cargoVessel->GetMass();
+	this->resourceRange = resourceRange;
+}
 
-	UCSO::CustomCargo* customCargo = GetCustomCargo(cargoVessel->GetHandle());
+void VesselAPI::SetBreathableRange(double breathableRange)
+{
+	LogSetting(SET_BREATHABLE_RANGE_OPERATION, 0, breathableRange);
 
-	if (customCargo)
+	this->breathableRange = breathableRange;
+}
+
+void VesselAPI::SetVirtualCargo(bool virtualCargo)
+{
+	LogSetting(SET_VIRTUAL_CARGO_OPERATION, 0, virtualCargo);
+
+	this->virtualCargo = virtualCargo;
+}
+
+void VesselAPI::SetCargoPallets(bool cargoPallets)
+{
+	LogSetting(SET_CARGO_PALLETS_OPERATION, 0, cargoPallets);
+
+	this->cargoPallets = cargoPallets;
+}
+
+void VesselAPI::SetStatistics(bool enabled)
+{
+	statisticsEnabled = enabled;
+
+	// Reset the statistics
+	if (enabled) for (MethodStatistics& methodStats : statistics) methodStats = { };
+}
+
+VesselAPI::MethodStatistics VesselAPI::GetStatistics(StatisticsMethod method)
+{
+	if (method < 0 || method >= METHOD_COUNT) return { };
+
+	return statistics[method];
+}
+
+bool VesselAPI::FlushTrace() { return sharedRuntime->FlushTrace(); }
+
+bool VesselAPI::SetOperationLog(const char* fileName)
+{
+	if (operationLog) { fclose(operationLog); operationLog = nullptr; }
+
+	if (!fileName) return true;
+
+	operationLog = fopen(fileName, "wb");
+
+	if (!operationLog) { oapiWriteLog("UCSO API Warning: Couldn't open the operation log file"); return false; }
+
+	fwrite(OPERATION_LOG_MAGIC, 1, sizeof(OPERATION_LOG_MAGIC), operationLog);
+
+	return true;
+}
+
+bool VesselAPI::StartReplay(const char* fileName)
+{
+	replayList.clear();
+	acceptedReplayList.clear();
+	replayIndex = 0;
+	replayMismatches = 0;
+
+	FILE* file = fopen(fileName, "rb");
+
+	if (!file) { oapiWriteLog("UCSO API Warning: Couldn't open the operation log file"); return false; }
+
+	char magic[sizeof(OPERATION_LOG_MAGIC)];
+
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, OPERATION_LOG_MAGIC, sizeof(magic)) != 0)
+	{
+		oapiWriteLog("UCSO API Warning: The operation log file is invalid");
+		fclose(file);
+
+		return false;
+	}
+
+	OperationRecord record;
+
+	while (ReadOperation(file, record)) replayList.push_back(record);
+
+	fclose(file);
+
+	return true;
+}
+
+int VesselAPI::UpdateReplay()
+{
+	if (replayIndex >= replayList.size()) return 0;
+
+	double simTime = oapiGetSimTime();
+
+	for (; replayIndex < replayList.size() && replayList[replayIndex].simTime <= simTime; replayIndex++)
 	{
-		UCSO::CustomCargo::CargoInfo customInfo = customCargo->GetCargoInfo();
+		const OperationRecord& record = replayList[replayIndex];
+
+		// The transferred cargoes are accepted when another vessel's replay transfers them, which can be stepped after this vessel
+		if (record.operation == ACCEPT_TRANSFERRED_CARGO_OPERATION)
+		{
+			AcceptReplay acceptReplay = GetAcceptReplay(record, simTime);
 
-		cargoInfo.type = static_cast<CargoType>(customInfo.type);
+			if (acceptReplay == ACCEPT_REPLAY_WAITING) break;
+			else if (acceptReplay == ACCEPT_REPLAY_DONE) continue;
+		}
 
-		switch (cargoInfo.type)
+		if (GetStateHash() != record.stateHash)
 		{
-		case RESOURCE:
-			cargoInfo.resource = _strdup(customInfo.resource);
-			cargoInfo.resourceMass = customInfo.resourceMass;
+			oapiWriteLogV("UCSO API Warning: The state before the replayed operation %d (type %d) differs from the log",
+				static_cast<int>(replayIndex), record.operation);
+			replayMismatches++;
+		}
 
-			break;
-		case UNPACKABLE_ONLY:
-			cargoInfo.spawnCount = customInfo.spawnCount;
-		case PACKABLE_UNPACKABLE:
-			cargoInfo.unpackingType = CUSTOM_CARGO;
-			cargoInfo.breathable = customInfo.breathable;
-		default:
-			break;
+		replayingOperation = true;
+		double result = ReplayOperation(record);
+		replayingOperation = false;
+
+		if (result != record.result)
+		{
+			oapiWriteLogV("UCSO API Warning: The replayed operation %d (type %d) returned %g instead of %g",
+				static_cast<int>(replayIndex), record.operation, result, record.result);
+			replayMismatches++;
+		}
+	}
+
+	if (replayIndex < replayList.size()) return static_cast<int>(replayList.size() - replayIndex);
+
+	oapiWriteLogV("UCSO API: The replay of %d operations finished with %d mismatches", static_cast<int>(replayList.size()), replayMismatches);
+
+	replayList.clear();
+	acceptedReplayList.clear();
+	replayIndex = 0;
+
+	return 0;
+}
+
+VesselAPI::AcceptReplay VesselAPI::GetAcceptReplay(const OperationRecord& record, double simTime)
+{
+	const std::string& cargoName = record.texts[0];
+
+	auto acceptedIt = std::find_if(acceptedReplayList.begin(), acceptedReplayList.end(),
+		[&cargoName](const std::pair<std::string, TransferResult>& accepted) { return accepted.first == cargoName; });
+
+	// If the source vessel's replay transferred the cargo already, only its result is compared
+	if (acceptedIt != acceptedReplayList.end())
+	{
+		if (acceptedIt->second != record.result)
+		{
+			oapiWriteLogV("UCSO API Warning: The replayed operation %d (type %d) returned %d instead of %g",
+				static_cast<int>(replayIndex), record.operation, static_cast<int>(acceptedIt->second), record.result);
+			replayMismatches++;
 		}
 
-		return cargoInfo;
+		acceptedReplayList.erase(acceptedIt);
+
+		return ACCEPT_REPLAY_DONE;
+	}
+
+	OBJHANDLE cargoHandle = oapiGetVesselByName(const_cast<char*>(cargoName.c_str()));
+
+	// If the cargo isn't attached to another vessel, it's accepted by this replay
+	if (!cargoHandle || !(oapiGetVesselInterface(cargoHandle)->GetFlightStatus() & 2)) return ACCEPT_REPLAY_CALL;
+
+	// Wait for the source vessel's replay
+	if (simTime - record.simTime < ACCEPT_REPLAY_TIMEOUT) return ACCEPT_REPLAY_WAITING;
+
+	oapiWriteLogV("UCSO API Warning: The cargo %s of the replayed operation %d is still attached to another vessel. Replay the log of that vessel as well",
+		cargoName.c_str(), static_cast<int>(replayIndex));
+	replayMismatches++;
+
+	return ACCEPT_REPLAY_DONE;
+}
+
+int VesselAPI::GetAvailableCargoCount()
+{
+	if (!version) return 0;
+
+	double simTime = oapiGetSimTime();
+
+	// Take the latest catalog once per frame, so the cargo files added since the last frame are available.
+	// The count can be called for every cargo in a frame, e.g. to find a cargo by its name
+	if (simTime != catalogUpdateTime)
+	{
+		availableCargo = sharedRuntime->UpdateCargoCatalog();
+		catalogUpdateTime = simTime;
+	}
+
+	return static_cast<int>(availableCargo->cargoList.size());
+}
+
+const char* VesselAPI::GetAvailableCargoName(int index)
+{
+	// If the index is invalid (lower than 0 or higher than the list size)
+	if (!availableCargo || index < 0 || index >= static_cast<int>(availableCargo->cargoList.size())) return nullptr;
+
+	return availableCargo->cargoList[index].c_str();
+}
+
+int VesselAPI::GetAvailableCargoGeneration() { return availableCargo ? availableCargo->generation : 0; }
+
+VesselAPI::CargoInfo VesselAPI::GetCargoInfo(int slot)
+{
+	// If the slot isn't defined or isn't valid
+	if (attachsMap.empty() || attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return CargoInfo();
+
+	CargoInfo cargoInfo;
+	UCSO::DataStruct dataStruct;
+
+	auto virtualIt = virtualCargoMap.find(slot);
+
+	// If the slot cargo is virtual, use its record
+	if (virtualIt != virtualCargoMap.end())
+	{
+		cargoInfo.valid = true;
+		cargoInfo.name = virtualIt->second.name.c_str();
+		cargoInfo.mass = virtualIt->second.mass;
+
+		dataStruct = virtualIt->second.dataStruct;
 	}
+	// If the slot is empty
+	else if (!VerifySlot(slot)) return CargoInfo();
+	else
+	{
+		// Get the attached cargo
+		VESSEL* cargoVessel = oapiGetVesselInterface(vessel->GetAttachmentStatus(attachsMap[slot].attachHandle));
+
+		cargoInfo.valid = true;
+		cargoInfo.name = cargoVessel->GetName();
+		cargoInfo.mass = cargoVessel->GetMass();
+
+		UCSO::CustomCargo* customCargo = GetCustomCargo(cargoVessel->GetHandle());
 
-	// Get the cargo interface
-	UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(cargoVessel);
+		if (customCargo) return GetCustomCargoInfo(cargoInfo, customCargo);
 
-	UCSO::DataStruct dataStruct = cargo->GetDataStruct();
+		// Get the cargo interface
+		UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(cargoVessel);
+
+		dataStruct = cargo->GetDataStruct();
+	}
 
 	cargoInfo.type = static_cast<CargoType>(dataStruct.type);
 
 	switch (cargoInfo.type)
 	{
 	case RESOURCE:
-		cargoInfo.resource = _strdup(dataStruct.resource.c_str());
+		cargoInfo.resource = UCSO::CountedDuplicate(dataStruct.resource.c_str());
 		cargoInfo.resourceMass = dataStruct.netMass;
 
 		break;
@@ -192,7 +433,7 @@ VesselAPI::CargoInfo VesselAPI::GetCargoInfo(int slot)
 
 		if (cargoInfo.unpackingType == ORBITER_VESSEL) 
 		{
-			cargoInfo.spawnModule = _strdup(dataStruct.spawnModule.c_str());
+			cargoInfo.spawnModule = UCSO::CountedDuplicate(dataStruct.spawnModule.c_str());
 			cargoInfo.unpackingMode = static_cast<UnpackingMode>(dataStruct.unpackingMode);
 
 			if (cargoInfo.unpackingMode == DELAYING) cargoInfo.unpackingDelay = dataStruct.unpackingDelay;
@@ -206,10 +447,38 @@ VesselAPI::CargoInfo VesselAPI::GetCargoInfo(int slot)
 	return cargoInfo;
 }
 
+VesselAPI::CargoInfo VesselAPI::GetCustomCargoInfo(CargoInfo& cargoInfo, UCSO::CustomCargo* customCargo)
+{
+	UCSO::CustomCargo::CargoInfo customInfo = customCargo->GetCargoInfo();
+
+	cargoInfo.type = static_cast<CargoType>(customInfo.type);
+
+	switch (cargoInfo.type)
+	{
+	case RESOURCE:
+		cargoInfo.resource = UCSO::CountedDuplicate(customInfo.resource);
+		cargoInfo.resourceMass = customInfo.resourceMass;
+
+		break;
+	case UNPACKABLE_ONLY:
+		cargoInfo.spawnCount = customInfo.spawnCount;
+	case PACKABLE_UNPACKABLE:
+		cargoInfo.unpackingType = CUSTOM_CARGO;
+		cargoInfo.breathable = customInfo.breathable;
+	default:
+		break;
+	}
+
+	return cargoInfo;
+}
+
 double VesselAPI::GetCargoMass(int slot)
 {
 	if (attachsMap.empty() || attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return -1;
 
+	auto virtualIt = virtualCargoMap.find(slot);
+	if (virtualIt != virtualCargoMap.end()) return virtualIt->second.mass;
+
 	OBJHANDLE cargoHandle = VerifySlot(slot);
 	if (!cargoHandle) return -1;
 
@@ -231,12 +500,21 @@ double VesselAPI::GetTotalCargoMass()
 		if (cargo) totalCargoMass += oapiGetMass(cargo);
 	}
 
+	for (auto const& [slot, record] : virtualCargoMap) totalCargoMass += record.mass;
+
 	return totalCargoMass;
 }
 
 VesselAPI::GrappleResult VesselAPI::AddCargo(int index, int slot)
 {
-	if (index < 0 || index >= static_cast<int>(availableCargoList.size())) return NO_CARGO_IN_RANGE;
+	// The cargo name is logged as well, as the available cargo indices can differ when the log is replayed
+	if (IsLoggingOperation()) return LogOperation<GrappleResult>(MakeOperation(ADD_CARGO_OPERATION, index, slot, 0, GetAvailableCargoName(index)),
+		[&] { return AddCargo(index, slot); });
+
+	StatisticsScope statisticsScope(this, ADD_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::AddCargo");
+
+	if (!availableCargo || index < 0 || index >= static_cast<int>(availableCargo->cargoList.size())) return NO_CARGO_IN_RANGE;
 	else if (attachsMap.empty()) return GRAPPLE_SLOT_UNDEFINED;
 	else if (slot == -1)
 	{
@@ -250,9 +528,9 @@ VesselAPI::GrappleResult VesselAPI::AddCargo(int index, int slot)
 	// If the slot is closed
 	else if (!attachsMap[slot].opened) return GRAPPLE_SLOT_CLOSED;
 	// If a cargo is already attached to the slot
-	else if (VerifySlot(slot)) return GRAPPLE_SLOT_OCCUPIED;
+	else if (VerifySlot(slot) || virtualCargoMap.find(slot) != virtualCargoMap.end()) return GRAPPLE_SLOT_OCCUPIED;
 
-	std::string cargoName = availableCargoList[index];
+	std::string cargoName = availableCargo->cargoList[index];
 
 	std::string spawnName = cargoName;
 	UCSO::SetSpawnName(spawnName);
@@ -265,12 +543,12 @@ VesselAPI::GrappleResult VesselAPI::AddCargo(int index, int slot)
 	status.version = 2;
 	vessel->GetStatusEx(&status);
 
-	OBJHANDLE cargoHandle = oapiCreateVesselEx(spawnName.c_str(), className.c_str(), &status);
+	OBJHANDLE cargoHandle = CreateVessel(spawnName.c_str(), className.c_str(), &status);
 
 	// If the maximum cargo mass is set and the cargo mass is higher than it
 	if (maxCargoMass != -1) if (oapiGetMass(cargoHandle) > maxCargoMass) 
 	{
-		oapiDeleteVessel(cargoHandle);
+		DeleteVessel(cargoHandle);
 
 		return MAX_MASS_EXCEEDED;
 	}
@@ -278,7 +556,7 @@ VesselAPI::GrappleResult VesselAPI::AddCargo(int index, int slot)
 	// If the maximum total cargo mass is set and the cargo mass plus the total mass is higher than it
 	if (maxTotalCargoMass != -1) if (GetTotalCargoMass() + oapiGetMass(cargoHandle) > maxTotalCargoMass)
 	{ 
-		oapiDeleteVessel(cargoHandle);
+		DeleteVessel(cargoHandle);
 
 		return MAX_TOTAL_MASS_EXCEEDED;
 	}
@@ -286,122 +564,400 @@ VesselAPI::GrappleResult VesselAPI::AddCargo(int index, int slot)
 	// If the cargo isn't created
 	if (!cargoHandle) return GRAPPLE_FAILED;
 
-	UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+	return AttachAddedCargo(cargoHandle, slot);
+}
 
-	if (customCargo)
-	{
-		UCSO::CustomCargo* cargo = GetCustomCargo(cargoHandle);
+int VesselAPI::LoadManifest(const ManifestEntry* entries, int count, GrappleResult* results)
+{
+	if (!entries || !results || count <= 0) return 0;
 
-		if (!cargo || !vessel->AttachChild(cargoHandle, attachsMap[slot].attachHandle, cargo->GetCargoAttachmentHandle())) return GRAPPLE_FAILED;
-	}
-	else
+	// Add the entries one by one while logging, so each addition is logged and can be replayed
+	if (IsLoggingOperation())
 	{
-		UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle));
+		int addedCount = 0;
 
-		// If the cargo couldn't be attached
-		if (!vessel->AttachChild(cargo->GetHandle(), attachsMap[slot].attachHandle, cargo->GetAttachmentHandle(true, 0))) return GRAPPLE_FAILED;
-	}
+		for (int entry = 0; entry < count; entry++)
+		{
+			int index = entries[entry].cargoName ? GetAvailableCargoIndex(entries[entry].cargoName) : entries[entry].index;
 
-	return GRAPPLE_SUCCEEDED;
-}
+			results[entry] = AddCargo(index, entries[entry].slot);
 
-VesselAPI::GrappleResult VesselAPI::GrappleCargo(int slot)
-{
-	if (attachsMap.empty()) return GRAPPLE_SLOT_UNDEFINED;
-	else if (slot == -1) 
-	{
-		EmptyResult result = GetEmptySlot();
-		slot = result.slot;
-		if (slot == -1) return result.opened ? GRAPPLE_SLOT_OCCUPIED : GRAPPLE_SLOT_CLOSED;
+			if (results[entry] == GRAPPLE_SUCCEEDED) addedCount++;
+		}
+
+		return addedCount;
 	}
-	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return GRAPPLE_SLOT_UNDEFINED;
-	else if (!attachsMap[slot].opened) return GRAPPLE_SLOT_CLOSED;
-	else if (VerifySlot(slot)) return GRAPPLE_SLOT_OCCUPIED;
 
-	std::map<double, ResourceResult> cargoMap;
-	GrappleResult result = NO_CARGO_IN_RANGE;
+	StatisticsScope statisticsScope(this, LOAD_MANIFEST_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::LoadManifest");
 
-	VECTOR3 pos, rot, dir;
-	vessel->GetAttachmentParams(attachsMap[slot].attachHandle, pos, rot, dir);
+	// The slots which can take a cargo, in the same order as GetEmptySlot. They are removed when an entry takes them
+	std::set<int, std::less<int>, UCSO::CountingAllocator<int>> freeSlots;
+	bool anyOpened = false;
 
-	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	for (auto const& [slot, data] : attachsMap)
 	{
-		VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		if (!CheckAttachment(data.attachHandle)) continue;
 
-		// If the vessel is UCSO cargo
-		if (strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
-		
-		VECTOR3 cargoPos;
-		// Get the cargo position and convert it to local
-		cargo->GetGlobalPos(cargoPos);
-		vessel->Global2Local(cargoPos, cargoPos);
-		VECTOR3 subtract = pos - cargoPos;
+		if (data.opened) anyOpened = true;
 
-		double range = sqrt(subtract.x * subtract.x + subtract.z * subtract.z) - cargo->GetSize();
+		if (data.opened && !VerifySlot(slot) && virtualCargoMap.find(slot) == virtualCargoMap.end()) freeSlots.insert(slot);
+	}
 
-		// Proceed if the distance is lower than the grapple range and the cargo radius
-		if (range > grappleRange) continue;
+	std::map<std::string, int> nameMap;
 
-		// If the cargo is attached to another vessel
-		if (cargo->GetAttachmentStatus(cargo->GetAttachmentHandle(true, 0))) continue;
+	if (availableCargo) for (size_t cargo = 0; cargo < availableCargo->cargoList.size(); cargo++) nameMap.emplace(availableCargo->cargoList[cargo], int(cargo));
 
-		// If the maximum cargo mass is set and the cargo mass is higher than it
-		if (maxCargoMass != -1) if (cargo->GetMass() > maxCargoMass) { result = MAX_MASS_EXCEEDED; continue; }
+	struct PlannedCargo
+	{
+		int entry;
+		int slot;
+		const std::string* cargoName;
+	};
+
+	UCSO::CountedVector<PlannedCargo> plannedList;
+	std::map<std::string, double> massMap; // The packed mass of each class, or -1 if it's known only after the cargo is created
+	double totalCargoMass = GetTotalCargoMass();
+	double plannedMass = totalCargoMass;
+
+	// Check all the entries before creating any cargo
+	for (int entry = 0; entry < count; entry++)
+	{
+		const ManifestEntry& manifestEntry = entries[entry];
+		int index = manifestEntry.index;
 
-		// If the maximum total cargo mass is set and the cargo mass plus the total mass is higher than it
-		if (maxTotalCargoMass != -1)
-			if (GetTotalCargoMass() + cargo->GetMass() > maxTotalCargoMass) { result = MAX_TOTAL_MASS_EXCEEDED; continue; }
+		if (manifestEntry.cargoName)
+		{
+			auto nameIt = nameMap.find(manifestEntry.cargoName);
+			index = nameIt != nameMap.end() ? nameIt->second : -1;
+		}
 
-		UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
+		if (!availableCargo || index < 0 || index >= static_cast<int>(availableCargo->cargoList.size())) { results[entry] = NO_CARGO_IN_RANGE; continue; }
 
-		if (customCargo)
-		{
-			UCSO::CustomCargo::CargoInfo cargoInfo = customCargo->GetCargoInfo();
+		int slot = manifestEntry.slot;
 
-			if (evaMode || cargoInfo.type == STATIC || !cargoInfo.unpacked) cargoMap[range] = { false, customCargo };
-		}
-		else
+		if (attachsMap.empty()) { results[entry] = GRAPPLE_SLOT_UNDEFINED; continue; }
+		else if (slot == -1)
 		{
-			UCSO::Cargo* vCargo = static_cast<UCSO::Cargo*>(cargo);
-			UCSO::DataStruct dataStruct = vCargo->GetDataStruct();
+			// If no slot is empty
+			if (freeSlots.empty()) { results[entry] = anyOpened ? GRAPPLE_SLOT_OCCUPIED : GRAPPLE_SLOT_CLOSED; continue; }
 
-			// If grapple unpacked is true, or if it's false, then check if the cargo is packed
-			if (evaMode || dataStruct.type == STATIC || !dataStruct.unpacked) cargoMap[range] = { true, cargo };
+			slot = *freeSlots.begin();
 		}
-	}
+		else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) { results[entry] = GRAPPLE_SLOT_UNDEFINED; continue; }
+		else if (!attachsMap[slot].opened) { results[entry] = GRAPPLE_SLOT_CLOSED; continue; }
+		// If a cargo is already in the slot, or a previous entry takes it
+		else if (freeSlots.find(slot) == freeSlots.end()) { results[entry] = GRAPPLE_SLOT_OCCUPIED; continue; }
 
-	// If no cargo is added, return the latest cargo error
-	if (cargoMap.empty()) return result;
+		const std::string& cargoName = availableCargo->cargoList[index];
 
-	for (auto const& [range, data] : cargoMap)
-	{
-		if (data.normalCargo)
-		{
-			// If the cargo is attached
-			VESSEL* cargo = static_cast<VESSEL*>(data.cargo);
+		auto massIt = massMap.find(cargoName);
+		if (massIt == massMap.end()) massIt = massMap.emplace(cargoName, GetPackedCargoMass(cargoName)).first;
 
-			if (vessel->AttachChild(cargo->GetHandle(), attachsMap[slot].attachHandle, cargo->GetAttachmentHandle(true, 0)))
-				return GRAPPLE_SUCCEEDED;	
-		}
-		else 
+		double mass = massIt->second;
+
+		// If the mass is known, check it now. Otherwise, it's checked after the cargo is created as AddCargo does
+		if (mass != -1)
 		{
-			UCSO::CustomCargo* customCargo = static_cast<UCSO::CustomCargo*>(data.cargo);
+			if (maxCargoMass != -1 && mass > maxCargoMass) { results[entry] = MAX_MASS_EXCEEDED; continue; }
 
-			if (vessel->AttachChild(customCargo->GetCargoHandle(), attachsMap[slot].attachHandle, customCargo->GetCargoAttachmentHandle()))
-			{
-				customCargo->CargoGrappled();
+			if (maxTotalCargoMass != -1 && plannedMass + mass > maxTotalCargoMass) { results[entry] = MAX_TOTAL_MASS_EXCEEDED; continue; }
 
-				return GRAPPLE_SUCCEEDED;
-			}
+			plannedMass += mass;
 		}
-	}
 
-	return GRAPPLE_FAILED;
-}
+		freeSlots.erase(slot);
+		plannedList.push_back({ entry, slot, &cargoName });
+	}
 
-VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
-{
-	if (attachsMap.empty()) return RELEASE_SLOT_UNDEFINED;
+	if (plannedList.empty()) return 0;
+
+	// Get the vessel status once, as all the cargoes are created at the vessel
+	VESSELSTATUS2 status;
+	memset(&status, 0, sizeof(status));
+	status.version = 2;
+	vessel->GetStatusEx(&status);
+
+	// The next spawn number to probe of each cargo, so the names taken by the previous entries aren't probed again
+	std::map<std::string, int> spawnIndexMap;
+	int addedCount = 0;
+
+	for (const PlannedCargo& planned : plannedList)
+	{
+		const std::string& cargoName = *planned.cargoName;
+		int& spawnIndex = spawnIndexMap.emplace(cargoName, 1).first->second;
+
+		std::string spawnName = cargoName;
+		spawnIndex = UCSO::SetSpawnName(spawnName, spawnIndex) + 1;
+
+		std::string className = "UCSO/";
+		className += cargoName;
+
+		OBJHANDLE cargoHandle = CreateVessel(spawnName.c_str(), className.c_str(), &status);
+
+		// If the cargo isn't created
+		if (!cargoHandle) { results[planned.entry] = GRAPPLE_FAILED; continue; }
+
+		double mass = oapiGetMass(cargoHandle);
+
+		// Check the actual mass, as the mass of custom cargoes isn't known before they are created
+		if (maxCargoMass != -1 && mass > maxCargoMass)
+		{
+			DeleteVessel(cargoHandle);
+
+			results[planned.entry] = MAX_MASS_EXCEEDED;
+			continue;
+		}
+
+		if (maxTotalCargoMass != -1 && totalCargoMass + mass > maxTotalCargoMass)
+		{
+			DeleteVessel(cargoHandle);
+
+			results[planned.entry] = MAX_TOTAL_MASS_EXCEEDED;
+			continue;
+		}
+
+		results[planned.entry] = AttachAddedCargo(cargoHandle, planned.slot);
+
+		if (results[planned.entry] != GRAPPLE_SUCCEEDED) continue;
+
+		totalCargoMass += mass;
+		addedCount++;
+	}
+
+	return addedCount;
+}
+
+int VesselAPI::LoadManifestFile(const char* fileName, GrappleResult* results, int resultCount)
+{
+	if (!fileName) return -1;
+
+	FILE* file = fopen(fileName, "r");
+
+	if (!file) return -1;
+
+	std::vector<std::string> nameList;
+	UCSO::CountedVector<int> slotList;
+	char line[256];
+
+	while (fgets(line, sizeof(line), file))
+	{
+		std::istringstream ss(line);
+		std::string cargoName;
+
+		// If the line is empty or a comment
+		if (!(ss >> cargoName) || cargoName[0] == ';') continue;
+
+		int slot;
+		if (!(ss >> slot)) slot = -1;
+
+		nameList.push_back(cargoName);
+		slotList.push_back(slot);
+	}
+
+	fclose(file);
+
+	UCSO::CountedVector<ManifestEntry> entries(nameList.size());
+
+	for (size_t entry = 0; entry < entries.size(); entry++) entries[entry] = { nameList[entry].c_str(), -1, slotList[entry] };
+
+	UCSO::CountedVector<GrappleResult> resultList(entries.size());
+
+	int addedCount = LoadManifest(entries.data(), int(entries.size()), resultList.data());
+
+	if (results) for (int entry = 0; entry < resultCount && entry < int(resultList.size()); entry++) results[entry] = resultList[entry];
+
+	return addedCount;
+}
+
+VesselAPI::GrappleResult VesselAPI::AttachAddedCargo(OBJHANDLE cargoHandle, int slot)
+{
+	UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+
+	if (customCargo)
+	{
+		UCSO::CustomCargo* cargo = GetCustomCargo(cargoHandle);
+
+		if (!cargo || !vessel->AttachChild(cargoHandle, attachsMap[slot].attachHandle, cargo->GetCargoAttachmentHandle())) return GRAPPLE_FAILED;
+	}
+	else
+	{
+		UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle));
+
+		// Store the cargo in the slot if the virtual cargo mode is enabled
+		if (virtualCargo) return StoreVirtualCargo(slot, cargo) ? GRAPPLE_SUCCEEDED : GRAPPLE_FAILED;
+
+		// If the cargo couldn't be attached
+		if (!vessel->AttachChild(cargo->GetHandle(), attachsMap[slot].attachHandle, cargo->GetAttachmentHandle(true, 0))) return GRAPPLE_FAILED;
+	}
+
+	return GRAPPLE_SUCCEEDED;
+}
+
+int VesselAPI::GetAvailableCargoIndex(const char* cargoName)
+{
+	if (availableCargo) for (size_t index = 0; index < availableCargo->cargoList.size(); index++)
+		if (availableCargo->cargoList[index] == cargoName) return static_cast<int>(index);
+
+	return -1;
+}
+
+double VesselAPI::GetPackedCargoMass(const std::string& cargoName)
+{
+	UCSO::CargoConfig config;
+	UCSO::TextConfigReader reader;
+
+	if (!UCSO::ReadCompiledConfig(cargoName, config))
+	{
+		if (!reader.Parse(UCSO::GetConfigPath(cargoName))) return -1;
+
+		std::string module;
+
+		// If the cargo is a custom cargo, its mass is set by its own module
+		if (!reader.ReadString("Module", module) || !UCSO::IsCargoModule(module)) return -1;
+
+		std::vector<std::string> missingItems;
+
+		if (!UCSO::ReadCargoConfig(reader, config, missingItems)) return -1;
+	}
+
+	// The same mass as set by the cargo when it's created packed, with the resource full
+	switch (config.type)
+	{
+	case UCSO::CargoConfig::STATIC:
+	case UCSO::CargoConfig::RESOURCE:
+		return config.netMass + containerMass;
+	case UCSO::CargoConfig::PACKABLE_UNPACKABLE:
+	case UCSO::CargoConfig::UNPACKABLE_ONLY:
+		if (config.unpackingType == UCSO::CargoConfig::UCSO_RESOURCE) return containerMass + config.resourceContainerMass + config.netMass;
+
+		return config.netMass * config.spawnCount + containerMass;
+	default:
+		return -1;
+	}
+}
+
+
+VesselAPI::GrappleResult VesselAPI::GrappleCargo(int slot)
+{
+	if (IsLoggingOperation()) return LogOperation<GrappleResult>(MakeOperation(GRAPPLE_CARGO_OPERATION, slot), [&] { return GrappleCargo(slot); });
+
+	StatisticsScope statisticsScope(this, GRAPPLE_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::GrappleCargo");
+
+	if (attachsMap.empty()) return GRAPPLE_SLOT_UNDEFINED;
+	else if (slot == -1) 
+	{
+		EmptyResult result = GetEmptySlot();
+		slot = result.slot;
+		if (slot == -1) return result.opened ? GRAPPLE_SLOT_OCCUPIED : GRAPPLE_SLOT_CLOSED;
+	}
+	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return GRAPPLE_SLOT_UNDEFINED;
+	else if (!attachsMap[slot].opened) return GRAPPLE_SLOT_CLOSED;
+	else if (VerifySlot(slot) || virtualCargoMap.find(slot) != virtualCargoMap.end()) return GRAPPLE_SLOT_OCCUPIED;
+
+	UCSO::CountedMap<double, ResourceResult> cargoMap;
+	GrappleResult result = NO_CARGO_IN_RANGE;
+
+	VECTOR3 pos, rot, dir;
+	vessel->GetAttachmentParams(attachsMap[slot].attachHandle, pos, rot, dir);
+
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
+
+		// If the vessel is UCSO cargo
+		if (strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
+		
+		VECTOR3 cargoPos;
+		// Get the cargo position and convert it to local
+		cargo->GetGlobalPos(cargoPos);
+		vessel->Global2Local(cargoPos, cargoPos);
+		VECTOR3 subtract = pos - cargoPos;
+
+		double range = sqrt(subtract.x * subtract.x + subtract.z * subtract.z) - cargo->GetSize();
+
+		// Proceed if the distance is lower than the grapple range and the cargo radius
+		if (range > grappleRange) continue;
+
+		if (activeStats) activeStats->candidatesConsidered++;
+
+		// If the cargo is attached to another vessel
+		if (cargo->GetAttachmentStatus(cargo->GetAttachmentHandle(true, 0))) continue;
+
+		// If the maximum cargo mass is set and the cargo mass is higher than it
+		if (maxCargoMass != -1) if (cargo->GetMass() > maxCargoMass) { result = MAX_MASS_EXCEEDED; continue; }
+
+		// If the maximum total cargo mass is set and the cargo mass plus the total mass is higher than it
+		if (maxTotalCargoMass != -1)
+			if (GetTotalCargoMass() + cargo->GetMass() > maxTotalCargoMass) { result = MAX_TOTAL_MASS_EXCEEDED; continue; }
+
+		UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
+
+		if (customCargo)
+		{
+			UCSO::CustomCargo::CargoInfo cargoInfo = customCargo->GetCargoInfo();
+
+			if (evaMode || cargoInfo.type == UCSO::CustomCargo::STATIC || !cargoInfo.unpacked) cargoMap[range] = { false, customCargo };
+		}
+		else
+		{
+			UCSO::Cargo* vCargo = static_cast<UCSO::Cargo*>(cargo);
+			UCSO::DataStruct dataStruct = vCargo->GetDataStruct();
+
+			// If grapple unpacked is true, or if it's false, then check if the cargo is packed
+			if (evaMode || dataStruct.type == STATIC || !dataStruct.unpacked) cargoMap[range] = { true, cargo };
+		}
+	}
+
+	PalletResult palletResult = GetNearestPalletCargo(pos, grappleRange, &result);
+
+	// If a pallet cargo is nearer than the other cargoes, split it from the pallet
+	if (palletResult.pallet && (cargoMap.empty() || palletResult.range < cargoMap.begin()->first))
+		if (GrapplePalletCargo(slot, palletResult)) return GRAPPLE_SUCCEEDED;
+
+	// If no cargo is added, return the latest cargo error
+	if (cargoMap.empty()) return result;
+
+	for (auto const& [range, data] : cargoMap)
+	{
+		if (data.normalCargo)
+		{
+			VESSEL* cargo = static_cast<VESSEL*>(data.cargo);
+
+			// If the cargo is stored in the slot
+			if (virtualCargo)
+			{
+				if (StoreVirtualCargo(slot, cargo)) return GRAPPLE_SUCCEEDED;
+			}
+			// If the cargo is attached
+			else if (vessel->AttachChild(cargo->GetHandle(), attachsMap[slot].attachHandle, cargo->GetAttachmentHandle(true, 0)))
+				return GRAPPLE_SUCCEEDED;	
+		}
+		else 
+		{
+			UCSO::CustomCargo* customCargo = static_cast<UCSO::CustomCargo*>(data.cargo);
+
+			if (vessel->AttachChild(customCargo->GetCargoHandle(), attachsMap[slot].attachHandle, customCargo->GetCargoAttachmentHandle()))
+			{
+				customCargo->CargoGrappled();
+
+				return GRAPPLE_SUCCEEDED;
+			}
+		}
+	}
+
+	return GRAPPLE_FAILED;
+}
+
+VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
+{
+	if (IsLoggingOperation()) return LogOperation<ReleaseResult>(MakeOperation(RELEASE_CARGO_OPERATION, slot), [&] { return ReleaseCargo(slot); });
+
+	StatisticsScope statisticsScope(this, RELEASE_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::ReleaseCargo");
+
+	if (attachsMap.empty()) return RELEASE_SLOT_UNDEFINED;
 
 	OccupiedResult result;
 
@@ -409,8 +965,8 @@ VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
 	{
 		// Get the first occupied slot and OBJHANDLE for the attached cargo
 		result = GetOccupiedSlot();
-		// If the handle is nullptr
-		if (!result.handle) return result.opened ? RELEASE_SLOT_EMPTY : RELEASE_SLOT_CLOSED;
+		// If no slot is occupied
+		if (result.slot == -1) return result.opened ? RELEASE_SLOT_EMPTY : RELEASE_SLOT_CLOSED;
 		
 		slot = result.slot;
 	}
@@ -420,7 +976,31 @@ VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
 	else 
 	{
 		result.handle = VerifySlot(slot);
-		if (!result.handle) return RELEASE_SLOT_EMPTY;
+		if (!result.handle && virtualCargoMap.find(slot) == virtualCargoMap.end()) return RELEASE_SLOT_EMPTY;
+	}
+
+	bool landed = vessel->GetFlightStatus() & 1;
+
+	VECTOR3 pos, rot, dir;
+
+	if (landed)
+	{
+		// Get the attachment position
+		vessel->GetAttachmentParams(attachsMap[slot].attachHandle, pos, rot, dir);
+
+		if (!evaMode && !GetNearestEmptyLocation(pos)) return NO_EMPTY_POSITION;
+
+		// If the cargo pallets mode is enabled, merge the cargo with the adjacent pallet or cargo
+		if (!evaMode && cargoPallets && ReleasePalletCargo(slot, result.handle, pos)) return RELEASE_SUCCEEDED;
+	}
+
+	// If the cargo is virtual, create its vessel in the slot
+	bool virtualRelease = !result.handle;
+
+	if (virtualRelease)
+	{
+		result.handle = CreateVirtualCargo(slot);
+		if (!result.handle) return RELEASE_FAILED;
 	}
 
 	VESSEL* cargo = oapiGetVesselInterface(result.handle);
@@ -428,7 +1008,7 @@ VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
 	UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
 
 	// If the vessel is landed
-	if (vessel->GetFlightStatus() & 1)
+	if (landed)
 	{
 		VESSELSTATUS2 status;
 		memset(&status, 0, sizeof(status));
@@ -436,12 +1016,6 @@ VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
 
 		vessel->GetStatusEx(&status);
 
-		VECTOR3 pos, rot, dir;
-		// Get the attachment position
-		vessel->GetAttachmentParams(attachsMap[slot].attachHandle, pos, rot, dir);
-
-		if (!evaMode && !GetNearestEmptyLocation(pos)) return NO_EMPTY_POSITION;
-
 		// Rotate to the horizon frame
 		vessel->HorizonRot(pos, pos);
 
@@ -493,19 +1067,26 @@ VesselAPI::ReleaseResult VesselAPI::ReleaseCargo(int slot)
 	}
 
 	if (customCargo) customCargo->CargoReleased();
+	// The created cargo wasn't attached for a frame, so it couldn't detect the release by itself
+	else if (virtualRelease) static_cast<UCSO::Cargo*>(cargo)->CargoReleased();
 
 	return RELEASE_SUCCEEDED;
 }
 
 bool VesselAPI::PackCargo()
 {
+	if (IsLoggingOperation()) return LogOperation<bool>(MakeOperation(PACK_CARGO_OPERATION), [&] { return PackCargo(); });
+
+	StatisticsScope statisticsScope(this, PACK_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::PackCargo");
+
 	if (!version) return false;
 
-	std::map<double, ResourceResult> cargoMap;
+	UCSO::CountedMap<double, ResourceResult> cargoMap;
 
 	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
 	{
-		VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
 
 		// If the vessel isn't a UCSO cargo
 		if (strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
@@ -517,6 +1098,8 @@ bool VesselAPI::PackCargo()
 
 		if (range > unpackingRange) continue;
 
+		if (activeStats) activeStats->candidatesConsidered++;
+
 		UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
 
 		if (customCargo)
@@ -558,13 +1141,18 @@ bool VesselAPI::PackCargo()
 
 bool VesselAPI::UnpackCargo()
 {
+	if (IsLoggingOperation()) return LogOperation<bool>(MakeOperation(UNPACK_CARGO_OPERATION), [&] { return UnpackCargo(); });
+
+	StatisticsScope statisticsScope(this, UNPACK_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::UnpackCargo");
+
 	if (!version) return false;
 
-	std::map<double, ResourceResult> cargoMap;
+	UCSO::CountedMap<double, ResourceResult> cargoMap;
 
 	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
 	{
-		VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
 
 		// If the vessel is UCSO cargo
 		if (strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
@@ -576,6 +1164,8 @@ bool VesselAPI::UnpackCargo()
 
 		if (range > unpackingRange) continue;
 
+		if (activeStats) activeStats->candidatesConsidered++;
+
 		UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
 
 		if (customCargo)
@@ -624,6 +1214,11 @@ bool VesselAPI::UnpackCargo()
 
 VesselAPI::ReleaseResult VesselAPI::DeleteCargo(int slot)
 {
+	if (IsLoggingOperation()) return LogOperation<ReleaseResult>(MakeOperation(DELETE_CARGO_OPERATION, slot), [&] { return DeleteCargo(slot); });
+
+	StatisticsScope statisticsScope(this, DELETE_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::DeleteCargo");
+
 	if (attachsMap.empty()) return RELEASE_SLOT_UNDEFINED;
 
 	OccupiedResult result;
@@ -632,8 +1227,8 @@ VesselAPI::ReleaseResult VesselAPI::DeleteCargo(int slot)
 	{
 		// Get the first occupied slot and OBJHANDLE for the attached cargo
 		result = GetOccupiedSlot();
-		// If the handle is nullptr
-		if (!result.handle) return result.opened ? RELEASE_SLOT_EMPTY : RELEASE_SLOT_CLOSED;
+		// If no slot is occupied
+		if (result.slot == -1) return result.opened ? RELEASE_SLOT_EMPTY : RELEASE_SLOT_CLOSED;
 
 		slot = result.slot;
 	}
@@ -643,7 +1238,18 @@ VesselAPI::ReleaseResult VesselAPI::DeleteCargo(int slot)
 	else
 	{
 		result.handle = VerifySlot(slot);
-		if (!result.handle) return RELEASE_SLOT_EMPTY;
+		if (!result.handle && virtualCargoMap.find(slot) == virtualCargoMap.end()) return RELEASE_SLOT_EMPTY;
+	}
+
+	auto virtualIt = virtualCargoMap.find(slot);
+
+	// If the cargo is virtual, remove its record and its mass from the vessel
+	if (virtualIt != virtualCargoMap.end())
+	{
+		vessel->SetEmptyMass(vessel->GetEmptyMass() - virtualIt->second.mass);
+		virtualCargoMap.erase(virtualIt);
+
+		return RELEASE_SUCCEEDED;
 	}
 
 	OBJHANDLE cargoHandle;
@@ -652,46 +1258,213 @@ VesselAPI::ReleaseResult VesselAPI::DeleteCargo(int slot)
 	// If no cargo is attached to the slot
 	if (!cargoHandle) return RELEASE_SLOT_EMPTY;
 
-	if (!oapiDeleteVessel(cargoHandle)) return RELEASE_FAILED;
+	if (!DeleteCargoVessel(cargoHandle)) return RELEASE_FAILED;
 
 	return RELEASE_SUCCEEDED;
 }
 
-double VesselAPI::DrainCargoResource(const char* resource, double mass, int slot)
+VesselAPI::TransferResult VesselAPI::TransferCargo(UCSO::Vessel* targetVessel, int fromSlot, int toSlot)
 {
-	if (attachsMap.empty() || mass <= 0 || !resource || !*resource) return 0;
+	if (IsLoggingOperation())
+	{
+		// The target is logged by its vessel name, so the replay can find its registered instance
+		char targetName[256] = "";
+		OBJHANDLE hTarget = targetVessel ? sharedRuntime->GetRegisteredHandle(targetVessel) : nullptr;
+		if (hTarget) oapiGetObjectName(hTarget, targetName, sizeof(targetName));
 
-	ResourceResult result;
+		return LogOperation<TransferResult>(MakeOperation(TRANSFER_CARGO_OPERATION, fromSlot, toSlot, 0, targetName),
+			[&] { return TransferCargo(targetVessel, fromSlot, toSlot); });
+	}
 
-	if (slot == -1) 
+	StatisticsScope statisticsScope(this, TRANSFER_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::TransferCargo");
+
+	if (!targetVessel || targetVessel == this) return TRANSFER_NOT_IN_RANGE;
+	else if (attachsMap.empty()) return TRANSFER_SLOT_UNDEFINED;
+
+	// The target can be built against an older header without AcceptTransferredCargo, so its interface version is checked before calling it
+	if (!targetVessel->GetUCSOVersion() || sharedRuntime->GetInterfaceVersion(targetVessel) < ACCEPT_TRANSFER_INTERFACE_VERSION) return TRANSFER_FAILED;
+
+	if (fromSlot == -1)
 	{
-		// Get the first resource cargo
-		result = GetResourceCargo(resource);
-		if (!result.cargo) return 0;
+		// Get the first occupied slot
+		OccupiedResult result = GetOccupiedSlot();
+		// If no slot is occupied
+		if (result.slot == -1) return result.opened ? TRANSFER_SLOT_EMPTY : TRANSFER_SLOT_CLOSED;
+
+		fromSlot = result.slot;
 	}
-	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return 0;
-	else 
-	{
-		OBJHANDLE cargoHandle = VerifySlot(slot);
+	else if (attachsMap.find(fromSlot) == attachsMap.end() || !CheckAttachment(attachsMap[fromSlot].attachHandle)) return TRANSFER_SLOT_UNDEFINED;
+	else if (!attachsMap[fromSlot].opened) return TRANSFER_SLOT_CLOSED;
+	else if (!VerifySlot(fromSlot) && virtualCargoMap.find(fromSlot) == virtualCargoMap.end()) return TRANSFER_SLOT_EMPTY;
 
-		// If no cargo is attached in the given slot
-		if (!cargoHandle) return 0;
+	auto virtualIt = virtualCargoMap.find(fromSlot);
+	bool virtualSource = virtualIt != virtualCargoMap.end();
+	OBJHANDLE cargoHandle;
 
-		UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+	// If the cargo is virtual, create its vessel in the slot, so the target takes it as an attached cargo
+	if (virtualSource)
+	{
+		UCSO::CargoRecord record = virtualIt->second;
 
-		if (customCargo)
-		{
-			if (customCargo->GetCargoInfo().resource != resource) return 0;
-			result = { false, customCargo };
-		}
+		vessel->SetEmptyMass(vessel->GetEmptyMass() - record.mass);
+		virtualCargoMap.erase(virtualIt);
 
-		else
-		{ 
-			UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle));
+		cargoHandle = CreateCargo(fromSlot, record);
 
-			if (cargo->GetDataStruct().resource != resource) return 0;
+		if (!cargoHandle)
+		{
+			virtualCargoMap[fromSlot] = record;
+			vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
 
-			result = { true, cargo };
+			return TRANSFER_FAILED;
+		}
+	}
+	else cargoHandle = VerifySlot(fromSlot);
+
+	UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+	VESSEL* cargo = oapiGetVesselInterface(cargoHandle);
+
+	ATTACHMENTHANDLE cargoAttachHandle = customCargo ? customCargo->GetCargoAttachmentHandle() : cargo->GetAttachmentHandle(true, 0);
+
+	// Detach the cargo, so the target can attach it to its slot
+	bool detached = vessel->DetachChild(attachsMap[fromSlot].attachHandle);
+
+	TransferResult result = detached ? targetVessel->AcceptTransferredCargo(cargoHandle, toSlot) : TRANSFER_FAILED;
+
+	if (result == TRANSFER_SUCCEEDED) return result;
+
+	// Return the cargo to the source slot as it was
+	if (virtualSource) StoreVirtualCargo(fromSlot, cargo);
+	else if (detached) vessel->AttachChild(cargoHandle, attachsMap[fromSlot].attachHandle, cargoAttachHandle);
+
+	return result;
+}
+
+VesselAPI::TransferResult VesselAPI::AcceptTransferredCargo(OBJHANDLE cargoHandle, int slot)
+{
+	if (IsLoggingOperation())
+	{
+		char cargoName[256] = "";
+		if (cargoHandle) oapiGetObjectName(cargoHandle, cargoName, sizeof(cargoName));
+
+		return LogOperation<TransferResult>(MakeOperation(ACCEPT_TRANSFERRED_CARGO_OPERATION, slot, 0, 0, cargoName),
+			[&] { return AcceptTransferredCargo(cargoHandle, slot); });
+	}
+
+	// If another vessel's replay transfers the cargo, keep the result for the logged call in this vessel's replay
+	if (!replayList.empty() && !replayingOperation && cargoHandle)
+	{
+		char cargoName[256];
+		oapiGetObjectName(cargoHandle, cargoName, sizeof(cargoName));
+
+		replayingOperation = true;
+		TransferResult result = AcceptTransferredCargo(cargoHandle, slot);
+		replayingOperation = false;
+
+		acceptedReplayList.push_back({ cargoName, result });
+
+		return result;
+	}
+
+	StatisticsScope statisticsScope(this, ACCEPT_TRANSFERRED_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::AcceptTransferredCargo");
+
+	if (!cargoHandle) return TRANSFER_FAILED;
+	else if (attachsMap.empty()) return TRANSFER_SLOT_UNDEFINED;
+	else if (slot == -1)
+	{
+		// Get the first empty slot
+		EmptyResult result = GetEmptySlot();
+		// If no slot is empty
+		if (result.slot == -1) return result.opened ? TRANSFER_SLOT_OCCUPIED : TRANSFER_SLOT_CLOSED;
+
+		slot = result.slot;
+	}
+	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return TRANSFER_SLOT_UNDEFINED;
+	else if (!attachsMap[slot].opened) return TRANSFER_SLOT_CLOSED;
+	else if (VerifySlot(slot) || virtualCargoMap.find(slot) != virtualCargoMap.end()) return TRANSFER_SLOT_OCCUPIED;
+
+	UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+	VESSEL* cargo = oapiGetVesselInterface(cargoHandle);
+
+	VECTOR3 pos, rot, dir;
+	vessel->GetAttachmentParams(attachsMap[slot].attachHandle, pos, rot, dir);
+
+	VECTOR3 cargoPos;
+	// Get the cargo position and convert it to local
+	cargo->GetGlobalPos(cargoPos);
+	vessel->Global2Local(cargoPos, cargoPos);
+	VECTOR3 subtract = pos - cargoPos;
+
+	// If the cargo is out of the grapple range of the slot, which is measured as in GrappleCargo
+	if (sqrt(subtract.x * subtract.x + subtract.z * subtract.z) - cargo->GetSize() > grappleRange) return TRANSFER_NOT_IN_RANGE;
+
+	double cargoMass = oapiGetMass(cargoHandle);
+
+	// If the maximum cargo mass is set and the cargo mass is higher than it
+	if (maxCargoMass != -1) if (cargoMass > maxCargoMass) return TRANSFER_MAX_MASS_EXCEEDED;
+
+	// If the maximum total cargo mass is set and the cargo mass plus the total mass is higher than it
+	if (maxTotalCargoMass != -1) if (GetTotalCargoMass() + cargoMass > maxTotalCargoMass) return TRANSFER_MAX_TOTAL_MASS_EXCEEDED;
+
+	// Store the cargo in the slot if the virtual cargo mode is enabled
+	if (!customCargo && virtualCargo) return StoreVirtualCargo(slot, cargo) ? TRANSFER_SUCCEEDED : TRANSFER_FAILED;
+
+	ATTACHMENTHANDLE cargoAttachHandle = customCargo ? customCargo->GetCargoAttachmentHandle() : cargo->GetAttachmentHandle(true, 0);
+
+	return vessel->AttachChild(cargoHandle, attachsMap[slot].attachHandle, cargoAttachHandle) ? TRANSFER_SUCCEEDED : TRANSFER_FAILED;
+}
+
+double VesselAPI::DrainCargoResource(const char* resource, double mass, int slot)
+{
+	if (IsLoggingOperation()) return LogOperation<double>(MakeOperation(DRAIN_CARGO_RESOURCE_OPERATION, slot, 0, mass, resource), [&] { return DrainCargoResource(resource, mass, slot); });
+
+	StatisticsScope statisticsScope(this, DRAIN_CARGO_RESOURCE_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::DrainCargoResource");
+
+	if (attachsMap.empty() || mass <= 0 || !resource || !*resource) return 0;
+
+	ResourceResult result;
+
+	if (slot == -1) 
+	{
+		// Get the first resource cargo
+		result = GetResourceCargo(resource);
+		if (result.virtualCargo) return DrainVirtualCargo(*result.virtualCargo, mass);
+		if (!result.cargo) return 0;
+	}
+	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return 0;
+	else if (virtualCargoMap.find(slot) != virtualCargoMap.end())
+	{
+		UCSO::CargoRecord& record = virtualCargoMap[slot];
+
+		if (record.dataStruct.resource != resource) return 0;
+
+		return DrainVirtualCargo(record, mass);
+	}
+	else 
+	{
+		OBJHANDLE cargoHandle = VerifySlot(slot);
+
+		// If no cargo is attached in the given slot
+		if (!cargoHandle) return 0;
+
+		UCSO::CustomCargo* customCargo = GetCustomCargo(cargoHandle);
+
+		if (customCargo)
+		{
+			if (customCargo->GetCargoInfo().resource != resource) return 0;
+			result = { false, customCargo };
+		}
+
+		else
+		{ 
+			UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle));
+
+			if (cargo->GetDataStruct().resource != resource) return 0;
+
+			result = { true, cargo };
 		}
 	}
 
@@ -701,17 +1474,24 @@ double VesselAPI::DrainCargoResource(const char* resource, double mass, int slot
 
 double VesselAPI::DrainStationOrUnpackedResource(const char* resource, double mass)
 {
+	if (IsLoggingOperation()) return LogOperation<double>(MakeOperation(DRAIN_STATION_OR_UNPACKED_RESOURCE_OPERATION, 0, 0, mass, resource), [&] { return DrainStationOrUnpackedResource(resource, mass); });
+
+	StatisticsScope statisticsScope(this, DRAIN_STATION_OR_UNPACKED_RESOURCE_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::DrainStationOrUnpackedResource");
+
 	if (!version || mass <= 0 || !resource || !*resource) return 0;
 
 	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
 	{
-		VESSEL* oVessel = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		VESSEL* oVessel = GetVesselByIndex(vesselIndex);
 
 		VECTOR3 pos;
 		vessel->GetRelativePos(oVessel->GetHandle(), pos);
 
 		if ((length(pos) - oVessel->GetSize()) > resourceRange) continue;
 
+		if (activeStats) activeStats->candidatesConsidered++;
+
 		if (strncmp(oVessel->GetClassNameA(), "UCSO", 4) == 0)
 		{
 			UCSO::CustomCargo* customCargo = GetCustomCargo(oVessel->GetHandle());
@@ -739,7 +1519,9 @@ double VesselAPI::DrainStationOrUnpackedResource(const char* resource, double ma
 		// Search through the vessel attachments to check if it's a station
 		for (DWORD attachIndex = 0; attachIndex < oVessel->AttachmentCount(true); attachIndex++)
 		{
-			if (oVessel->GetAttachmentId(oVessel->GetAttachmentHandle(true, attachIndex)) != "UCSO_ST") continue;
+			if (strcmp(oVessel->GetAttachmentId(oVessel->GetAttachmentHandle(true, attachIndex)), "UCSO_ST")) continue;
+
+			UCSO::TraceScope traceScope("VesselAPI::ReadStationConfig");
 
 			// Set the vessel configuration file
 			std::string configFile = "Vessels/";
@@ -749,6 +1531,8 @@ double VesselAPI::DrainStationOrUnpackedResource(const char* resource, double ma
 			// Open the file
 			FILEHANDLE configHandle = oapiOpenFile(configFile.c_str(), FILE_IN_ZEROONFAIL, CONFIG);
 
+			if (activeStats) activeStats->filesOpened++;
+
 			// If it failed, go to the next vessel.
 			if (!configHandle) break;
 
@@ -814,13 +1598,16 @@ bool VesselAPI::InBreathableCargo()
 
 VESSEL* VesselAPI::GetNearestBreathableCargo()
 {
+	StatisticsScope statisticsScope(this, GET_NEAREST_BREATHABLE_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::GetNearestBreathableCargo");
+
 	if (!version) return nullptr;
 
 	std::pair<double, VESSEL*> pair = { breathableRange, nullptr };
 
 	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
 	{
-		VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
 
 		// If the vessel isn't a UCSO cargo
 		if (strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
@@ -832,6 +1619,8 @@ VESSEL* VesselAPI::GetNearestBreathableCargo()
 
 		if (distance > pair.first) continue;
 
+		if (activeStats) activeStats->candidatesConsidered++;
+
 		UCSO::CustomCargo* customCargo = GetCustomCargo(cargo->GetHandle());
 
 		if (customCargo)
@@ -857,32 +1646,18 @@ const char* VesselAPI::SetSpawnName(const char* spawnName)
 {
 	std::string name = spawnName;
 	UCSO::SetSpawnName(name);
-	return _strdup(name.c_str());
+	return UCSO::CountedDuplicate(name.c_str());
 }
 
 void VesselAPI::SetGroundRotation(VESSELSTATUS2& status, double spawnHeight) { UCSO::SetGroundRotation(status, spawnHeight); }
 
-void VesselAPI::InitAvailableCargo()
-{
-	// Itereate through every file in Config/Vessels/UCSO
-	for (const std::filesystem::directory_entry& entry :
-					std::filesystem::directory_iterator(std::filesystem::current_path().string() + "/Config/Vessels/UCSO")) 
-	{
-		// Get the filename
-		std::string path = entry.path().filename().string();
-
-		// Remove .cfg from the filename
-		availableCargoList.push_back(path.substr(0, path.find(".cfg")));
-	}
-}
-
-std::vector<VECTOR3> VesselAPI::GetGroundList(VECTOR3 initialPos)
+UCSO::CountedVector<VECTOR3> VesselAPI::GetGroundList(VECTOR3 initialPos)
 {
-	std::vector<VECTOR3> groundList;
+	UCSO::CountedVector<VECTOR3> groundList;
 
 	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
 	{
-		VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
 
 		if (!cargo->GroundContact() || strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
 
@@ -899,49 +1674,74 @@ std::vector<VECTOR3> VesselAPI::GetGroundList(VECTOR3 initialPos)
 		if (subtract.x <= 11 && subtract.x >= 3.5 && subtract.z <= rowLength) groundList.push_back(cargoPos);
 	}
 
+	// Add the pallet cargoes, as they take the positions of the merged cargoes
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* pallet = GetVesselByIndex(vesselIndex);
+
+		if (!HasAttachmentId(pallet, "UCSO_PL")) continue;
+
+		UCSO::Pallet* palletVessel = static_cast<UCSO::Pallet*>(pallet);
+
+		UCSO::CargoRecord record;
+		VECTOR3 itemPos;
+
+		for (int index = 0; palletVessel->GetItem(index, record, itemPos); index++)
+		{
+			VECTOR3 cargoPos = GetPalletCargoPos(palletVessel, itemPos);
+			VECTOR3 subtract = cargoPos - initialPos;
+
+			if (subtract.x <= 11 && subtract.x >= 3.5 && subtract.z <= rowLength) groundList.push_back(cargoPos);
+		}
+	}
+
 	return groundList;
 }
 
 bool VesselAPI::GetNearestEmptyLocation(VECTOR3& initialPos)
 {
-	std::vector<VECTOR3> groundList = GetGroundList(initialPos);
+	UCSO::CountedVector<VECTOR3> groundList = GetGroundList(initialPos);
+
+	// Sort the cargoes by the row axis, so each position is only checked against the cargoes near its row
+	std::sort(groundList.begin(), groundList.end(), [](const VECTOR3& first, const VECTOR3& second) { return first.z < second.z; });
 
 	// Add the release distance
 	initialPos.x += 5;
 
-	double length = 0;
+	// Check the positions in the same order as they are filled, 4 positions per row, 1.5 meters apart
+	// Stop after the row length, so the worst case is bounded by the positions count and not by the collisions
+	for (double length = 0; ; length += 1.5)
+	{
+		int row = static_cast<int>(length / 6);
+
+		VECTOR3 releasePos = initialPos;
+		releasePos.z += row * 1.5;
+		releasePos.x += length - row * 6.0;
 
-	VECTOR3 releasePos = initialPos;
+		// If the availale position is too far
+		if (releasePos.z - initialPos.z > rowLength) return false;
 
-loop:
-	for (VECTOR3& cargoPos : groundList)
-	{
-		// Orbiter SDK function length isn't used, as the elevetion (Y-axis) doesn't matter here
-		// It'll cause problems
-		VECTOR3 subtract = releasePos - cargoPos;
+		// Get the first cargo which can be within 1.5 meters on the row axis
+		auto cargoIt = std::lower_bound(groundList.begin(), groundList.end(), releasePos.z - 1.5,
+			[](const VECTOR3& cargoPos, double z) { return cargoPos.z < z; });
 
-		// Proceed if the distance is lower than 1 meter
-		if (sqrt(subtract.x * subtract.x + subtract.z * subtract.z) >= 1.5) continue;
+		bool empty = true;
 
-		// Reset the position to the initial position
-		releasePos = initialPos;
-		// Add distance between cargo which is 1.5 meter
-		length += 1.5;
-		// If the distance will exceed the column length (which is 6 meters), add new row
-		// Integer division here so only add if it exceeds (otherwise it won't increase)
-		releasePos.z += static_cast<int>(length / 6) * 1.5;
-		// Don't ask me how I made this, it just works
-		releasePos.x += length - (static_cast<int>(length / 6) * 6.0);
-		// Run the loop again, as the new positon could interfer with a previous cargo
-		goto loop;
-	}
+		for (; cargoIt != groundList.end() && cargoIt->z < releasePos.z + 1.5; ++cargoIt)
+		{
+			// Orbiter SDK function length isn't used, as the elevetion (Y-axis) doesn't matter here
+			VECTOR3 subtract = releasePos - *cargoIt;
 
-	// If the availale position is too far
-	if (releasePos.z - initialPos.z > rowLength) return false;
+			// If the distance is lower than 1.5 meter
+			if (sqrt(subtract.x * subtract.x + subtract.z * subtract.z) < 1.5) { empty = false; break; }
+		}
 
-	initialPos = releasePos;
+		if (!empty) continue;
 
-	return true;
+		initialPos = releasePos;
+
+		return true;
+	}
 }
 
 bool VesselAPI::CheckAttachment(ATTACHMENTHANDLE attachHandle)
@@ -949,7 +1749,45 @@ bool VesselAPI::CheckAttachment(ATTACHMENTHANDLE attachHandle)
 	// If the attachment is invalid, this will throw an error which will be redirect to ExceptionHandler
 	// Which will throw a normal exception
 	try { vessel->GetAttachmentIndex(attachHandle); return true; }
-	catch (...) { return false; }
+	catch (...)
+	{
+		if (activeStats) activeStats->attachmentExceptions++;
+
+		return false;
+	}
+}
+
+VESSEL* VesselAPI::GetVesselByIndex(DWORD vesselIndex)
+{
+	if (activeStats) activeStats->vesselsVisited++;
+
+	return oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+}
+
+OBJHANDLE VesselAPI::CreateVessel(const char* name, const char* className, VESSELSTATUS2* status)
+{
+	OBJHANDLE handle = oapiCreateVesselEx(name, className, status);
+
+	if (activeStats && handle) activeStats->vesselsCreated++;
+
+	return handle;
+}
+
+bool VesselAPI::DeleteVessel(OBJHANDLE handle, OBJHANDLE focusHandle)
+{
+	if (!oapiDeleteVessel(handle, focusHandle)) return false;
+
+	if (activeStats) activeStats->vesselsDeleted++;
+
+	return true;
+}
+
+bool VesselAPI::DeleteCargoVessel(OBJHANDLE cargoHandle, OBJHANDLE focusHandle)
+{
+	// If it's a UCSO cargo
+	if (!GetCustomCargo(cargoHandle)) static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle))->PrepareDeletion();
+
+	return DeleteVessel(cargoHandle, focusHandle);
 }
 
 OBJHANDLE VesselAPI::VerifySlot(int slot)
@@ -968,8 +1806,8 @@ VesselAPI::EmptyResult VesselAPI::GetEmptySlot()
 		// If the slot is invalid
 		if (!opened || !CheckAttachment(data.attachHandle)) continue;
 
-		// If no vessel is attached
-		if (!VerifySlot(slot)) return { slot, true };
+		// If no vessel is attached or stored
+		if (!VerifySlot(slot) && virtualCargoMap.find(slot) == virtualCargoMap.end()) return { slot, true };
 	}
 
 	return { -1, opened };
@@ -988,8 +1826,8 @@ VesselAPI::OccupiedResult VesselAPI::GetOccupiedSlot()
 
 		OBJHANDLE handle = vessel->GetAttachmentStatus(data.attachHandle);
 
-		// If there is an attached cargo
-		if (handle) return { slot, true, handle };
+		// If there is an attached or stored cargo
+		if (handle || virtualCargoMap.find(slot) != virtualCargoMap.end()) return { slot, true, handle };
 	}
 
 	return { -1, opened, nullptr };
@@ -1001,6 +1839,17 @@ VesselAPI::ResourceResult VesselAPI::GetResourceCargo(std::string resource)
 	{
 		if (!CheckAttachment(data.attachHandle)) continue;
 
+		auto virtualIt = virtualCargoMap.find(slot);
+
+		if (virtualIt != virtualCargoMap.end())
+		{
+			UCSO::DataStruct& dataStruct = virtualIt->second.dataStruct;
+
+			if (dataStruct.type == RESOURCE && dataStruct.netMass > 0 && dataStruct.resource == resource) return { false, nullptr, &virtualIt->second };
+
+			continue;
+		}
+
 		OBJHANDLE cargoHandle = vessel->GetAttachmentStatus(data.attachHandle);
 
 		if (!cargoHandle) continue;
@@ -1026,4 +1875,889 @@ VesselAPI::ResourceResult VesselAPI::GetResourceCargo(std::string resource)
 	}
 
 	return { false, nullptr };
+}
+
+void VesselAPI::SaveVirtualCargo(FILEHANDLE scn)
+{
+	if (inventorySnapshot && !virtualCargoMap.empty())
+	{
+		std::string fileName = WriteInventorySnapshot();
+
+		if (!fileName.empty())
+		{
+			oapiWriteScenario_string(scn, "UCSO_Inventory", &fileName[0]);
+			return;
+		}
+
+		oapiWriteLog("UCSO API Warning: Couldn't write the inventory snapshot. The virtual cargoes are written to the scenario");
+	}
+
+	for (auto const& [slot, record] : virtualCargoMap)
+	{
+		std::ostringstream ss;
+		ss.precision(12);
+
+		ss << slot << ' ' << record.className << ' ' << record.name << ' ';
+		UCSO::WriteCargoRecord(ss, record);
+
+		std::string line = ss.str();
+
+		oapiWriteScenario_string(scn, "UCSO_VirtualCargo", &line[0]);
+	}
+}
+
+bool VesselAPI::LoadVirtualCargo(const char* line)
+{
+	std::istringstream ss;
+	ss.str(line);
+	std::string data;
+
+	if (!(ss >> data)) return false;
+
+	if (data == "UCSO_Inventory")
+	{
+		std::string fileName;
+
+		// Read the rest of the line, as the file name of an older snapshot can have spaces
+		if (!std::getline(ss >> std::ws, fileName) || !ReadInventorySnapshot(fileName)) oapiWriteLog("UCSO API Warning: Couldn't load the inventory snapshot from the scenario");
+
+		return true;
+	}
+
+	if (data != "UCSO_VirtualCargo") return false;
+
+	int slot;
+	UCSO::CargoRecord record;
+
+	ss >> slot >> record.className >> record.name;
+
+	if (!UCSO::ReadCargoRecord(ss, record))
+	{
+		oapiWriteLog("UCSO API Warning: Couldn't load a virtual cargo from the scenario");
+		return true;
+	}
+
+	virtualCargoMap[slot] = record;
+
+	// Add the cargo mass to the vessel, as it's not attached as a vessel
+	vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
+
+	return true;
+}
+
+void VesselAPI::SetInventorySnapshot(bool inventorySnapshot) { this->inventorySnapshot = inventorySnapshot; }
+
+std::string VesselAPI::WriteInventorySnapshot()
+{
+	UCSO::TraceScope traceScope("VesselAPI::WriteInventorySnapshot");
+
+	std::string buffer = UCSO::WriteInventorySnapshot(virtualCargoMap);
+
+	// FNV-1a hash of the snapshot, so the same cargoes are written to the same file, and a changed state doesn't overwrite the file of an older scenario
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (char byte : buffer) { hash ^= static_cast<unsigned char>(byte); hash *= 1099511628211ULL; }
+
+	char hashString[17];
+	sprintf(hashString, "%016llx", static_cast<unsigned long long>(hash));
+
+	// The escaped name has no underscores, so the files of this vessel are the ones which start with it and an underscore
+	std::string filePrefix = UCSO::EscapeFileName(vessel->GetName()) + '_';
+	std::string fileName = std::string(INVENTORY_SNAPSHOT_FOLDER) + '/' + filePrefix + hashString + ".uci";
+
+	std::error_code error;
+
+	// If the same snapshot is already written, mark it as the newest, so it isn't removed below
+	if (std::filesystem::file_size(fileName, error) == buffer.size())
+		std::filesystem::last_write_time(fileName, std::filesystem::file_time_type::clock::now(), error);
+	else
+	{
+		std::filesystem::create_directories(INVENTORY_SNAPSHOT_FOLDER, error);
+
+		FILE* file = fopen(fileName.c_str(), "wb");
+
+		if (!file) return std::string();
+
+		bool written = fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+
+		if (fclose(file) || !written) { remove(fileName.c_str()); return std::string(); }
+	}
+
+	RemoveOldInventorySnapshots(filePrefix);
+
+	return fileName;
+}
+
+void VesselAPI::RemoveOldInventorySnapshots(const std::string& filePrefix)
+{
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> fileList;
+
+	std::error_code error;
+
+	for (std::filesystem::directory_iterator fileIt(INVENTORY_SNAPSHOT_FOLDER, error), end; !error && fileIt != end; fileIt.increment(error))
+	{
+		std::string fileName = fileIt->path().filename().string();
+
+		// The prefix, the 16 hash digits and the extension
+		if (fileName.size() != filePrefix.size() + 20 || fileName.compare(0, filePrefix.size(), filePrefix) ||
+			fileName.compare(fileName.size() - 4, 4, ".uci")) continue;
+
+		std::error_code timeError;
+		std::filesystem::file_time_type writeTime = fileIt->last_write_time(timeError);
+
+		if (!timeError) fileList.emplace_back(writeTime, fileIt->path());
+	}
+
+	if (fileList.size() <= INVENTORY_SNAPSHOT_LIMIT) return;
+
+	// Keep the newest snapshots, which the recent scenarios use
+	std::sort(fileList.begin(), fileList.end(), [](const auto& first, const auto& second) { return first.first > second.first; });
+
+	for (size_t index = INVENTORY_SNAPSHOT_LIMIT; index < fileList.size(); index++) std::filesystem::remove(fileList[index].second, error);
+}
+
+bool VesselAPI::ReadInventorySnapshot(const std::string& fileName)
+{
+	UCSO::TraceScope traceScope("VesselAPI::ReadInventorySnapshot");
+
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+
+	// Map the file, so it's read in one pass without copying it
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	const char* view = mapping ? static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+
+	std::map<int, UCSO::CargoRecord> recordMap;
+	bool read = false;
+
+	if (view)
+	{
+		read = UCSO::ReadInventorySnapshot(view, static_cast<size_t>(fileSize.QuadPart), recordMap);
+
+		UnmapViewOfFile(view);
+	}
+
+	if (mapping) CloseHandle(mapping);
+	CloseHandle(file);
+
+	// If the snapshot is invalid, no cargo is loaded from it
+	if (!read) return false;
+
+	for (auto& [slot, record] : recordMap)
+	{
+		// Add the cargo mass to the vessel, as it's not attached as a vessel
+		vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
+
+		virtualCargoMap[slot] = std::move(record);
+	}
+
+	return true;
+}
+
+int VesselAPI::GetDepotCargoCount(const char* cargoName, const char* resource)
+{
+	UCSO::Depot* depot = GetNearestDepot();
+
+	return depot ? depot->GetCargoCount(cargoName, resource, -1) : 0;
+}
+
+int VesselAPI::PullDepotCargo(int count, const char* cargoName, const char* resource)
+{
+	if (IsLoggingOperation()) return LogOperation<int>(MakeOperation(PULL_DEPOT_CARGO_OPERATION, count, 0, 0, cargoName, resource), [&] { return PullDepotCargo(count, cargoName, resource); });
+
+	StatisticsScope statisticsScope(this, PULL_DEPOT_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::PullDepotCargo");
+
+	if (attachsMap.empty()) return 0;
+
+	UCSO::Depot* depot = GetNearestDepot();
+	if (!depot) return 0;
+
+	int pulledCount = 0;
+
+	for (; pulledCount < count; pulledCount++)
+	{
+		int slot = GetEmptySlot().slot;
+		// If no slot is empty
+		if (slot == -1) break;
+
+		double maxMass = maxCargoMass;
+
+		// If the maximum total cargo mass is set, the cargo mass must be within the remaining mass
+		if (maxTotalCargoMass != -1)
+		{
+			double remainingMass = maxTotalCargoMass - GetTotalCargoMass();
+			if (remainingMass < 0) break;
+
+			if (maxMass == -1 || remainingMass < maxMass) maxMass = remainingMass;
+		}
+
+		UCSO::CargoRecord record;
+		if (!depot->TakeCargo(cargoName, resource, maxMass, record)) break;
+
+		// If the cargo name isn't kept by the depot, set a new name from the class name without UCSO/
+		if (record.name.empty())
+		{
+			record.name = record.className.substr(5);
+			UCSO::SetSpawnName(record.name);
+		}
+
+		if (virtualCargo)
+		{
+			virtualCargoMap[slot] = record;
+
+			// Add the cargo mass to the vessel, as it's not attached as a vessel
+			vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
+		}
+		// If the cargo couldn't be created, return it to the depot
+		else if (!CreateCargo(slot, record))
+		{
+			depot->StoreCargo(record);
+			break;
+		}
+	}
+
+	return pulledCount;
+}
+
+VesselAPI::ReleaseResult VesselAPI::StoreDepotCargo(int slot)
+{
+	if (IsLoggingOperation()) return LogOperation<ReleaseResult>(MakeOperation(STORE_DEPOT_CARGO_OPERATION, slot), [&] { return StoreDepotCargo(slot); });
+
+	StatisticsScope statisticsScope(this, STORE_DEPOT_CARGO_METHOD);
+	UCSO::TraceScope traceScope("VesselAPI::StoreDepotCargo");
+
+	if (attachsMap.empty()) return RELEASE_SLOT_UNDEFINED;
+
+	if (slot == -1)
+	{
+		// Get the first occupied slot
+		OccupiedResult result = GetOccupiedSlot();
+		// If no slot is occupied
+		if (result.slot == -1) return result.opened ? RELEASE_SLOT_EMPTY : RELEASE_SLOT_CLOSED;
+
+		slot = result.slot;
+	}
+	// If the slot doesn't exists or it's invalid
+	else if (attachsMap.find(slot) == attachsMap.end() || !CheckAttachment(attachsMap[slot].attachHandle)) return RELEASE_SLOT_UNDEFINED;
+	else if (!attachsMap[slot].opened) return RELEASE_SLOT_CLOSED;
+
+	UCSO::Depot* depot = GetNearestDepot();
+	if (!depot) return NO_EMPTY_POSITION;
+
+	auto virtualIt = virtualCargoMap.find(slot);
+
+	// If the cargo is virtual, move its record to the depot
+	if (virtualIt != virtualCargoMap.end())
+	{
+		depot->StoreCargo(virtualIt->second);
+
+		vessel->SetEmptyMass(vessel->GetEmptyMass() - virtualIt->second.mass);
+		virtualCargoMap.erase(virtualIt);
+
+		return RELEASE_SUCCEEDED;
+	}
+
+	OBJHANDLE cargoHandle = VerifySlot(slot);
+	// If no cargo is attached to the slot
+	if (!cargoHandle) return RELEASE_SLOT_EMPTY;
+
+	// Custom cargoes can't be kept as records
+	if (GetCustomCargo(cargoHandle)) return RELEASE_FAILED;
+
+	UCSO::CargoRecord record = GetCargoRecord(oapiGetVesselInterface(cargoHandle));
+
+	// Delete the cargo vessel, and move the camera to the vessel if the cargo has the focus
+	if (!DeleteCargoVessel(cargoHandle, vessel->GetHandle())) return RELEASE_FAILED;
+
+	depot->StoreCargo(record);
+
+	return RELEASE_SUCCEEDED;
+}
+
+UCSO::CargoRecord VesselAPI::GetCargoRecord(VESSEL* cargo)
+{
+	UCSO::CargoRecord record;
+
+	record.name = cargo->GetName();
+	record.className = cargo->GetClassNameA();
+	record.mass = cargo->GetMass();
+	record.dataStruct = static_cast<UCSO::Cargo*>(cargo)->GetDataStruct();
+
+	return record;
+}
+
+OBJHANDLE VesselAPI::CreateCargo(int slot, const UCSO::CargoRecord& record)
+{
+	std::string spawnName = record.name;
+
+	// If the cargo name is used by another vessel, set a new spawn name from the class name without UCSO/
+	if (oapiGetVesselByName(&spawnName[0]))
+	{
+		spawnName = record.className.substr(5);
+		UCSO::SetSpawnName(spawnName);
+	}
+
+	VESSELSTATUS2 status;
+	memset(&status, 0, sizeof(status));
+	status.version = 2;
+	vessel->GetStatusEx(&status);
+
+	OBJHANDLE cargoHandle = CreateVessel(spawnName.c_str(), record.className.c_str(), &status);
+
+	if (!cargoHandle) return nullptr;
+
+	UCSO::Cargo* cargo = static_cast<UCSO::Cargo*>(oapiGetVesselInterface(cargoHandle));
+
+	// Restore the cargo state
+	if (record.dataStruct.unpacked) cargo->UnpackCargo(true);
+
+	if (!record.dataStruct.resource.empty()) cargo->SetFuelMass(record.dataStruct.netMass);
+
+	if (!vessel->AttachChild(cargoHandle, attachsMap[slot].attachHandle, cargo->GetAttachmentHandle(true, 0)))
+	{
+		DeleteVessel(cargoHandle);
+		return nullptr;
+	}
+
+	return cargoHandle;
+}
+
+bool VesselAPI::StoreVirtualCargo(int slot, VESSEL* cargo)
+{
+	UCSO::CargoRecord record = GetCargoRecord(cargo);
+
+	// Delete the cargo vessel, and move the camera to the vessel if the cargo has the focus
+	if (!DeleteCargoVessel(cargo->GetHandle(), vessel->GetHandle())) return false;
+
+	virtualCargoMap[slot] = record;
+
+	// Add the cargo mass to the vessel, as it's not attached as a vessel
+	vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
+
+	return true;
+}
+
+OBJHANDLE VesselAPI::CreateVirtualCargo(int slot)
+{
+	OBJHANDLE cargoHandle = CreateCargo(slot, virtualCargoMap[slot]);
+
+	if (!cargoHandle) return nullptr;
+
+	// Remove the cargo mass from the vessel, as it's attached now
+	vessel->SetEmptyMass(vessel->GetEmptyMass() - virtualCargoMap[slot].mass);
+	virtualCargoMap.erase(slot);
+
+	return cargoHandle;
+}
+
+double VesselAPI::DrainVirtualCargo(UCSO::CargoRecord& record, double mass)
+{
+	UCSO::DataStruct& dataStruct = record.dataStruct;
+
+	// If the cargo isn't a resource, or it's empty
+	if (dataStruct.resource.empty() || dataStruct.netMass == 0) return 0;
+
+	if (!drainUnpackedResources && (dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) && !dataStruct.unpacked)
+		return 0;
+
+	double drainedMass;
+	// If the cargo net mass is lower than or equal to the required mass
+	if (dataStruct.netMass - mass >= 0) drainedMass = mass;
+	// If the required mass is higher than the available mass, use the full mass
+	else drainedMass = dataStruct.netMass;
+
+	dataStruct.netMass -= drainedMass;
+	record.mass -= drainedMass;
+
+	vessel->SetEmptyMass(vessel->GetEmptyMass() - drainedMass);
+
+	return drainedMass;
+}
+
+bool VesselAPI::HasAttachmentId(VESSEL* oVessel, const char* id)
+{
+	// Search through the vessel attachments for the passed ID
+	for (DWORD attachIndex = 0; attachIndex < oVessel->AttachmentCount(true); attachIndex++)
+		if (strcmp(oVessel->GetAttachmentId(oVessel->GetAttachmentHandle(true, attachIndex)), id) == 0) return true;
+
+	return false;
+}
+
+UCSO::Depot* VesselAPI::GetNearestDepot()
+{
+	std::pair<double, UCSO::Depot*> pair = { grappleRange, nullptr };
+
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* depot = GetVesselByIndex(vesselIndex);
+
+		VECTOR3 pos;
+		vessel->GetRelativePos(depot->GetHandle(), pos);
+
+		double distance = length(pos) - depot->GetSize();
+
+		if (distance > pair.first) continue;
+
+		if (activeStats) activeStats->candidatesConsidered++;
+
+		if (HasAttachmentId(depot, "UCSO_DP")) pair = { distance, static_cast<UCSO::Depot*>(depot) };
+	}
+
+	return pair.second;
+}
+
+bool VesselAPI::CanPalletize(const UCSO::DataStruct& dataStruct)
+{
+	if (dataStruct.type != PACKABLE_UNPACKABLE && dataStruct.type != UNPACKABLE_ONLY) return true;
+
+	// If the cargo is unpacked, or it will be unpacked automatically after release
+	return !dataStruct.unpacked && !(dataStruct.unpackingType == ORBITER_VESSEL && dataStruct.unpackingMode != MANUAL);
+}
+
+VECTOR3 VesselAPI::GetPalletCargoPos(UCSO::Pallet* pallet, VECTOR3 pos)
+{
+	// Convert the position from the pallet frame to the vessel frame
+	pallet->Local2Global(pos, pos);
+	vessel->Global2Local(pos, pos);
+
+	return pos;
+}
+
+VesselAPI::PalletResult VesselAPI::GetNearestPalletCargo(VECTOR3 pos, double range, GrappleResult* result)
+{
+	PalletResult palletResult = { nullptr, -1, range };
+
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* pallet = GetVesselByIndex(vesselIndex);
+
+		if (!HasAttachmentId(pallet, "UCSO_PL")) continue;
+
+		VECTOR3 palletPos;
+		vessel->GetRelativePos(pallet->GetHandle(), palletPos);
+
+		// If the whole pallet is out of range
+		if (length(palletPos) - pallet->GetSize() > range + vessel->GetSize()) continue;
+
+		UCSO::Pallet* palletVessel = static_cast<UCSO::Pallet*>(pallet);
+
+		UCSO::CargoRecord record;
+		VECTOR3 itemPos;
+
+		for (int index = 0; palletVessel->GetItem(index, record, itemPos); index++)
+		{
+			VECTOR3 subtract = pos - GetPalletCargoPos(palletVessel, itemPos);
+
+			// The elevation doesn't matter, and the cargo radius is 0.65 meter
+			double cargoRange = sqrt(subtract.x * subtract.x + subtract.z * subtract.z) - 0.65;
+
+			if (cargoRange > palletResult.range) continue;
+
+			if (activeStats) activeStats->candidatesConsidered++;
+
+			if (result)
+			{
+				// If the maximum cargo mass is set and the cargo mass is higher than it
+				if (maxCargoMass != -1) if (record.mass > maxCargoMass) { *result = MAX_MASS_EXCEEDED; continue; }
+
+				// If the maximum total cargo mass is set and the cargo mass plus the total mass is higher than it
+				if (maxTotalCargoMass != -1)
+					if (GetTotalCargoMass() + record.mass > maxTotalCargoMass) { *result = MAX_TOTAL_MASS_EXCEEDED; continue; }
+			}
+
+			palletResult = { palletVessel, index, cargoRange };
+		}
+	}
+
+	return palletResult;
+}
+
+UCSO::Pallet* VesselAPI::CreatePallet(VECTOR3 pos)
+{
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* cargo = GetVesselByIndex(vesselIndex);
+
+		if (!cargo->GroundContact() || strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0 || GetCustomCargo(cargo->GetHandle())) continue;
+
+		// If the cargo is attached to another vessel
+		if (cargo->GetAttachmentStatus(cargo->GetAttachmentHandle(true, 0))) continue;
+
+		VECTOR3 cargoPos;
+		cargo->GetGlobalPos(cargoPos);
+		vessel->Global2Local(cargoPos, cargoPos);
+
+		VECTOR3 subtract = pos - cargoPos;
+
+		// If the cargo isn't in an adjacent position, which is 1.5 meter away on the ground grid or diagonally
+		if (sqrt(subtract.x * subtract.x + subtract.z * subtract.z) > 2.2) continue;
+
+		UCSO::CargoRecord record = GetCargoRecord(cargo);
+		if (!CanPalletize(record.dataStruct)) continue;
+
+		// Create the pallet in the cargo place
+		VESSELSTATUS2 status;
+		memset(&status, 0, sizeof(status));
+		status.version = 2;
+		cargo->GetStatusEx(&status);
+
+		std::string spawnName = "Pallet";
+		UCSO::SetSpawnName(spawnName);
+
+		OBJHANDLE palletHandle = CreateVessel(spawnName.c_str(), "CargoPallet", &status);
+
+		if (!palletHandle) return nullptr;
+
+		if (!DeleteCargoVessel(cargo->GetHandle(), vessel->GetHandle()))
+		{
+			DeleteVessel(palletHandle);
+			return nullptr;
+		}
+
+		UCSO::Pallet* pallet = static_cast<UCSO::Pallet*>(oapiGetVesselInterface(palletHandle));
+
+		pallet->AddItem(record, { 0, 0, 0 });
+
+		return pallet;
+	}
+
+	return nullptr;
+}
+
+bool VesselAPI::GrapplePalletCargo(int slot, const PalletResult& palletResult)
+{
+	UCSO::CargoRecord record;
+	VECTOR3 pos;
+
+	if (!palletResult.pallet->GetItem(palletResult.index, record, pos)) return false;
+
+	if (virtualCargo)
+	{
+		virtualCargoMap[slot] = record;
+
+		// Add the cargo mass to the vessel, as it's not attached as a vessel
+		vessel->SetEmptyMass(vessel->GetEmptyMass() + record.mass);
+	}
+	// If the cargo couldn't be created
+	else if (!CreateCargo(slot, record)) return false;
+
+	palletResult.pallet->RemoveItem(palletResult.index);
+
+	// Delete the pallet if it's empty
+	if (palletResult.pallet->GetItemCount() == 0) DeleteVessel(palletResult.pallet->GetHandle());
+
+	return true;
+}
+
+bool VesselAPI::ReleasePalletCargo(int slot, OBJHANDLE cargoHandle, VECTOR3 pos)
+{
+	UCSO::CargoRecord record;
+
+	if (cargoHandle)
+	{
+		if (GetCustomCargo(cargoHandle)) return false;
+
+		record = GetCargoRecord(oapiGetVesselInterface(cargoHandle));
+	}
+	else record = virtualCargoMap[slot];
+
+	if (!CanPalletize(record.dataStruct)) return false;
+
+	// Get the pallet which has a cargo in an adjacent position, or create a pallet from an adjacent cargo
+	UCSO::Pallet* pallet = GetNearestPalletCargo(pos, 2.2 - 0.65).pallet;
+
+	if (!pallet) pallet = CreatePallet(pos);
+
+	if (!pallet) return false;
+
+	if (cargoHandle)
+	{
+		// Delete the cargo vessel, and move the camera to the vessel if the cargo has the focus
+		if (!DeleteCargoVessel(cargoHandle, vessel->GetHandle())) return false;
+	}
+	else
+	{
+		vessel->SetEmptyMass(vessel->GetEmptyMass() - record.mass);
+		virtualCargoMap.erase(slot);
+	}
+
+	// Convert the position from the vessel frame to the pallet frame
+	vessel->Local2Global(pos, pos);
+	pallet->Global2Local(pos, pos);
+
+	pallet->AddItem(record, pos);
+
+	return true;
+}
+
+VesselAPI::OperationRecord VesselAPI::MakeOperation(Operation operation, int arg0, int arg1, double value, const char* text0, const char* text1)
+{
+	OperationRecord record;
+
+	record.operation = operation;
+	record.args[0] = arg0;
+	record.args[1] = arg1;
+	record.value = value;
+
+	if (text0) record.texts[0] = text0;
+	if (text1) record.texts[1] = text1;
+
+	return record;
+}
+
+void VesselAPI::LogSetting(Operation operation, int arg, double value)
+{
+	if (!IsLoggingOperation()) return;
+
+	OperationRecord record = MakeOperation(operation, arg, 0, value);
+
+	record.simTime = oapiGetSimTime();
+	record.stateHash = GetStateHash();
+
+	WriteOperation(record);
+}
+
+uint64_t VesselAPI::GetStateHash()
+{
+	// FNV-1a hash of the slots, their doors, and the names of their cargoes
+	uint64_t hash = 14695981039346656037ULL;
+
+	auto addBytes = [&hash](const void* data, size_t size)
+	{
+		for (size_t index = 0; index < size; index++) { hash ^= static_cast<const unsigned char*>(data)[index]; hash *= 1099511628211ULL; }
+	};
+
+	for (auto const& [slot, data] : attachsMap)
+	{
+		addBytes(&slot, sizeof(slot));
+		addBytes(&data.opened, sizeof(data.opened));
+
+		std::string name;
+
+		auto virtualIt = virtualCargoMap.find(slot);
+
+		if (virtualIt != virtualCargoMap.end()) name = virtualIt->second.name;
+		else if (CheckAttachment(data.attachHandle))
+		{
+			OBJHANDLE cargoHandle = VerifySlot(slot);
+
+			if (cargoHandle) name = oapiGetVesselInterface(cargoHandle)->GetName();
+		}
+
+		addBytes(name.c_str(), name.size() + 1);
+	}
+
+	return hash;
+}
+
+void VesselAPI::WriteOperation(const OperationRecord& record)
+{
+	uint8_t operation = static_cast<uint8_t>(record.operation);
+	fwrite(&operation, sizeof(operation), 1, operationLog);
+
+	fwrite(&record.simTime, sizeof(record.simTime), 1, operationLog);
+	fwrite(record.args, sizeof(record.args), 1, operationLog);
+	fwrite(&record.value, sizeof(record.value), 1, operationLog);
+
+	for (const std::string& text : record.texts)
+	{
+		uint16_t length = static_cast<uint16_t>(text.size());
+
+		fwrite(&length, sizeof(length), 1, operationLog);
+		fwrite(text.c_str(), 1, length, operationLog);
+	}
+
+	fwrite(&record.stateHash, sizeof(record.stateHash), 1, operationLog);
+	fwrite(&record.result, sizeof(record.result), 1, operationLog);
+}
+
+bool VesselAPI::ReadOperation(FILE* file, OperationRecord& record)
+{
+	uint8_t operation;
+
+	if (fread(&operation, sizeof(operation), 1, file) != 1 || operation >= OPERATION_COUNT) return false;
+
+	record.operation = operation;
+
+	if (fread(&record.simTime, sizeof(record.simTime), 1, file) != 1) return false;
+	if (fread(record.args, sizeof(record.args), 1, file) != 1) return false;
+	if (fread(&record.value, sizeof(record.value), 1, file) != 1) return false;
+
+	for (std::string& text : record.texts)
+	{
+		uint16_t length;
+
+		if (fread(&length, sizeof(length), 1, file) != 1) return false;
+
+		text.resize(length);
+
+		if (length && fread(&text[0], 1, length, file) != length) return false;
+	}
+
+	if (fread(&record.stateHash, sizeof(record.stateHash), 1, file) != 1) return false;
+
+	return fread(&record.result, sizeof(record.result), 1, file) == 1;
+}
+
+double VesselAPI::ReplayOperation(const OperationRecord& record)
+{
+	const int* args = record.args;
+	double value = record.value;
+
+	// Empty texts are passed as nullptr, as the API methods treat them the same
+	const char* text0 = record.texts[0].empty() ? nullptr : record.texts[0].c_str();
+	const char* text1 = record.texts[1].empty() ? nullptr : record.texts[1].c_str();
+
+	switch (record.operation)
+	{
+	case ADD_CARGO_OPERATION:
+	{
+		// The older logs have only the cargo index
+		int index = text0 ? GetAvailableCargoIndex(text0) : args[0];
+
+		if (text0 && index == -1) oapiWriteLogV("UCSO API Warning: The cargo %s of the replayed operation isn't available", text0);
+
+		return AddCargo(index, args[1]);
+	}
+	case GRAPPLE_CARGO_OPERATION:
+		return GrappleCargo(args[0]);
+	case RELEASE_CARGO_OPERATION:
+		return ReleaseCargo(args[0]);
+	case PACK_CARGO_OPERATION:
+		return PackCargo();
+	case UNPACK_CARGO_OPERATION:
+		return UnpackCargo();
+	case DELETE_CARGO_OPERATION:
+		return DeleteCargo(args[0]);
+	case TRANSFER_CARGO_OPERATION:
+	{
+		OBJHANDLE hTarget = text0 ? oapiGetVesselByName(const_cast<char*>(text0)) : nullptr;
+		UCSO::Vessel* targetVessel = hTarget ? sharedRuntime->GetRegisteredVessel(hTarget) : nullptr;
+
+		if (text0 && !targetVessel) oapiWriteLogV("UCSO API Warning: The target vessel %s of the replayed transfer has no UCSO instance", text0);
+
+		return TransferCargo(targetVessel, args[0], args[1]);
+	}
+	case ACCEPT_TRANSFERRED_CARGO_OPERATION:
+	{
+		OBJHANDLE cargoHandle = text0 ? oapiGetVesselByName(const_cast<char*>(text0)) : nullptr;
+
+		if (!cargoHandle) oapiWriteLogV("UCSO API Warning: The cargo %s of the replayed transfer isn't found", text0 ? text0 : "");
+
+		return AcceptTransferredCargo(cargoHandle, args[0]);
+	}
+	case DRAIN_CARGO_RESOURCE_OPERATION:
+		return DrainCargoResource(text0, value, args[0]);
+	case DRAIN_STATION_OR_UNPACKED_RESOURCE_OPERATION:
+		return DrainStationOrUnpackedResource(text0, value);
+	case PULL_DEPOT_CARGO_OPERATION:
+		return PullDepotCargo(args[0], text0, text1);
+	case STORE_DEPOT_CARGO_OPERATION:
+		return StoreDepotCargo(args[0]);
+	case SET_SLOT_DOOR_OPERATION:
+		SetSlotDoor(value != 0, args[0]);
+		break;
+	case SET_MAX_CARGO_MASS_OPERATION:
+		SetMaxCargoMass(value);
+		break;
+	case SET_MAX_TOTAL_CARGO_MASS_OPERATION:
+		SetMaxTotalCargoMass(value);
+		break;
+	case SET_EVA_MODE_OPERATION:
+		SetEVAMode(value != 0);
+		break;
+	case SET_GRAPPLE_RANGE_OPERATION:
+		SetGrappleRange(value);
+		break;
+	case SET_RELEASE_VELOCITY_OPERATION:
+		SetReleaseVelocity(value);
+		break;
+	case SET_CARGO_ROW_LENGTH_OPERATION:
+		SetCargoRowLength(static_cast<int>(value));
+		break;
+	case SET_UNPACKING_RANGE_OPERATION:
+		SetUnpackingRange(value);
+		break;
+	case SET_RESOURCE_RANGE_OPERATION:
+		SetResourceRange(value);
+		break;
+	case SET_BREATHABLE_RANGE_OPERATION:
+		SetBreathableRange(value);
+		break;
+	case SET_VIRTUAL_CARGO_OPERATION:
+		SetVirtualCargo(value != 0);
+		break;
+	case SET_CARGO_PALLETS_OPERATION:
+		SetCargoPallets(value != 0);
+		break;
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+VesselAPI::StatisticsScope::StatisticsScope(VesselAPI* api, StatisticsMethod method) : api(api), method(method)
+{
+	bool timing = api->runtime && api->runtime->timing;
+
+	// If the statistics and the runtime timing are disabled, don't measure anything
+	if (!api->statisticsEnabled && !timing) 
+	{
+		this->api = nullptr;
+		return;
+	}
+
+	counting = api->statisticsEnabled;
+
+	if (!counting)
+	{
+		startTime = std::chrono::steady_clock::now();
+		return;
+	}
+
+	// Keep the calling method statistics, as the API methods can call each other
+	previousStats = api->activeStats;
+	api->activeStats = &api->statistics[method];
+	api->activeStats->callCount++;
+
+	// Count the allocations of this method only, as the scope is replaced by the called API methods
+	previousAllocations = UCSO::GetAllocationCounter();
+	UCSO::GetAllocationCounter() = &allocations;
+
+	startTime = std::chrono::steady_clock::now();
+}
+
+VesselAPI::StatisticsScope::~StatisticsScope()
+{
+	if (!api) return;
+
+	double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	// If this is the slowest call in the current runtime window, copy its name, as this DLL can be unloaded
+	if (api->runtime && api->runtime->timing && time * 1e6 > api->runtime->windowSlowestCallTime)
+	{
+		static const char* methodNames[METHOD_COUNT] = { "AddCargo", "GrappleCargo", "ReleaseCargo", "PackCargo", "UnpackCargo", "DeleteCargo",
+			"TransferCargo", "DrainCargoResource", "DrainStationOrUnpackedResource", "GetNearestBreathableCargo", "PullDepotCargo", "StoreDepotCargo",
+			"LoadManifest", "AcceptTransferredCargo" };
+
+		strncpy(api->runtime->windowSlowestCall, methodNames[method], sizeof(api->runtime->windowSlowestCall) - 1);
+		api->runtime->windowSlowestCallTime = time * 1e6;
+	}
+
+	if (!counting) return;
+
+	api->activeStats->totalTime += time;
+	if (time > api->activeStats->maxTime) api->activeStats->maxTime = time;
+
+	UCSO::GetAllocationCounter() = previousAllocations;
+
+	api->activeStats->allocationCount += allocations.count;
+	api->activeStats->allocatedBytes += allocations.bytes;
+
+	api->activeStats = previousStats;
 }
\ No newline at end of file
@@ -23,13 +23,16 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <chrono>
+#include <cstdint>
 
 #include "Vessel.h"
 #include "CustomCargo.h"
+#include "SharedRuntime.h"
 #include "..\Cargo\Cargo.h"
+#include "..\Depot\Depot.h"
+#include "..\Pallet\Pallet.h"
 
-typedef const char* (*GetVersionFunction)();
-typedef UCSO::CustomCargo* (*CustomCargoFunction)(OBJHANDLE);
 
 class VesselAPI : public UCSO::Vessel
 {
@@ -62,10 +65,16 @@ public:
 
 	void SetBreathableRange(double breathableRange) override;
 
+	void SetVirtualCargo(bool virtualCargo) override;
+
+	void SetCargoPallets(bool cargoPallets) override;
+
 	int GetAvailableCargoCount() override;
 
 	const char* GetAvailableCargoName(int index) override;
 
+	int GetAvailableCargoGeneration() override;
+
 	CargoInfo GetCargoInfo(int slot) override;
 
 	double GetCargoMass(int slot) override;
@@ -74,6 +83,10 @@ public:
 
 	GrappleResult AddCargo(int index, int slot = -1) override;
 
+	int LoadManifest(const ManifestEntry* entries, int count, GrappleResult* results) override;
+
+	int LoadManifestFile(const char* fileName, GrappleResult* results = nullptr, int resultCount = 0) override;
+
 	GrappleResult GrappleCargo(int slot = -1) override;
 
 	ReleaseResult ReleaseCargo(int slot = -1) override;
@@ -84,6 +97,9 @@ public:
 
 	ReleaseResult DeleteCargo(int slot = -1) override;
 
+	TransferResult TransferCargo(UCSO::Vessel* targetVessel, int fromSlot = -1, int toSlot = -1) override;
+	TransferResult AcceptTransferredCargo(OBJHANDLE cargoHandle, int slot = -1) override;
+
 	double DrainCargoResource(const char* resource, double mass, int slot = -1) override;
 
 	double DrainStationOrUnpackedResource(const char* resource, double mass) override;
@@ -92,14 +108,39 @@ public:
 
 	VESSEL* GetNearestBreathableCargo() override;
 
+	void SaveVirtualCargo(FILEHANDLE scn) override;
+
+	bool LoadVirtualCargo(const char* line) override;
+
+	void SetInventorySnapshot(bool inventorySnapshot) override;
+
+	int GetDepotCargoCount(const char* cargoName = nullptr, const char* resource = nullptr) override;
+
+	int PullDepotCargo(int count, const char* cargoName = nullptr, const char* resource = nullptr) override;
+
+	ReleaseResult StoreDepotCargo(int slot = -1) override;
+
+	void SetStatistics(bool enabled) override;
+
+	MethodStatistics GetStatistics(StatisticsMethod method) override;
+
+	bool FlushTrace() override;
+
+	bool SetOperationLog(const char* fileName) override;
+
+	bool StartReplay(const char* fileName) override;
+
+	int UpdateReplay() override;
+
 	const char* SetSpawnName(const char* spawnName) override;
 
 	void SetGroundRotation(VESSELSTATUS2& status, double spawnHeight) override;
 
 private:
 	VESSEL* vessel;
+	UCSO::SharedRuntime* sharedRuntime; // The custom cargo DLL and the available cargoes, which are loaded once for the process
 	const char* version = nullptr;
-	HINSTANCE customCargoDll = nullptr;
+	UCSO::RuntimeStatistics* runtime = nullptr;
 	CustomCargoFunction GetCustomCargo = nullptr;
 
 	struct SlotData 
@@ -109,7 +150,11 @@ private:
 	};
 
 	std::map<int, SlotData> attachsMap;
-	std::vector<std::string> availableCargoList;
+
+	// The cargo records which are stored in the slots instead of the cargo vessels in the virtual cargo mode
+	std::map<int, UCSO::CargoRecord> virtualCargoMap;
+	std::shared_ptr<const UCSO::CargoCatalog::Snapshot> availableCargo; // The catalog snapshot used by this vessel until it gets the count again
+	double catalogUpdateTime = -1; // The simulation time of the last catalog update, so the cargo folder is polled once per frame
 
 	struct EmptyResult
 	{
@@ -128,6 +173,14 @@ private:
 	{
 		bool normalCargo;
 		void* cargo;
+		UCSO::CargoRecord* virtualCargo = nullptr;
+	};
+
+	struct PalletResult
+	{
+		UCSO::Pallet* pallet;
+		int index;
+		double range;
 	};
 
 	double maxCargoMass = -1;
@@ -140,15 +193,158 @@ private:
 	double unpackingRange = 5;
 	double resourceRange = 100;
 	double breathableRange = 1000;
+	bool virtualCargo = false;
+	bool inventorySnapshot = false;
+	bool drainUnpackedResources = false; // The cargo DLL setting, as the virtual cargoes are drained here
+	bool cargoPallets = false;
+
+	bool statisticsEnabled = false;
+	MethodStatistics statistics[METHOD_COUNT] = { };
+	MethodStatistics* activeStats = nullptr; // The statistics of the method being measured, or nullptr if the statistics are disabled
+
+	// Measures an API method call from its construction to its destruction, if the statistics are enabled
+	class StatisticsScope
+	{
+	public:
+		StatisticsScope(VesselAPI* api, StatisticsMethod method);
+		~StatisticsScope();
+
+	private:
+		VesselAPI* api;
+		StatisticsMethod method;
+		bool counting = false; // If the method statistics are enabled, not only the runtime timing
+		MethodStatistics* previousStats = nullptr;
+		std::chrono::steady_clock::time_point startTime;
+		UCSO::AllocationCounter allocations;
+		UCSO::AllocationCounter* previousAllocations = nullptr;
+	};
+
+	// The API calls in the operation log
+	enum Operation
+	{
+		ADD_CARGO_OPERATION = 0,
+		GRAPPLE_CARGO_OPERATION,
+		RELEASE_CARGO_OPERATION,
+		PACK_CARGO_OPERATION,
+		UNPACK_CARGO_OPERATION,
+		DELETE_CARGO_OPERATION,
+		TRANSFER_CARGO_OPERATION,
+		DRAIN_CARGO_RESOURCE_OPERATION,
+		DRAIN_STATION_OR_UNPACKED_RESOURCE_OPERATION,
+		PULL_DEPOT_CARGO_OPERATION,
+		STORE_DEPOT_CARGO_OPERATION,
+		SET_SLOT_DOOR_OPERATION,
+		SET_MAX_CARGO_MASS_OPERATION,
+		SET_MAX_TOTAL_CARGO_MASS_OPERATION,
+		SET_EVA_MODE_OPERATION,
+		SET_GRAPPLE_RANGE_OPERATION,
+		SET_RELEASE_VELOCITY_OPERATION,
+		SET_CARGO_ROW_LENGTH_OPERATION,
+		SET_UNPACKING_RANGE_OPERATION,
+		SET_RESOURCE_RANGE_OPERATION,
+		SET_BREATHABLE_RANGE_OPERATION,
+		SET_VIRTUAL_CARGO_OPERATION,
+		SET_CARGO_PALLETS_OPERATION,
+		ACCEPT_TRANSFERRED_CARGO_OPERATION,
+		OPERATION_COUNT
+	};
+
+	struct OperationRecord
+	{
+		int operation;
+		double simTime = 0;
+		int args[2] = { };
+		double value = 0;
+		std::string texts[2];
+		uint64_t stateHash = 0; // The slots state before the call
+		double result = 0;
+	};
+
+	FILE* operationLog = nullptr;
+	bool loggingOperation = false; // True while a call is logged, so the API methods called by it aren't logged
+	std::vector<OperationRecord> replayList;
+	size_t replayIndex = 0;
+	int replayMismatches = 0;
+	bool replayingOperation = false; // True while a call is replayed, so the calls made by another vessel's replay can be told apart
+
+	// The results of the transfers which another vessel's replay made to this vessel, for the logged AcceptTransferredCargo calls
+	std::vector<std::pair<std::string, TransferResult>> acceptedReplayList;
+
+	// Runs and logs the API call, if the operation log is open and no other call is being logged
+	template<typename Result, typename Call>
+	Result LogOperation(OperationRecord record, Call call)
+	{
+		loggingOperation = true;
 
-	void InitAvailableCargo();
+		record.simTime = oapiGetSimTime();
+		record.stateHash = GetStateHash();
 
-	std::vector<VECTOR3> GetGroundList(VECTOR3 initialPos);
+		Result result = call();
+		record.result = static_cast<double>(result);
+
+		WriteOperation(record);
+
+		loggingOperation = false;
+
+		return result;
+	}
+
+	bool IsLoggingOperation() { return operationLog && !loggingOperation; }
+	OperationRecord MakeOperation(Operation operation, int arg0 = 0, int arg1 = 0, double value = 0, const char* text0 = nullptr, const char* text1 = nullptr);
+	void LogSetting(Operation operation, int arg, double value);
+	uint64_t GetStateHash();
+	void WriteOperation(const OperationRecord& record);
+	static bool ReadOperation(FILE* file, OperationRecord& record);
+	double ReplayOperation(const OperationRecord& record);
+
+	// How a logged AcceptTransferredCargo call is replayed
+	enum AcceptReplay
+	{
+		ACCEPT_REPLAY_CALL,    // The cargo isn't attached to another vessel, so the call is replayed
+		ACCEPT_REPLAY_DONE,    // Another vessel's replay has made the call, or it can't be replayed
+		ACCEPT_REPLAY_WAITING  // The cargo is still attached to another vessel, whose replay can transfer it
+	};
+
+	AcceptReplay GetAcceptReplay(const OperationRecord& record, double simTime);
+
+	UCSO::CountedVector<VECTOR3> GetGroundList(VECTOR3 initialPos);
 	bool GetNearestEmptyLocation(VECTOR3& initialPos);
 
+	CargoInfo GetCustomCargoInfo(CargoInfo& cargoInfo, UCSO::CustomCargo* customCargo);
+
+	VESSEL* GetVesselByIndex(DWORD vesselIndex);
+	OBJHANDLE CreateVessel(const char* name, const char* className, VESSELSTATUS2* status);
+	bool DeleteVessel(OBJHANDLE handle, OBJHANDLE focusHandle = nullptr);
+	// Deletes an attached UCSO or custom cargo. A UCSO cargo is told first, so it can pass its paged cargoes on
+	bool DeleteCargoVessel(OBJHANDLE cargoHandle, OBJHANDLE focusHandle = nullptr);
+
 	bool CheckAttachment(ATTACHMENTHANDLE attachHandle);
 	OBJHANDLE VerifySlot(int slot);
 	EmptyResult GetEmptySlot();
 	OccupiedResult GetOccupiedSlot();
 	ResourceResult GetResourceCargo(std::string resource);
+
+	UCSO::CargoRecord GetCargoRecord(VESSEL* cargo);
+	OBJHANDLE CreateCargo(int slot, const UCSO::CargoRecord& record);
+	GrappleResult AttachAddedCargo(OBJHANDLE cargoHandle, int slot);
+	double GetPackedCargoMass(const std::string& cargoName);
+	int GetAvailableCargoIndex(const char* cargoName);
+	bool StoreVirtualCargo(int slot, VESSEL* cargo);
+	OBJHANDLE CreateVirtualCargo(int slot);
+	double DrainVirtualCargo(UCSO::CargoRecord& record, double mass);
+
+	// Writes the virtual cargoes to a snapshot file. Returns the file name, or an empty string if the file couldn't be written
+	std::string WriteInventorySnapshot();
+	void RemoveOldInventorySnapshots(const std::string& filePrefix);
+	bool ReadInventorySnapshot(const std::string& fileName);
+
+	bool HasAttachmentId(VESSEL* oVessel, const char* id);
+	UCSO::Depot* GetNearestDepot();
+
+	bool CanPalletize(const UCSO::DataStruct& dataStruct);
+	VECTOR3 GetPalletCargoPos(UCSO::Pallet* pallet, VECTOR3 pos);
+	PalletResult GetNearestPalletCargo(VECTOR3 pos, double range, GrappleResult* result = nullptr);
+	UCSO::Pallet* CreatePallet(VECTOR3 pos);
+	bool GrapplePalletCargo(int slot, const PalletResult& palletResult);
+	bool ReleasePalletCargo(int slot, OBJHANDLE cargoHandle, VECTOR3 pos);
 };
\ No newline at end of file
@@ -20,13 +20,84 @@
 // =======================================================================================
 
 #include "Cargo.h"
-#include <sstream>
+#include <algorithm>
 
 DLLCLBK VESSEL* ovcInit(OBJHANDLE hvessel, int flightmodel) { return new UCSO::Cargo(hvessel, flightmodel); }
 
 DLLCLBK void ovcExit(VESSEL* vessel) { if (vessel) delete static_cast<UCSO::Cargo*>(vessel); }
 
-UCSO::Cargo::Cargo(OBJHANDLE hObj, int fmodel) : VESSEL4(hObj, fmodel) { if(!configLoaded) LoadConfig(); }
+DLLCLBK void ExitModule(HINSTANCE hModule)
+{
+	UCSO::Cargo::FinishWarmUp();
+	UCSO::Cargo::ClearPaging();
+}
+
+DLLCLBK UCSO::TraceFunction GetUCSOTraceFunction() { return UCSO::Cargo::GetTraceFunction(); }
+
+DLLCLBK bool FlushUCSOTrace() { return UCSO::Cargo::FlushTrace(); }
+
+DLLCLBK UCSO::RuntimeStatistics* GetUCSORuntimeStatistics() { return &UCSO::Cargo::runtime; }
+
+DLLCLBK bool GetUCSODrainUnpackedResources() { return UCSO::Cargo::GetDrainUnpackedResources(); }
+
+DLLCLBK double GetUCSOContainerMass() { return UCSO::Cargo::GetContainerMass(); }
+
+std::map<std::string, UCSO::Cargo::CargoClass*> UCSO::Cargo::classMap;
+bool UCSO::Cargo::warmUpStarted = false;
+HANDLE UCSO::Cargo::warmUpThread = nullptr;
+std::atomic<bool> UCSO::Cargo::warmUpCancelled{ false };
+std::atomic<UCSO::Cargo::WarmUpResult*> UCSO::Cargo::warmUpResult{ nullptr };
+std::vector<HINSTANCE> UCSO::Cargo::warmUpModules;
+std::vector<UCSO::Cargo*> UCSO::Cargo::cargoList;
+UCSO::CountedVector<UCSO::Cargo::PagedCargo> UCSO::Cargo::pagedList;
+UCSO::CountedVector<VECTOR3> UCSO::Cargo::pagingVesselList;
+UCSO::CountedVector<UCSO::Cargo*> UCSO::Cargo::pagingCargoList;
+UCSO::Cargo* UCSO::Cargo::pagingKeeper = nullptr;
+double UCSO::Cargo::pagingTimer = 0;
+int UCSO::Cargo::pagedInCount = 0;
+int UCSO::Cargo::pagedOutCount = 0;
+UCSO::Cargo::FrameProfile UCSO::Cargo::frameProfile;
+std::vector<UCSO::Cargo::FrameProfile> UCSO::Cargo::profileList;
+std::vector<double> UCSO::Cargo::percentileList;
+std::chrono::steady_clock::time_point UCSO::Cargo::profilerTime = std::chrono::steady_clock::now();
+UCSO::TraceBuffer* UCSO::Cargo::traceBuffer = nullptr;
+UCSO::RuntimeStatistics UCSO::Cargo::runtime;
+int UCSO::Cargo::frameAwakeCount = 0;
+int UCSO::Cargo::frameSettledCount = 0;
+double UCSO::Cargo::frameTime = 0;
+std::chrono::steady_clock::time_point UCSO::Cargo::runtimeWindowTime = std::chrono::steady_clock::now();
+
+UCSO::Cargo::Cargo(OBJHANDLE hObj, int fmodel) : VESSEL4(hObj, fmodel) 
+{ 
+	if(!configLoaded) LoadConfig();
+
+	cargoList.push_back(this);
+
+	if (!pagingKeeper) pagingKeeper = this;
+}
+
+UCSO::Cargo::~Cargo()
+{
+	cargoList.erase(std::find(cargoList.begin(), cargoList.end(), this));
+
+	if (countedType >= 0) runtime.cargoCount[countedType]--;
+
+	ReleaseClass();
+
+	if (pagingKeeper != this) return;
+
+	// Pass the paging to another cargo
+	if (!cargoList.empty()) pagingKeeper = cargoList.front();
+	else
+	{
+		pagingKeeper = nullptr;
+
+		if (cargoPaging) oapiWriteLogV("UCSO: %d cargoes were paged in, and %d cargoes were paged out", pagedInCount, pagedOutCount);
+
+		// Write the trace when the simulation ends
+		if (traceBuffer) FlushTrace();
+	}
+}
 
 void UCSO::Cargo::LoadConfig()
 {
@@ -47,91 +118,398 @@ void UCSO::Cargo::LoadConfig()
 		if (!oapiReadItem_bool(configFile, "DrainUnpackedResources", drainUnpackedResources))
 			oapiWriteLog("UCSO Warning: Couldn't read the unpacked resources drainage setting, will use the default setting");
 
+		if (!oapiReadItem_bool(configFile, "CargoPaging", cargoPaging))
+			oapiWriteLog("UCSO Warning: Couldn't read the cargo paging setting, will use the default setting");
+
+		if (!oapiReadItem_float(configFile, "PagingRange", pagingRange))
+			oapiWriteLog("UCSO Warning: Couldn't read the paging range setting, will use the default range");
+
+		if (!oapiReadItem_float(configFile, "PagingHysteresis", pagingHysteresis))
+			oapiWriteLog("UCSO Warning: Couldn't read the paging hysteresis setting, will use the default hysteresis");
+
+		if (!oapiReadItem_float(configFile, "ProfilerInterval", profilerInterval))
+			oapiWriteLog("UCSO Warning: Couldn't read the profiler interval setting, will use the default interval");
+
+		if (!oapiReadItem_bool(configFile, "Tracing", tracing))
+			oapiWriteLog("UCSO Warning: Couldn't read the tracing setting, will use the default setting");
+
+		if (!oapiReadItem_int(configFile, "TraceBufferSize", traceBufferSize))
+			oapiWriteLog("UCSO Warning: Couldn't read the trace buffer size setting, will use the default size");
+
+		if (!oapiReadItem_bool(configFile, "WarmUp", warmUp))
+			oapiWriteLog("UCSO Warning: Couldn't read the warm-up setting, will use the default setting");
+
 		oapiCloseFile(configFile, FILE_IN_ZEROONFAIL);
 	}
 	else oapiWriteLog("UCSO Warning: Couldn't load the configurations file, will use the default configurations");
+
+	// Trace the cargo methods
+	TraceScope::GetTraceFunction() = GetTraceFunction();
+
+	// The configuration is loaded by the first cargo or the first vessel which uses the vessels' API
+	StartWarmUp();
+}
+
+bool UCSO::Cargo::GetDrainUnpackedResources()
+{
+	if (!configLoaded) LoadConfig();
+
+	return drainUnpackedResources;
+}
+
+double UCSO::Cargo::GetContainerMass()
+{
+	if (!configLoaded) LoadConfig();
+
+	return containerMass;
+}
+
+UCSO::TraceFunction UCSO::Cargo::GetTraceFunction()
+{
+	if (!configLoaded) LoadConfig();
+
+	if (!tracing) return nullptr;
+
+	if (!traceBuffer) traceBuffer = new TraceBuffer(traceBufferSize > 0 ? traceBufferSize : 1);
+
+	return AddTraceEvent;
 }
 
+bool UCSO::Cargo::FlushTrace()
+{
+	if (!traceBuffer) return false;
+
+	if (traceBuffer->Flush("UCSO_Trace.json")) return true;
+
+	oapiWriteLog("UCSO Warning: Couldn't write the trace file");
+
+	return false;
+}
+
+void UCSO::Cargo::AddTraceEvent(const char* name, bool begin) { traceBuffer->AddEvent(name, begin); }
+
 void UCSO::Cargo::clbkSetClassCaps(FILEHANDLE cfg)
+{
+	AcquireClass(cfg);
+
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
+	if (dataStruct.type >= STATIC && dataStruct.type <= UNPACKABLE_ONLY)
+	{
+		countedType = dataStruct.type;
+		runtime.cargoCount[countedType]++;
+	}
+
+	if (!dataStruct.resource.empty()) CreatePropellantResource(dataStruct.netMass);
+
+	if (cargoClass->packedMeshTemplate) packedMeshIndex = AddMesh(cargoClass->packedMeshTemplate);
+
+	// Hide the unpacked mesh, as the cargo is packed by default
+	if (cargoClass->unpackedMeshTemplate)
+	{
+		unpackedMeshIndex = AddMesh(cargoClass->unpackedMeshTemplate);
+		SetMeshVisible(unpackedMeshIndex, false);
+	}
+
+	SetEnableFocus(enableFocus);
+
+	SetPackedCaps(false);
+}
+
+void UCSO::Cargo::AcquireClass(FILEHANDLE cfg)
+{
+	// Add the classes read by the warm-up if it's done
+	TakeWarmUpResult();
+
+	std::string classKey = GetClassKey(GetClassNameA());
+
+	auto classIt = classMap.find(classKey);
+
+	// If the class isn't loaded, read it from the configuration file
+	if (classIt == classMap.end())
+	{
+		cargoClass = new CargoClass;
+
+		std::string configName = GetClassNameA();
+		configName.erase(0, 5);
+
+		// Read the configuration file if it isn't compiled, or it was changed after it was compiled
+		if (!ReadCompiledConfig(configName, *cargoClass))
+		{
+			FileReader reader = { cfg };
+			std::vector<std::string> missingItems;
+
+			if (!ReadCargoConfig(reader, *cargoClass, missingItems)) ThrowWarning(missingItems.front().c_str());
+		}
+
+		SetClassData(*cargoClass);
+
+		LoadClassMeshes(GetClassNameA(), *cargoClass);
+
+		classMap[classKey] = cargoClass;
+	}
+	else cargoClass = classIt->second;
+
+	cargoClass->refCount++;
+}
+
+void UCSO::Cargo::ReleaseClass()
+{
+	if (!cargoClass || --cargoClass->refCount) return;
+
+	classMap.erase(GetClassKey(GetClassNameA()));
+
+	delete cargoClass;
+	cargoClass = nullptr;
+}
+
+void UCSO::Cargo::SetClassData(CargoClass& cargoClass)
+{
+	DataStruct& dataStruct = cargoClass.dataStruct;
+
+	dataStruct.type = cargoClass.type;
+	dataStruct.netMass = cargoClass.netMass;
+	dataStruct.resource = cargoClass.resource;
+	dataStruct.unpackingType = cargoClass.unpackingType;
+	dataStruct.spawnCount = cargoClass.spawnCount;
+	dataStruct.breathable = cargoClass.breathable;
+	dataStruct.unpackedHeight = cargoClass.unpackedHeight;
+	dataStruct.spawnName = cargoClass.spawnName;
+	dataStruct.spawnModule = cargoClass.spawnModule;
+	dataStruct.unpackingMode = cargoClass.unpackingMode;
+	dataStruct.unpackingDelay = cargoClass.unpackingDelay;
+}
+
+void UCSO::Cargo::LoadClassMeshes(const char* className, CargoClass& cargoClass)
+{
+	cargoClass.packedMeshTemplate = oapiLoadMeshGlobal(cargoClass.packedMesh.c_str());
+
+	if (!cargoClass.packedMeshTemplate) oapiWriteLogV("UCSO Warning: Couldn't load the packed mesh of %s cargo", className);
+
+	if (cargoClass.unpackedMesh.empty()) return;
+
+	cargoClass.unpackedMeshTemplate = oapiLoadMeshGlobal(cargoClass.unpackedMesh.c_str());
+
+	if (!cargoClass.unpackedMeshTemplate) oapiWriteLogV("UCSO Warning: Couldn't load the unpacked mesh of %s cargo", className);
+}
+
+std::string UCSO::Cargo::GetClassKey(const char* className)
+{
+	std::string classKey = className;
+
+	for (char& character : classKey) character = character == '\\' ? '/' : char(tolower(character));
+
+	return classKey;
+}
+
+bool UCSO::Cargo::FileReader::ReadString(const char* item, std::string& value)
 {
 	char buffer[512];
 
-	if (!oapiReadItem_string(cfg, "PackedMesh", buffer)) ThrowWarning("mesh");
-	packedMesh = buffer;
+	if (!oapiReadItem_string(cfg, item, buffer)) return false;
 
-	if (!oapiReadItem_float(cfg, "CargoMass", dataStruct.netMass)) ThrowWarning("mass");
+	value = buffer;
 
-	if (!oapiReadItem_int(cfg, "CargoType", dataStruct.type)) ThrowWarning("type");
+	return true;
+}
 
-	switch (dataStruct.type)
+bool UCSO::Cargo::FileReader::ReadVector(const char* item, CargoConfig::Vector& value)
+{
+	VECTOR3 vector;
+
+	if (!oapiReadItem_vec(cfg, item, vector)) return false;
+
+	value = { vector.x, vector.y, vector.z };
+
+	return true;
+}
+
+void UCSO::Cargo::StartWarmUp()
+{
+	if (warmUpStarted || !warmUp) return;
+
+	warmUpStarted = true;
+	warmUpCancelled.store(false);
+
+	// The thread keeps the cargo DLL loaded until it's done, as the DLL could be unloaded meanwhile
+	HINSTANCE cargoDll = LoadLibraryA("Modules/UCSO/Cargo.dll");
+
+	if (!cargoDll) { oapiWriteLog("UCSO Warning: Couldn't start the warm-up"); return; }
+
+	warmUpThread = CreateThread(nullptr, 0, WarmUp, cargoDll, 0, nullptr);
+
+	if (!warmUpThread)
 	{
-	case RESOURCE:
-		if (!oapiReadItem_string(cfg, "CargoResource", buffer)) ThrowWarning("resource");
-		dataStruct.resource = buffer;
+		FreeLibrary(cargoDll);
+		oapiWriteLog("UCSO Warning: Couldn't start the warm-up");
+	}
+}
 
-		CreatePropellantResource(dataStruct.netMass);
+DWORD WINAPI UCSO::Cargo::WarmUp(LPVOID cargoDll)
+{
+	// No Orbiter function is called here, as they aren't thread-safe. The meshes are loaded by the main thread when the result is taken
+	WarmUpResult* result = new WarmUpResult;
 
-		break;
-	case UNPACKABLE_ONLY:
-		oapiReadItem_int(cfg, "SpawnCount", dataStruct.spawnCount);
-	case PACKABLE_UNPACKABLE:
-		if (!oapiReadItem_int(cfg, "UnpackingType", dataStruct.unpackingType)) ThrowWarning("unpacking type");
+	WIN32_FIND_DATAA findData;
+	HANDLE findHandle = FindFirstFileA("Config/Vessels/UCSO/*.cfg", &findData);
 
-		switch (dataStruct.unpackingType)
+	if (findHandle != INVALID_HANDLE_VALUE)
+	{
+		do
 		{
-		case UCSO_RESOURCE:
-			if (!oapiReadItem_string(cfg, "CargoResource", buffer)) ThrowWarning("resource");
-			dataStruct.resource = buffer;
+			// If the simulation is ending, the remaining classes aren't needed
+			if (warmUpCancelled.load()) break;
 
-			oapiReadItem_float(cfg, "ResourceContainerMass", resourceContainerMass);
+			std::string fileName = findData.cFileName;
 
-			CreatePropellantResource(dataStruct.netMass);
-		case UCSO_MODULE:
-			if (!oapiReadItem_string(cfg, "UnpackedMesh", buffer)) ThrowWarning("unpacked mesh");
-			unpackedMesh = buffer;
+			std::string configName = fileName.substr(0, fileName.find(".cfg"));
 
-			if (!oapiReadItem_float(cfg, "UnpackedSize", unpackedSize)) ThrowWarning("unpacked size");
+			TextConfigReader reader;
+			if (!reader.Parse(GetConfigPath(configName))) continue;
 
-			if (oapiReadItem_float(cfg, "UnpackedHeight", dataStruct.unpackedHeight)) dataStruct.unpackedHeight = abs(dataStruct.unpackedHeight);
-			else ThrowWarning("unpacked height");
+			std::string module;
+			if (!reader.ReadString("Module", module)) continue;
 
-			oapiReadItem_vec(cfg, "UnpackedAttachPos", unpackedAttachPos);
+			// Load the custom cargo modules. The UCSO cargoes use this DLL
+			if (!IsCargoModule(module))
+			{
+				WarmUpModule(module, result->moduleList);
+				continue;
+			}
 
-			oapiReadItem_vec(cfg, "UnpackedPMI", unpackedPMI);
+			CargoClass* cargoClass = new CargoClass;
 
-			oapiReadItem_vec(cfg, "UnpackedCS", unpackedCS);
+			std::vector<std::string> missingItems;
 
-			oapiReadItem_bool(cfg, "Breathable", dataStruct.breathable);
+			// If an item is missing, leave the class to Orbiter, so the error is written as usual
+			if (!ReadCompiledConfig(configName, *cargoClass) && !ReadCargoConfig(reader, *cargoClass, missingItems)) { delete cargoClass; continue; }
 
-			break;
-		case ORBITER_VESSEL:
-			if (!oapiReadItem_string(cfg, "SpawnName", buffer)) ThrowWarning("spawn name");
-			dataStruct.spawnName = buffer;
+			SetClassData(*cargoClass);
+			cargoClass->warmedUp = true;
 
-			if (!oapiReadItem_string(cfg, "SpawnModule", buffer)) ThrowWarning("spawn module");
-			dataStruct.spawnModule = buffer;
+			// Read the mesh files, so they are cached when the main thread loads them
+			WarmUpFile("Meshes/" + cargoClass->packedMesh + ".msh");
 
-			if (!oapiReadItem_int(cfg, "UnpackingMode", dataStruct.unpackingMode)) ThrowWarning("unpacking mode");
+			if (!cargoClass->unpackedMesh.empty()) WarmUpFile("Meshes/" + cargoClass->unpackedMesh + ".msh");
 
-			if (dataStruct.unpackingMode == DELAYING)
+			// Load the module of the spawned vessel
+			if (!cargoClass->spawnModule.empty())
 			{
-				if (!oapiReadItem_int(cfg, "UnpackingDelay", dataStruct.unpackingDelay)) ThrowWarning("unpacking delay");
+				TextConfigReader spawnReader;
 
-				if (oapiReadItem_float(cfg, "SpawnHeight", dataStruct.unpackedHeight))  dataStruct.unpackedHeight = abs(dataStruct.unpackedHeight);
-				else ThrowWarning("spawn height");
+				if (spawnReader.Parse("Config/Vessels/" + cargoClass->spawnModule + ".cfg") && spawnReader.ReadString("Module", module))
+					WarmUpModule(module, result->moduleList);
 			}
 
-			break;
-		}
+			result->classList.emplace_back(GetClassKey(("UCSO/" + configName).c_str()), cargoClass);
+		} while (FindNextFileA(findHandle, &findData));
 
-		break;
-	default:
-		break;
+		FindClose(findHandle);
 	}
 
-	SetEnableFocus(enableFocus);
+	warmUpResult.store(result, std::memory_order_release);
 
-	SetPackedCaps(false);
+	FreeLibraryAndExitThread(static_cast<HMODULE>(cargoDll), 0);
+
+	return 0;
+}
+
+void UCSO::Cargo::WarmUpModule(const std::string& module, std::vector<HINSTANCE>& moduleList)
+{
+	HINSTANCE moduleDll = LoadLibraryA(("Modules/" + module + ".dll").c_str());
+
+	if (moduleDll) moduleList.push_back(moduleDll);
+}
+
+void UCSO::Cargo::WarmUpFile(const std::string& fileName)
+{
+	FILE* file = fopen(fileName.c_str(), "rb");
+
+	if (!file) return;
+
+	char buffer[65536];
+
+	while (fread(buffer, 1, sizeof(buffer), file) == sizeof(buffer));
+
+	fclose(file);
+}
+
+void UCSO::Cargo::TakeWarmUpResult()
+{
+	WarmUpResult* result = warmUpResult.exchange(nullptr, std::memory_order_acquire);
+
+	if (!result) return;
+
+	for (auto& classPair : result->classList)
+	{
+		CargoClass* cargoClass = classPair.second;
+
+		// If the class was read meanwhile by a cargo
+		if (classMap.find(classPair.first) != classMap.end()) { delete cargoClass; continue; }
+
+		LoadClassMeshes(classPair.first.c_str(), *cargoClass);
+
+		// Keep the class until the simulation ends
+		cargoClass->refCount = 1;
+
+		classMap[classPair.first] = cargoClass;
+	}
+
+	warmUpModules.insert(warmUpModules.end(), result->moduleList.begin(), result->moduleList.end());
+
+	delete result;
+}
+
+void UCSO::Cargo::DiscardWarmUpResult()
+{
+	WarmUpResult* result = warmUpResult.exchange(nullptr, std::memory_order_acquire);
+
+	if (!result) return;
+
+	// The meshes of these classes weren't loaded, so only the classes are deleted
+	for (auto& classPair : result->classList) delete classPair.second;
+
+	for (HINSTANCE moduleDll : result->moduleList) FreeLibrary(moduleDll);
+
+	delete result;
+}
+
+void UCSO::Cargo::FinishWarmUp()
+{
+	// Wait for the thread, so it doesn't publish its result after the simulation ends
+	if (warmUpThread)
+	{
+		warmUpCancelled.store(true);
+
+		WaitForSingleObject(warmUpThread, INFINITE);
+		CloseHandle(warmUpThread);
+
+		warmUpThread = nullptr;
+	}
+
+	// The result isn't taken, as the meshes mustn't be loaded while the simulation is closing
+	DiscardWarmUpResult();
+
+	for (auto classIt = classMap.begin(); classIt != classMap.end();)
+	{
+		CargoClass* cargoClass = classIt->second;
+
+		// Release the warm-up reference
+		if (cargoClass->warmedUp && !--cargoClass->refCount)
+		{
+			delete cargoClass;
+			classIt = classMap.erase(classIt);
+		}
+		else ++classIt;
+	}
+
+	for (HINSTANCE moduleDll : warmUpModules) FreeLibrary(moduleDll);
+
+	warmUpModules.clear();
+
+	// Warm up and read the configuration again in the next simulation, as the DLL can be kept loaded by the vessels' API
+	warmUpStarted = false;
+	configLoaded = false;
 }
 
 void UCSO::Cargo::ThrowWarning(const char* warning)
@@ -144,68 +522,139 @@ void UCSO::Cargo::ThrowWarning(const char* warning)
 void UCSO::Cargo::clbkLoadStateEx(FILEHANDLE scn, void* status)
 {
 	char* line;
+	ScenarioLine scenarioLine;
 
 	while (oapiReadScenario_nextline(scn, line))
 	{
-		std::istringstream ss;
-		ss.str(line);
-		std::string data;
+		// Pass the line to Orbiter if it isn't a UCSO item
+		if (!TokenizeScenarioLine(line, scenarioLine) || !ReadScenarioItem(scenarioLine)) ParseScenarioLineEx(line, status);
+	}
+
+	if (unpacked) SetUnpackedCaps(false);
+}
+
+bool UCSO::Cargo::ReadScenarioItem(const ScenarioLine& scenarioLine)
+{
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
+	bool unpackable = dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY;
+	bool spawnsVessel = unpackable && dataStruct.unpackingType == ORBITER_VESSEL;
+
+	switch (scenarioLine.keyHash)
+	{
+	// Paged cargoes can be saved by any cargo
+	case HashScenarioKey("PagedCargo"):
+	{
+		if (!scenarioLine.IsKey("PagedCargo")) return false;
+
+		std::istringstream ss(scenarioLine.value);
+		LoadPagedCargo(ss);
+
+		return true;
+	}
+	case HashScenarioKey("Unpacked"):
+		if (!scenarioLine.IsKey("Unpacked") || !unpackable || spawnsVessel) return false;
+
+		unpacked = scenarioLine.GetInt() != 0;
+
+		return true;
+	case HashScenarioKey("Landing"):
+		if (!scenarioLine.IsKey("Landing") || !spawnsVessel) return false;
+
+		landing = scenarioLine.GetInt() != 0;
+
+		return true;
+	case HashScenarioKey("Timing"):
+		if (!scenarioLine.IsKey("Timing") || !spawnsVessel) return false;
+
+		timing = scenarioLine.GetInt() != 0;
+
+		return true;
+	case HashScenarioKey("Timer"):
+		if (!scenarioLine.IsKey("Timer") || !spawnsVessel) return false;
+
+		timer = scenarioLine.GetFloat();
+
+		return true;
+	default:
+		return false;
+	}
+}
 
-		if (ss >> data) 
+void UCSO::Cargo::clbkPreStep(double simt, double simdt, double mjd)
+{
+	// Only one cargo closes the runtime frame for all cargoes
+	if (pagingKeeper == this) UpdateRuntime();
+
+	if (profilerInterval <= 0)
+	{
+		if (!runtime.timing)
 		{
-			switch (dataStruct.type)
-			{
-			case UNPACKABLE_ONLY:
-			case PACKABLE_UNPACKABLE:
-				switch (dataStruct.unpackingType)
-				{
-				case UCSO_RESOURCE:
-				case UCSO_MODULE:
-					if (data == "Unpacked") ss >> dataStruct.unpacked;
-					else ParseScenarioLineEx(line, status);
-
-					if (dataStruct.unpacked) SetUnpackedCaps(false);
-
-					break;
-				case ORBITER_VESSEL:
-					if (data == "Landing") ss >> landing;
-					else if (data == "Timing") ss >> timing;
-					else if (data == "Timer") ss >> timer;
-					else ParseScenarioLineEx(line, status);
-
-					break;
-				}
-
-				break;
-			default:
-				ParseScenarioLineEx(line, status);
-
-				break;
-			}
+			StepCargo(simdt);
+			return;
 		}
-		else ParseScenarioLineEx(line, status);
+
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		StepCargo(simdt);
+
+		frameTime += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+		return;
+	}
+
+	// Only one cargo closes the profiler frame for all cargoes
+	if (pagingKeeper == this) UpdateProfiler();
+
+	AllocationCounter allocations;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	{
+		AllocationScope allocationScope(allocations);
+
+		StepCargo(simdt);
 	}
+
+	double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+
+	frameTime += time;
+	frameProfile.time += time;
+	frameProfile.steppedCount++;
+	frameProfile.allocationCount += allocations.count;
+	frameProfile.allocatedBytes += allocations.bytes;
 }
 
-void UCSO::Cargo::clbkPreStep(double simt, double simdt, double mjd)
+void UCSO::Cargo::StepCargo(double simdt)
 {
+	// Only one cargo checks the paging for all cargoes
+	if (pagingKeeper == this && (cargoPaging || !pagedList.empty())) UpdatePaging(simdt);
+
 	// If not landed but contacted the ground
 	if (GroundContact() && !(GetFlightStatus() & 1))
 	{
+		if (profilerInterval > 0) frameProfile.groundResets++;
+
 		VESSELSTATUS2 status;
 		memset(&status, 0, sizeof(status));
 		status.version = 2;
 		GetStatusEx(&status);
 
 		status.status = 1;
-		SetGroundRotation(status, dataStruct.unpacked ? dataStruct.unpackedHeight : 0.65);
+		SetGroundRotation(status, unpacked ? cargoClass->dataStruct.unpackedHeight : 0.65);
 
 		DefSetStateEx(&status);
 	}
 
+	if ((GetFlightStatus() & 1) && !landing && !timing) frameSettledCount++;
+	else frameAwakeCount++;
+
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
 	// Don't continue if the cargo is not unpackable or not Orbiter vessel
 	if (!(dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) || dataStruct.unpackingType != ORBITER_VESSEL) return;
 
+	if (profilerInterval > 0) frameProfile.wokenCount++;
+
 	bool attached = GetAttachmentStatus(attachmentHandle);
 
 	bool released = this->attached && !attached;
@@ -218,23 +667,25 @@ void UCSO::Cargo::clbkPreStep(double simt, double simdt, double mjd)
 		if (landing) landing = false;
 		if (timing) { timer = 0; timing = false; }
 	}
-	else if (released)
-	{
-		if (dataStruct.unpackingMode == DELAYING) timing = true;
-		else if (dataStruct.unpackingMode == LANDING) landing = true;
-	}
+	else if (released) CargoReleased();
 
 	// If landing flag is on and contacted the ground
 	if (landing && GroundContact())
 	{
+		if (profilerInterval > 0) frameProfile.unpacksTriggered++;
+
 		UnpackCargo();
 		landing = false;
 	}
 	else if (timing) 
 	{
+		if (profilerInterval > 0) frameProfile.timersAdvanced++;
+
 		timer += simdt;
 		if (timer >= dataStruct.unpackingDelay) 
 		{
+			if (profilerInterval > 0) frameProfile.unpacksTriggered++;
+
 			UnpackCargo();
 			timer = 0;
 			timing = false;
@@ -244,6 +695,9 @@ void UCSO::Cargo::clbkPreStep(double simt, double simdt, double mjd)
 
 UCSO::DataStruct UCSO::Cargo::GetDataStruct()
 {
+	DataStruct dataStruct = cargoClass->dataStruct;
+	dataStruct.unpacked = unpacked;
+
 	if (dataStruct.type == RESOURCE ||
 		((dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) && dataStruct.unpackingType == UCSO_RESOURCE))
 		dataStruct.netMass = GetFuelMass();
@@ -253,7 +707,9 @@ UCSO::DataStruct UCSO::Cargo::GetDataStruct()
 
 bool UCSO::Cargo::PackCargo()
 {
-	dataStruct.unpacked = false;
+	TraceScope traceScope("Cargo::PackCargo");
+
+	unpacked = false;
 
 	SetPackedCaps();
 
@@ -262,9 +718,13 @@ bool UCSO::Cargo::PackCargo()
 
 bool UCSO::Cargo::UnpackCargo(bool once)
 {
+	TraceScope traceScope("Cargo::UnpackCargo");
+
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
 	if (dataStruct.unpackingType != ORBITER_VESSEL)
 	{
-		dataStruct.unpacked = true;
+		unpacked = true;
 
 		SetUnpackedCaps();
 
@@ -277,10 +737,12 @@ bool UCSO::Cargo::UnpackCargo(bool once)
 
 		for (int cargo = 1; cargo < dataStruct.spawnCount; cargo++)
 		{
-			std::string spawnName = GetClassNameA();
+			CountedString spawnName = GetClassNameA();
 			spawnName.erase(0, 5);
 			SetSpawnName(spawnName);
 
+			TraceScope spawnScope("Cargo::SpawnVessel");
+
 			OBJHANDLE cargoHandle = oapiCreateVesselEx(spawnName.c_str(), GetClassNameA(), &status);
 
 			if (!cargoHandle) return false;
@@ -303,8 +765,10 @@ bool UCSO::Cargo::UnpackCargo(bool once)
 
 	for (int cargo = 0; cargo < dataStruct.spawnCount; cargo++)
 	{
-		std::string spawnName = dataStruct.spawnName;
+		CountedString spawnName = dataStruct.spawnName.c_str();
 		SetSpawnName(spawnName);
+
+		TraceScope spawnScope("Cargo::SpawnVessel");
 	
 		cargoHandle = oapiCreateVesselEx(spawnName.c_str(), dataStruct.spawnModule.c_str(), &status);
 
@@ -313,6 +777,8 @@ bool UCSO::Cargo::UnpackCargo(bool once)
 		if (once) break;
 	}
 
+	PrepareDeletion();
+
 	// Delete the cargo and move the camera to the unpacked one
 	oapiDeleteVessel(GetHandle(), cargoHandle);
 
@@ -321,11 +787,15 @@ bool UCSO::Cargo::UnpackCargo(bool once)
 
 double UCSO::Cargo::DrainResource(double mass)
 {
+	TraceScope traceScope("Cargo::DrainResource");
+
 	double fuelMass = GetFuelMass();
 
 	if (fuelMass == 0) return 0;
 
-	if (!drainUnpackedResources && (dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) && !dataStruct.unpacked)
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
+	if (!drainUnpackedResources && (dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) && !unpacked)
 		return 0;
 
 	double drainedMass;
@@ -339,10 +809,29 @@ double UCSO::Cargo::DrainResource(double mass)
 	return drainedMass;
 }
 
+void UCSO::Cargo::CargoReleased()
+{
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
+	// Don't continue if the cargo is not unpackable or not Orbiter vessel
+	if (!(dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) || dataStruct.unpackingType != ORBITER_VESSEL) return;
+
+	if (dataStruct.unpackingMode == DELAYING) timing = true;
+	else if (dataStruct.unpackingMode == LANDING) landing = true;
+}
+
+void UCSO::Cargo::SetMeshVisible(UINT meshIndex, bool visible)
+{
+	// If the mesh wasn't loaded
+	if (meshIndex == UINT(-1)) return;
+
+	SetMeshVisibilityMode(meshIndex, visible ? MESHVIS_EXTERNAL : MESHVIS_NEVER);
+}
+
 void UCSO::Cargo::SetPackedCaps(bool init)
 {
 	// Don't proceed if unpacked
-	if (dataStruct.unpacked) return;
+	if (unpacked) return;
 
 	VESSELSTATUS2 status;
 
@@ -356,12 +845,15 @@ void UCSO::Cargo::SetPackedCaps(bool init)
 		ClearAttachments();
 	}
 
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
 	// Replace the unpacked mesh with the packed mesh
-	InsertMesh(packedMesh.c_str(), 0);
+	SetMeshVisible(unpackedMeshIndex, false);
+	SetMeshVisible(packedMeshIndex, true);
 
 	if (dataStruct.type == RESOURCE) SetEmptyMass(containerMass); 
 	else if ((dataStruct.type == PACKABLE_UNPACKABLE || dataStruct.type == UNPACKABLE_ONLY) && dataStruct.unpackingType == UCSO_RESOURCE)
-		SetEmptyMass(containerMass + resourceContainerMass);
+		SetEmptyMass(containerMass + cargoClass->resourceContainerMass);
 	else SetEmptyMass((dataStruct.netMass *  dataStruct.spawnCount) + containerMass);
 
 	SetSize(0.65);
@@ -397,6 +889,10 @@ void UCSO::Cargo::SetPackedCaps(bool init)
 
 void UCSO::Cargo::SetUnpackedCaps(bool init)
 {
+	const CargoClass& cargoClass = *this->cargoClass;
+	const DataStruct& dataStruct = cargoClass.dataStruct;
+	const double unpackedSize = cargoClass.unpackedSize;
+
 	VESSELSTATUS2 status;
 
 	if (init)
@@ -407,20 +903,26 @@ void UCSO::Cargo::SetUnpackedCaps(bool init)
 	}
 
 	ClearAttachments();
-	attachmentHandle = CreateAttachment(true, unpackedAttachPos, { 0, 1, 0 }, { 0, 0, 1 }, "UCSO");
+	const CargoConfig::Vector& attachPos = cargoClass.unpackedAttachPos;
+	attachmentHandle = CreateAttachment(true, { attachPos.x, attachPos.y, attachPos.z }, { 0, 1, 0 }, { 0, 0, 1 }, "UCSO");
 
-	InsertMesh(unpackedMesh.c_str(), 0);
+	// Replace the packed mesh with the unpacked mesh
+	SetMeshVisible(packedMeshIndex, false);
+	SetMeshVisible(unpackedMeshIndex, true);
 
 	SetSize(unpackedSize);
 
-	if (dataStruct.unpackingType == UCSO_RESOURCE) SetEmptyMass(resourceContainerMass);
+	if (dataStruct.unpackingType == UCSO_RESOURCE) SetEmptyMass(cargoClass.resourceContainerMass);
 	else SetEmptyMass(dataStruct.netMass);
 
+	const CargoConfig::Vector& unpackedPMI = cargoClass.unpackedPMI;
+	const CargoConfig::Vector& unpackedCS = cargoClass.unpackedCS;
+
 	// If the unpacked PMI is set
-	if (unpackedPMI.x != -99 && unpackedPMI.y != -99 && unpackedPMI.z != -99) SetPMI(unpackedPMI);
+	if (unpackedPMI.x != -99 && unpackedPMI.y != -99 && unpackedPMI.z != -99) SetPMI({ unpackedPMI.x, unpackedPMI.y, unpackedPMI.z });
 
 	// If the unpacked cross sections is set
-	if (unpackedCS.x != -99 && unpackedCS.y != -99 && unpackedCS.z != -99) SetCrossSections(unpackedCS);
+	if (unpackedCS.x != -99 && unpackedCS.y != -99 && unpackedCS.z != -99) SetCrossSections({ unpackedCS.x, unpackedCS.y, unpackedCS.z });
 
 	double stiffness = GetMass() * G * 1000;
 	double damping = 0.9 * (2 * sqrt(GetMass() * stiffness));
@@ -451,6 +953,10 @@ void UCSO::Cargo::clbkSaveState(FILEHANDLE scn)
 	// Set the default state
 	VESSEL4::clbkSaveState(scn);
 
+	if (pagingKeeper == this) SavePagedCargo(scn);
+
+	const DataStruct& dataStruct = cargoClass->dataStruct;
+
 	switch (dataStruct.type)
 	{
 	case UNPACKABLE_ONLY:
@@ -459,7 +965,7 @@ void UCSO::Cargo::clbkSaveState(FILEHANDLE scn)
 		{
 		case UCSO_RESOURCE:
 		case UCSO_MODULE:
-			oapiWriteScenario_int(scn, "Unpacked", dataStruct.unpacked);
+			oapiWriteScenario_int(scn, "Unpacked", unpacked);
 
 			break;
 		case ORBITER_VESSEL:
@@ -476,3 +982,295 @@ void UCSO::Cargo::clbkSaveState(FILEHANDLE scn)
 	}
 }
 
+
+
+void UCSO::Cargo::UpdateRuntime()
+{
+	// Close the previous frame
+	runtime.awakeCount = frameAwakeCount;
+	runtime.settledCount = frameSettledCount;
+	runtime.frameTime = frameTime;
+
+	frameAwakeCount = 0;
+	frameSettledCount = 0;
+	frameTime = 0;
+
+	TakeWarmUpResult();
+
+	if (!runtime.timing) return;
+
+	std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+	// Move the slowest API call window every second
+	if (std::chrono::duration<double>(time - runtimeWindowTime).count() < 1) return;
+	runtimeWindowTime = time;
+
+	memcpy(runtime.slowestCall, runtime.windowSlowestCall, sizeof(runtime.slowestCall));
+	runtime.slowestCallTime = runtime.windowSlowestCallTime;
+
+	runtime.windowSlowestCall[0] = '\0';
+	runtime.windowSlowestCallTime = 0;
+}
+
+void UCSO::Cargo::UpdateProfiler()
+{
+	// Close the previous frame
+	if (frameProfile.steppedCount > 0) profileList.push_back(frameProfile);
+	frameProfile = FrameProfile();
+
+	std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+
+	if (std::chrono::duration<double>(time - profilerTime).count() < profilerInterval) return;
+	profilerTime = time;
+
+	if (profileList.empty()) return;
+
+	double stepTime[2], stepped[2], woken[2], resets[2], timers[2], unpacks[2], allocations[2], bytes[2];
+
+	GetPercentiles([](const FrameProfile& profile) { return profile.time; }, stepTime);
+	GetPercentiles([](const FrameProfile& profile) { return profile.steppedCount; }, stepped);
+	GetPercentiles([](const FrameProfile& profile) { return profile.wokenCount; }, woken);
+	GetPercentiles([](const FrameProfile& profile) { return profile.groundResets; }, resets);
+	GetPercentiles([](const FrameProfile& profile) { return profile.timersAdvanced; }, timers);
+	GetPercentiles([](const FrameProfile& profile) { return profile.unpacksTriggered; }, unpacks);
+	GetPercentiles([](const FrameProfile& profile) { return profile.allocationCount; }, allocations);
+	GetPercentiles([](const FrameProfile& profile) { return profile.allocatedBytes; }, bytes);
+
+	oapiWriteLogV("UCSO Profiler: %d frames, per frame p50/p99: time %.1f/%.1f us, cargoes %g/%g, woken %g/%g, ground resets %g/%g, timers %g/%g, unpacks %g/%g, allocations %g/%g (%g/%g bytes)",
+		static_cast<int>(profileList.size()), stepTime[0], stepTime[1], stepped[0], stepped[1], woken[0], woken[1], resets[0], resets[1],
+		timers[0], timers[1], unpacks[0], unpacks[1], allocations[0], allocations[1], bytes[0], bytes[1]);
+
+	profileList.clear();
+}
+
+template<class Figure> void UCSO::Cargo::GetPercentiles(Figure figure, double percentiles[2])
+{
+	percentileList.clear();
+
+	for (const FrameProfile& profile : profileList) percentileList.push_back(static_cast<double>(figure(profile)));
+
+	// Get the values at the percentile positions, without sorting the whole list
+	for (int index = 0; index < 2; index++)
+	{
+		auto valueIt = percentileList.begin() + static_cast<int>((index ? 0.99 : 0.5) * (percentileList.size() - 1));
+		std::nth_element(percentileList.begin(), valueIt, percentileList.end());
+
+		percentiles[index] = *valueIt;
+	}
+}
+
+void UCSO::Cargo::UpdatePaging(double simdt)
+{
+	// Check the cargoes every second
+	pagingTimer += simdt;
+	if (pagingTimer < 1) return;
+	pagingTimer = 0;
+
+	// If the paging is disabled, create all paged cargoes (e.g. loaded from a scenario)
+	if (!cargoPaging)
+	{
+		for (const PagedCargo& pagedCargo : pagedList) PageIn(pagedCargo);
+		pagedList.clear();
+
+		return;
+	}
+
+	pagingVesselList.clear();
+
+	// Get the position of every vessel which isn't a UCSO cargo, depot, or pallet, as they don't need the cargoes near them
+	for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+	{
+		VESSEL* vessel = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+
+		if (strncmp(vessel->GetClassNameA(), "UCSO", 4) == 0 || IsCargoStorage(vessel)) continue;
+
+		VECTOR3 pos;
+		vessel->GetGlobalPos(pos);
+		pagingVesselList.push_back(pos);
+	}
+
+	// Create the paged cargoes if a vessel is in the paging range
+	for (auto it = pagedList.begin(); it != pagedList.end();)
+	{
+		VECTOR3 pos;
+		oapiEquToGlobal(it->body, it->lng, it->lat, oapiGetSize(it->body), &pos);
+
+		if (GetNearestVessel(pagingVesselList, pos) <= pagingRange && PageIn(*it)) it = pagedList.erase(it);
+		else ++it;
+	}
+
+	// Page the cargoes if no vessel is in the paging range plus the hysteresis
+	// The list is copied, as paged cargoes are removed from it
+	pagingCargoList.assign(cargoList.begin(), cargoList.end());
+
+	for (Cargo* cargo : pagingCargoList)
+	{
+		if (cargo == this || !cargo->CanPageOut()) continue;
+
+		VECTOR3 pos;
+		cargo->GetGlobalPos(pos);
+
+		if (GetNearestVessel(pagingVesselList, pos) > pagingRange + pagingHysteresis) cargo->PageOut();
+	}
+}
+
+void UCSO::Cargo::PrepareDeletion()
+{
+	// If another cargo will keep the paging
+	if (pagingKeeper != this || cargoList.size() > 1) return;
+
+	// The created cargoes are new cargoes, so one of them keeps the paging after this cargo is deleted
+	for (auto it = pagedList.begin(); it != pagedList.end();)
+	{
+		if (PageIn(*it)) it = pagedList.erase(it);
+		else ++it;
+	}
+}
+
+void UCSO::Cargo::ClearPaging()
+{
+	pagedList.clear();
+	pagingTimer = 0;
+	pagedInCount = 0;
+	pagedOutCount = 0;
+}
+
+bool UCSO::Cargo::CanPageOut()
+{
+	// Only landed and released cargoes can be paged
+	if (!(GetFlightStatus() & 1) || GetAttachmentStatus(attachmentHandle)) return false;
+
+	// Don't page the cargo if it will be unpacked or it has the focus
+	return !landing && !timing && oapiGetFocusObject() != GetHandle();
+}
+
+bool UCSO::Cargo::PageOut()
+{
+	VESSELSTATUS2 status;
+	memset(&status, 0, sizeof(status));
+	status.version = 2;
+	GetStatusEx(&status);
+
+	PagedCargo pagedCargo;
+
+	pagedCargo.className = GetClassNameA();
+	pagedCargo.name = GetName();
+	pagedCargo.body = status.rbody;
+	pagedCargo.lng = status.surf_lng;
+	pagedCargo.lat = status.surf_lat;
+	pagedCargo.hdg = status.surf_hdg;
+	pagedCargo.unpacked = unpacked;
+	pagedCargo.fuelMass = GetFuelMass();
+
+	if (!oapiDeleteVessel(GetHandle())) return false;
+
+	pagedList.push_back(pagedCargo);
+	pagedOutCount++;
+
+	return true;
+}
+
+bool UCSO::Cargo::PageIn(const PagedCargo& pagedCargo)
+{
+	VESSELSTATUS2 status;
+	memset(&status, 0, sizeof(status));
+	status.version = 2;
+
+	status.rbody = pagedCargo.body;
+	status.status = 1;
+	status.surf_lng = pagedCargo.lng;
+	status.surf_lat = pagedCargo.lat;
+	status.surf_hdg = pagedCargo.hdg;
+
+	SetGroundRotation(status, 0.65);
+
+	CountedString spawnName = pagedCargo.name;
+
+	// If the cargo name is used by another vessel, set a new spawn name from the class name without UCSO/
+	if (oapiGetVesselByName(&spawnName[0]))
+	{
+		spawnName = pagedCargo.className;
+		spawnName.erase(0, 5);
+		SetSpawnName(spawnName);
+	}
+
+	OBJHANDLE cargoHandle = oapiCreateVesselEx(spawnName.c_str(), pagedCargo.className.c_str(), &status);
+
+	if (!cargoHandle) return false;
+
+	Cargo* cargo = static_cast<Cargo*>(oapiGetVesselInterface(cargoHandle));
+
+	// Restore the cargo state. The unpacked caps will set the unpacked height
+	if (pagedCargo.unpacked) cargo->UnpackCargo(true);
+
+	if (!cargo->cargoClass->dataStruct.resource.empty()) cargo->SetFuelMass(pagedCargo.fuelMass);
+
+	pagedInCount++;
+
+	return true;
+}
+
+double UCSO::Cargo::GetNearestVessel(const CountedVector<VECTOR3>& vesselList, VECTOR3 pos)
+{
+	double nearestDistance = INFINITY;
+
+	for (const VECTOR3& vesselPos : vesselList)
+	{
+		double distance = length(vesselPos - pos);
+
+		if (distance < nearestDistance) nearestDistance = distance;
+	}
+
+	return nearestDistance;
+}
+
+bool UCSO::Cargo::IsCargoStorage(VESSEL* vessel)
+{
+	for (DWORD index = 0; index < vessel->AttachmentCount(true); index++)
+	{
+		const char* id = vessel->GetAttachmentId(vessel->GetAttachmentHandle(true, index));
+
+		if (!strcmp(id, "UCSO_DP") || !strcmp(id, "UCSO_PL")) return true;
+	}
+
+	return false;
+}
+
+void UCSO::Cargo::SavePagedCargo(FILEHANDLE scn)
+{
+	char bodyName[256];
+
+	for (const PagedCargo& pagedCargo : pagedList)
+	{
+		oapiGetObjectName(pagedCargo.body, bodyName, 256);
+
+		std::ostringstream ss;
+		ss.precision(12);
+
+		ss << pagedCargo.className << ' ' << pagedCargo.name << ' ' << bodyName << ' ' << pagedCargo.lng << ' ' << pagedCargo.lat << ' '
+			<< pagedCargo.hdg << ' ' << pagedCargo.unpacked << ' ' << pagedCargo.fuelMass;
+
+		std::string line = ss.str();
+
+		oapiWriteScenario_string(scn, "PagedCargo", &line[0]);
+	}
+}
+
+void UCSO::Cargo::LoadPagedCargo(std::istringstream& ss)
+{
+	PagedCargo pagedCargo;
+	std::string bodyName;
+
+	ss >> pagedCargo.className >> pagedCargo.name >> bodyName >> pagedCargo.lng >> pagedCargo.lat 
+		>> pagedCargo.hdg >> pagedCargo.unpacked >> pagedCargo.fuelMass;
+
+	pagedCargo.body = ss.fail() ? nullptr : oapiGetObjectByName(&bodyName[0]);
+
+	if (!pagedCargo.body)
+	{
+		oapiWriteLog("UCSO Warning: Couldn't load a paged cargo from the scenario");
+		return;
+	}
+
+	pagedList.push_back(pagedCargo);
+}
\ No newline at end of file
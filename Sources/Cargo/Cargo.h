@@ -21,15 +21,28 @@
 
 #pragma once
 #include "..\API\Helper.h"
+#include "CargoConfig.h"
+#include <vector>
+#include <map>
+#include <sstream>
+#include <chrono>
+#include <atomic>
 
 DLLCLBK const char* GetUCSOVersion() { return _strdup("1.1.1"); }
 
+DLLCLBK UCSO::TraceFunction GetUCSOTraceFunction();
+
+DLLCLBK bool FlushUCSOTrace();
+
+DLLCLBK UCSO::RuntimeStatistics* GetUCSORuntimeStatistics();
+
 namespace UCSO
 {
 	class Cargo : public VESSEL4
 	{
 	public:
 		Cargo(OBJHANDLE hObj, int fmodel);
+		~Cargo();
 
 		void clbkSetClassCaps(FILEHANDLE cfg) override;
 		void clbkLoadStateEx(FILEHANDLE scn, void* status) override;
@@ -40,6 +53,27 @@ namespace UCSO
 		virtual bool PackCargo();
 		virtual bool UnpackCargo(bool once = false);
 		virtual double DrainResource(double mass);
+		virtual void CargoReleased();
+		// Called before UCSO deletes the cargo. If it keeps the paging and no cargo can take it, the paged cargoes are created, so they aren't lost
+		virtual void PrepareDeletion();
+
+		// Gets the function which adds the events to the trace buffer, or nullptr if the tracing is disabled
+		static TraceFunction GetTraceFunction();
+		// Writes the trace buffer to UCSO_Trace.json. Returns false if the tracing is disabled or the file couldn't be written
+		static bool FlushTrace();
+
+		static RuntimeStatistics runtime; // The live figures of all UCSO modules, for the diagnostics MFD
+
+		// The UCSO_Config.cfg settings which the vessels' API uses. The configuration is read first if no cargo has read it
+		static bool GetDrainUnpackedResources();
+		static double GetContainerMass();
+
+		// Starts reading the cargo classes and loading their files on a background thread, if the warm-up is enabled
+		static void StartWarmUp();
+		// Frees the classes and the modules kept by the warm-up
+		static void FinishWarmUp();
+		// Forgets the paged cargoes when the simulation ends, so they aren't created in the next one
+		static void ClearPaging();
 
 	private:
 		enum CargoType
@@ -65,18 +99,60 @@ namespace UCSO
 			MANUAL
 		};
 
-		DataStruct dataStruct;
+		// The configuration of a cargo class, which is read once and shared by all cargoes of the class
+		struct CargoClass : CargoConfig
+		{
+			int refCount = 0; // The cargoes which use the class. The class is deleted with its last cargo
+
+			DataStruct dataStruct; // The configured data as returned by GetDataStruct. The unpacked state is kept by the cargoes
+
+			// The meshes loaded once as global templates, so the cargoes don't load them from the files
+			MESHHANDLE packedMeshTemplate = nullptr;
+			MESHHANDLE unpackedMeshTemplate = nullptr;
+
+			bool warmedUp = false; // If the class is read by the warm-up, which keeps a reference to it until the simulation ends
+		};
+
+		// Reads the class items from the configuration file opened by Orbiter
+		struct FileReader
+		{
+			FILEHANDLE cfg;
+
+			bool ReadString(const char* item, std::string& value);
+			bool ReadFloat(const char* item, double& value) { return oapiReadItem_float(cfg, item, value); }
+			bool ReadInt(const char* item, int& value) { return oapiReadItem_int(cfg, item, value); }
+			bool ReadBool(const char* item, bool& value) { return oapiReadItem_bool(cfg, item, value); }
+			bool ReadVector(const char* item, CargoConfig::Vector& value);
+		};
+
+		// The classes read by the warm-up thread, which are published to the main thread at once
+		struct WarmUpResult
+		{
+			std::vector<std::pair<std::string, CargoClass*>> classList; // The classes by their class keys
+			std::vector<HINSTANCE> moduleList; // The modules loaded for the classes
+		};
+
+		static bool warmUpStarted;
+		static HANDLE warmUpThread; // Waited for when the simulation ends
+		static std::atomic<bool> warmUpCancelled; // Set by the main thread, so the warm-up thread stops reading the classes
+		static std::atomic<WarmUpResult*> warmUpResult; // Set by the warm-up thread, and taken by the main thread
+		static std::vector<HINSTANCE> warmUpModules;
 
-		std::string packedMesh;
-		std::string unpackedMesh;
+		static DWORD WINAPI WarmUp(LPVOID cargoDll);
+		static void WarmUpModule(const std::string& module, std::vector<HINSTANCE>& moduleList);
+		static void WarmUpFile(const std::string& fileName);
+		static void TakeWarmUpResult();
+		static void DiscardWarmUpResult();
 
-		double resourceContainerMass = 0;
-		double unpackedSize;
+		static std::map<std::string, CargoClass*> classMap; // The loaded classes by their class names
 
-		VECTOR3 unpackedAttachPos = { 0,0,0 };
-		VECTOR3 unpackedPMI = { -99,-99,-99 };
-		VECTOR3 unpackedCS = { -99,-99,-99 };
+		CargoClass* cargoClass = nullptr;
 
+		// The meshes are inserted once, and only their visibility is switched when packing and unpacking
+		UINT packedMeshIndex = UINT(-1);
+		UINT unpackedMeshIndex = UINT(-1);
+
+		bool unpacked = false;
 		double timer = 0;
 		bool landing = false;
 		bool timing = false;
@@ -84,15 +160,106 @@ namespace UCSO
 		ATTACHMENTHANDLE attachmentHandle = nullptr;
 		bool attached = false;
 
+		int countedType = -1; // The type this cargo is counted as in the runtime figures
+
+		// The paged cargo record, which is kept instead of the cargo vessel while no vessel is near the cargo.
+		// The paging runs in the cargo step, so its records and lists use the counted allocator for the profiler
+		struct PagedCargo
+		{
+			CountedString className;
+			CountedString name;
+			OBJHANDLE body;
+			double lng;
+			double lat;
+			double hdg;
+			bool unpacked;
+			double fuelMass;
+		};
+
+		static std::vector<Cargo*> cargoList;
+		static CountedVector<PagedCargo> pagedList;
+		// The vessel positions and the cargoes of the paging check, which are kept so the check doesn't allocate every second
+		static CountedVector<VECTOR3> pagingVesselList;
+		static CountedVector<Cargo*> pagingCargoList;
+		static Cargo* pagingKeeper; // The cargo which checks the paging, saves the paged cargoes, and closes the profiler frames
+		static double pagingTimer;
+		static int pagedInCount;
+		static int pagedOutCount;
+
+		// The work of all cargoes in one frame, for the profiler
+		struct FrameProfile
+		{
+			double time = 0;       // The step time in microseconds
+			int steppedCount = 0;  // The cargoes which ran the step
+			int wokenCount = 0;    // The cargoes which ran the unpacking checks
+			int groundResets = 0;  // The landed status resets with DefSetStateEx
+			int timersAdvanced = 0;
+			int unpacksTriggered = 0;
+			int allocationCount = 0;
+			long long allocatedBytes = 0;
+		};
+
+		static FrameProfile frameProfile;
+		static std::vector<FrameProfile> profileList; // The frames since the last summary
+		static std::chrono::steady_clock::time_point profilerTime; // The last summary time
+
+		// The runtime figures of the current frame, which are moved to the runtime figures when the frame is closed
+		static int frameAwakeCount;
+		static int frameSettledCount;
+		static double frameTime;
+		static std::chrono::steady_clock::time_point runtimeWindowTime; // The start of the slowest API call window
+
+		static void UpdateRuntime();
+
+		static TraceBuffer* traceBuffer; // The trace events of all UCSO modules, or nullptr if the tracing is disabled
+
+		static void AddTraceEvent(const char* name, bool begin);
+
+		// Reads the UCSO items of the scenario. Returns false if the line isn't a UCSO item, so it's passed to Orbiter
+		bool ReadScenarioItem(const ScenarioLine& scenarioLine);
+
+		void StepCargo(double simdt);
+
+		static std::vector<double> percentileList; // The values of one figure, which is kept so the summaries don't allocate
+
+		static void UpdateProfiler();
+		// Gets the median and the 99th percentile of a figure of the profiled frames
+		template<class Figure> static void GetPercentiles(Figure figure, double percentiles[2]);
+
+		void SetMeshVisible(UINT meshIndex, bool visible);
 		void SetPackedCaps(bool init = true);
 		void SetUnpackedCaps(bool init = true);
 
+		void UpdatePaging(double simdt);
+		bool CanPageOut();
+		bool PageOut();
+		static bool PageIn(const PagedCargo& pagedCargo);
+		static double GetNearestVessel(const CountedVector<VECTOR3>& vesselList, VECTOR3 pos);
+		// Returns true if the vessel is a cargo depot or pallet, which are found by their UCSO_DP and UCSO_PL attachments
+		static bool IsCargoStorage(VESSEL* vessel);
+		void SavePagedCargo(FILEHANDLE scn);
+		void LoadPagedCargo(std::istringstream& ss);
+
+		void AcquireClass(FILEHANDLE cfg);
+		void ReleaseClass();
+		static void SetClassData(CargoClass& cargoClass);
+		static void LoadClassMeshes(const char* className, CargoClass& cargoClass);
+		// Gets the class map key, which is the lowercase class name with forward slashes, as the scenarios and the file names differ
+		static std::string GetClassKey(const char* className);
+
 		static void LoadConfig();
 		void ThrowWarning(const char* warning);
 	};
 }
 
 bool configLoaded = false;
-double containerMass = 85;
+double containerMass = UCSO::DEFAULT_CONTAINER_MASS;
 bool enableFocus = false;
-bool drainUnpackedResources = false;
\ No newline at end of file
+bool drainUnpackedResources = false;
+bool cargoPaging = false;
+double pagingRange = 5000;
+double pagingHysteresis = 1000;
+double profilerInterval = 0;
+bool tracing = false;
+int traceBufferSize = 65536;
+bool warmUp = false;
\ No newline at end of file
@@ -0,0 +1,228 @@
+// =======================================================================================
+// CargoCatalog.cpp : The available cargo catalog's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include "CargoCatalog.h"
+#include <algorithm>
+#include <cctype>
+
+bool UCSO::DirectoryWatcher::Start(const std::string& dirPath)
+{
+	Stop();
+
+	dirHandle = CreateFileA(dirPath.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+
+	if (dirHandle == INVALID_HANDLE_VALUE) return false;
+
+	overlapped = { };
+	overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+
+	if (!overlapped.hEvent || !RequestChanges()) { Stop(); return false; }
+
+	return true;
+}
+
+void UCSO::DirectoryWatcher::Stop()
+{
+	if (dirHandle != INVALID_HANDLE_VALUE)
+	{
+		// Wait for the pending request to be canceled, so the system doesn't write to the buffer after it's freed
+		DWORD bytes;
+		if (CancelIo(dirHandle)) GetOverlappedResult(dirHandle, &overlapped, &bytes, TRUE);
+
+		CloseHandle(dirHandle);
+		dirHandle = INVALID_HANDLE_VALUE;
+	}
+
+	if (overlapped.hEvent)
+	{
+		CloseHandle(overlapped.hEvent);
+		overlapped.hEvent = nullptr;
+	}
+}
+
+bool UCSO::DirectoryWatcher::GetChanges(std::vector<Change>& changeList)
+{
+	if (!IsStarted()) return true;
+
+	DWORD bytes;
+
+	// If the request isn't completed, there are no changes
+	if (!GetOverlappedResult(dirHandle, &overlapped, &bytes, FALSE))
+	{
+		if (GetLastError() == ERROR_IO_INCOMPLETE) return true;
+
+		// The directory can't be watched anymore (e.g., it was deleted)
+		Stop();
+		return false;
+	}
+
+	// If the changes didn't fit the buffer, they are lost
+	bool complete = bytes > 0;
+
+	for (DWORD offset = 0; complete;)
+	{
+		const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(changeBuffer + offset);
+
+		char fileName[MAX_PATH];
+		int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, int(info->FileNameLength / sizeof(WCHAR)), fileName, MAX_PATH, nullptr, nullptr);
+
+		switch (info->Action)
+		{
+		case FILE_ACTION_ADDED:
+		case FILE_ACTION_RENAMED_NEW_NAME:
+			changeList.push_back({ FILE_ADDED, std::string(fileName, length) });
+			break;
+		case FILE_ACTION_REMOVED:
+		case FILE_ACTION_RENAMED_OLD_NAME:
+			changeList.push_back({ FILE_REMOVED, std::string(fileName, length) });
+			break;
+		case FILE_ACTION_MODIFIED:
+			changeList.push_back({ FILE_CHANGED, std::string(fileName, length) });
+			break;
+		}
+
+		if (!info->NextEntryOffset) break;
+
+		offset += info->NextEntryOffset;
+	}
+
+	if (!RequestChanges()) { Stop(); return false; }
+
+	return complete;
+}
+
+bool UCSO::DirectoryWatcher::RequestChanges()
+{
+	ResetEvent(overlapped.hEvent);
+
+	// The folder names aren't watched, as the cargo list skips the folders
+	return ReadDirectoryChangesW(dirHandle, changeBuffer, sizeof(changeBuffer), FALSE,
+		FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE, nullptr, &overlapped, nullptr) != 0;
+}
+
+void UCSO::CargoCatalog::Init()
+{
+	Publish(ReadCargoList());
+
+	if (!watcher.Start(GetCargoDir())) oapiWriteLog("UCSO API Warning: Couldn't watch the cargo folder. New cargoes will be available after restarting");
+}
+
+std::shared_ptr<const UCSO::CargoCatalog::Snapshot> UCSO::CargoCatalog::Update()
+{
+	std::shared_ptr<const Snapshot> current = GetSnapshot();
+
+	if (!watcher.IsStarted()) return current;
+
+	std::vector<DirectoryWatcher::Change> changeList;
+
+	// If the changes were lost, read the whole directory again
+	if (!watcher.GetChanges(changeList))
+	{
+		std::vector<std::string> cargoList = ReadCargoList();
+
+		if (cargoList != current->cargoList) Publish(std::move(cargoList));
+
+		return GetSnapshot();
+	}
+
+	if (changeList.empty()) return current;
+
+	std::vector<std::string> cargoList = current->cargoList;
+	bool changed = false;
+
+	for (const DirectoryWatcher::Change& change : changeList)
+	{
+		std::string cargoName = GetCargoName(change.fileName);
+
+		auto cargoIt = std::lower_bound(cargoList.begin(), cargoList.end(), cargoName, CompareNames);
+		bool found = cargoIt != cargoList.end() && *cargoIt == cargoName;
+
+		switch (change.type)
+		{
+		case DirectoryWatcher::FILE_ADDED:
+			if (!found) { cargoList.insert(cargoIt, cargoName); changed = true; }
+			break;
+		case DirectoryWatcher::FILE_REMOVED:
+			if (found) { cargoList.erase(cargoIt); changed = true; }
+			break;
+		// The cargo name doesn't change, and the cargo class is read again when Orbiter loads it
+		case DirectoryWatcher::FILE_CHANGED:
+			break;
+		}
+	}
+
+	if (changed) Publish(std::move(cargoList));
+
+	return GetSnapshot();
+}
+
+std::string UCSO::CargoCatalog::GetCargoDir()
+{
+	char currentDir[MAX_PATH];
+	DWORD length = GetCurrentDirectoryA(MAX_PATH, currentDir);
+
+	// If the current directory doesn't fit, use the relative path
+	if (!length || length >= MAX_PATH) return "Config/Vessels/UCSO";
+
+	return std::string(currentDir, length) + "/Config/Vessels/UCSO";
+}
+
+bool UCSO::CargoCatalog::CompareNames(const std::string& first, const std::string& second)
+{
+	// Sort the names as Windows lists them, so the order is the same as after restarting
+	return std::lexicographical_compare(first.begin(), first.end(), second.begin(), second.end(), [](char firstChar, char secondChar)
+		{ return tolower(static_cast<unsigned char>(firstChar)) < tolower(static_cast<unsigned char>(secondChar)); });
+}
+
+std::vector<std::string> UCSO::CargoCatalog::ReadCargoList()
+{
+	std::vector<std::string> cargoList;
+	WIN32_FIND_DATAA findData;
+
+	// Iterate through every file in Config/Vessels/UCSO
+	HANDLE findHandle = FindFirstFileA((GetCargoDir() + "/*").c_str(), &findData);
+
+	if (findHandle != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			// Skip the folders, including . and ..
+			if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) cargoList.push_back(GetCargoName(findData.cFileName));
+		} while (FindNextFileA(findHandle, &findData));
+
+		FindClose(findHandle);
+	}
+
+	std::sort(cargoList.begin(), cargoList.end(), CompareNames);
+
+	return cargoList;
+}
+
+void UCSO::CargoCatalog::Publish(std::vector<std::string>&& cargoList)
+{
+	std::shared_ptr<Snapshot> newSnapshot = std::make_shared<Snapshot>();
+
+	newSnapshot->generation = GetSnapshot()->generation + 1;
+	newSnapshot->cargoList = std::move(cargoList);
+
+	std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(std::move(newSnapshot)));
+}
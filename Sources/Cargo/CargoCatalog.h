@@ -0,0 +1,94 @@
+// =======================================================================================
+// CargoCatalog.h : The available cargo catalog, which is updated when the cargo files change.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <Orbitersdk.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace UCSO
+{
+	// Watches the files of a directory without blocking. Only the Windows change notifications are implemented, as Orbiter is Windows only
+	class DirectoryWatcher
+	{
+	public:
+		enum ChangeType { FILE_ADDED = 0, FILE_REMOVED, FILE_CHANGED };
+
+		struct Change
+		{
+			ChangeType type;
+			std::string fileName;
+		};
+
+		DirectoryWatcher() = default;
+		DirectoryWatcher(const DirectoryWatcher&) = delete;
+		DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+		~DirectoryWatcher() { Stop(); }
+
+		// Returns false if the directory can't be watched
+		bool Start(const std::string& dirPath);
+		void Stop();
+
+		bool IsStarted() const { return dirHandle != INVALID_HANDLE_VALUE; }
+
+		// Adds the changes since the last call to the list. Returns false if some changes were lost, so the directory must be read again
+		bool GetChanges(std::vector<Change>& changeList);
+
+	private:
+		HANDLE dirHandle = INVALID_HANDLE_VALUE;
+		OVERLAPPED overlapped = { };
+		alignas(DWORD) char changeBuffer[16384];
+
+		bool RequestChanges();
+	};
+
+	// The cargo names in Config/Vessels/UCSO. Each change makes a new snapshot with the next generation,
+	// and the old snapshots aren't changed, so the indices a caller has are valid as long as it keeps the snapshot.
+	class CargoCatalog
+	{
+	public:
+		struct Snapshot
+		{
+			int generation = 0;
+			std::vector<std::string> cargoList;
+		};
+
+		// Reads the cargo directory and starts watching it. If it can't be watched, the catalog isn't updated
+		void Init();
+
+		// Applies the cargo file changes and returns the latest snapshot
+		std::shared_ptr<const Snapshot> Update();
+
+		std::shared_ptr<const Snapshot> GetSnapshot() const { return std::atomic_load(&snapshot); }
+
+	private:
+		std::shared_ptr<const Snapshot> snapshot = std::make_shared<Snapshot>();
+		DirectoryWatcher watcher;
+
+		static std::string GetCargoDir();
+		static std::string GetCargoName(const std::string& fileName) { return fileName.substr(0, fileName.find(".cfg")); }
+		static bool CompareNames(const std::string& first, const std::string& second);
+		static std::vector<std::string> ReadCargoList();
+
+		void Publish(std::vector<std::string>&& cargoList);
+	};
+}
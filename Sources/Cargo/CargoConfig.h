@@ -0,0 +1,380 @@
+// =======================================================================================
+// CargoConfig.h : The cargo configuration parser and the compiled configuration format.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <sys/stat.h>
+
+// This file doesn't use Orbiter, so it's shared by the cargo DLL and the configuration compiler
+namespace UCSO
+{
+	// The container mass if UCSO_Config.cfg doesn't set it
+	const double DEFAULT_CONTAINER_MASS = 85;
+
+	// The cargo class items as read from the cargo configuration file
+	struct CargoConfig
+	{
+		enum CargoType { STATIC = 0, RESOURCE, PACKABLE_UNPACKABLE, UNPACKABLE_ONLY };
+		enum UnpackingType { UCSO_RESOURCE = 0, UCSO_MODULE, ORBITER_VESSEL };
+		enum UnpackingMode { LANDING = 0, DELAYING, MANUAL };
+
+		struct Vector { double x, y, z; };
+
+		std::string packedMesh;
+		double netMass = 0;
+		int type = -1;
+		std::string resource;
+
+		int unpackingType = -1;
+		int spawnCount = 1;
+		bool breathable = false;
+		double unpackedHeight = 0;
+
+		std::string unpackedMesh;
+		double unpackedSize = 0;
+		double resourceContainerMass = 0;
+		Vector unpackedAttachPos = { 0,0,0 };
+		Vector unpackedPMI = { -99,-99,-99 };
+		Vector unpackedCS = { -99,-99,-99 };
+
+		std::string spawnName;
+		std::string spawnModule;
+		int unpackingMode = -1;
+		int unpackingDelay = 0;
+	};
+
+	// Reads the cargo class items. Returns false and adds the missing items to the list if any required item is missing.
+	// The reader has ReadString, ReadFloat, ReadInt, ReadBool, and ReadVector methods, which return false if the item isn't found.
+	template<class Reader> bool ReadCargoConfig(Reader& reader, CargoConfig& config, std::vector<std::string>& missingItems)
+	{
+		size_t missingCount = missingItems.size();
+
+		if (!reader.ReadString("PackedMesh", config.packedMesh)) missingItems.push_back("mesh");
+
+		if (!reader.ReadFloat("CargoMass", config.netMass)) missingItems.push_back("mass");
+
+		if (!reader.ReadInt("CargoType", config.type)) missingItems.push_back("type");
+
+		switch (config.type)
+		{
+		case CargoConfig::RESOURCE:
+			if (!reader.ReadString("CargoResource", config.resource)) missingItems.push_back("resource");
+
+			break;
+		case CargoConfig::UNPACKABLE_ONLY:
+			reader.ReadInt("SpawnCount", config.spawnCount);
+		case CargoConfig::PACKABLE_UNPACKABLE:
+			if (!reader.ReadInt("UnpackingType", config.unpackingType)) missingItems.push_back("unpacking type");
+
+			switch (config.unpackingType)
+			{
+			case CargoConfig::UCSO_RESOURCE:
+				if (!reader.ReadString("CargoResource", config.resource)) missingItems.push_back("resource");
+
+				reader.ReadFloat("ResourceContainerMass", config.resourceContainerMass);
+			case CargoConfig::UCSO_MODULE:
+				if (!reader.ReadString("UnpackedMesh", config.unpackedMesh)) missingItems.push_back("unpacked mesh");
+
+				if (!reader.ReadFloat("UnpackedSize", config.unpackedSize)) missingItems.push_back("unpacked size");
+
+				if (reader.ReadFloat("UnpackedHeight", config.unpackedHeight)) config.unpackedHeight = fabs(config.unpackedHeight);
+				else missingItems.push_back("unpacked height");
+
+				reader.ReadVector("UnpackedAttachPos", config.unpackedAttachPos);
+
+				reader.ReadVector("UnpackedPMI", config.unpackedPMI);
+
+				reader.ReadVector("UnpackedCS", config.unpackedCS);
+
+				reader.ReadBool("Breathable", config.breathable);
+
+				break;
+			case CargoConfig::ORBITER_VESSEL:
+				if (!reader.ReadString("SpawnName", config.spawnName)) missingItems.push_back("spawn name");
+
+				if (!reader.ReadString("SpawnModule", config.spawnModule)) missingItems.push_back("spawn module");
+
+				if (!reader.ReadInt("UnpackingMode", config.unpackingMode)) missingItems.push_back("unpacking mode");
+
+				if (config.unpackingMode == CargoConfig::DELAYING)
+				{
+					if (!reader.ReadInt("UnpackingDelay", config.unpackingDelay)) missingItems.push_back("unpacking delay");
+
+					if (reader.ReadFloat("SpawnHeight", config.unpackedHeight)) config.unpackedHeight = fabs(config.unpackedHeight);
+					else missingItems.push_back("spawn height");
+				}
+
+				break;
+			}
+
+			break;
+		default:
+			break;
+		}
+
+		return missingItems.size() == missingCount;
+	}
+
+	// Reads the items from a configuration file parsed without Orbiter. The item names aren't case sensitive, and the comments are removed
+	class TextConfigReader
+	{
+	public:
+		// Returns false if the file couldn't be opened
+		bool Parse(const std::string& fileName)
+		{
+			FILE* file = fopen(fileName.c_str(), "r");
+
+			if (!file) return false;
+
+			char line[512];
+
+			while (fgets(line, sizeof(line), file))
+			{
+				std::string lineString = line;
+
+				// Remove the comment
+				size_t commentPos = lineString.find(';');
+				if (commentPos != std::string::npos) lineString.erase(commentPos);
+
+				size_t equalPos = lineString.find('=');
+				if (equalPos == std::string::npos) continue;
+
+				std::istringstream itemStream(lineString.substr(0, equalPos));
+				std::string item;
+
+				if (!(itemStream >> item)) continue;
+
+				itemMap[GetItemKey(item.c_str())] = lineString.substr(equalPos + 1);
+			}
+
+			fclose(file);
+
+			return true;
+		}
+
+		bool ReadString(const char* item, std::string& value)
+		{
+			std::istringstream ss;
+
+			return FindItem(item, ss) && static_cast<bool>(ss >> value);
+		}
+
+		bool ReadFloat(const char* item, double& value)
+		{
+			std::istringstream ss;
+
+			return FindItem(item, ss) && static_cast<bool>(ss >> value);
+		}
+
+		bool ReadInt(const char* item, int& value)
+		{
+			std::istringstream ss;
+
+			return FindItem(item, ss) && static_cast<bool>(ss >> value);
+		}
+
+		bool ReadBool(const char* item, bool& value)
+		{
+			std::string valueString;
+
+			if (!ReadString(item, valueString)) return false;
+
+			std::string valueKey = GetItemKey(valueString.c_str());
+
+			if (valueKey == "true") value = true;
+			else if (valueKey == "false") value = false;
+			else return false;
+
+			return true;
+		}
+
+		bool ReadVector(const char* item, CargoConfig::Vector& value)
+		{
+			std::istringstream ss;
+
+			return FindItem(item, ss) && static_cast<bool>(ss >> value.x >> value.y >> value.z);
+		}
+
+	private:
+		std::map<std::string, std::string> itemMap; // The item values by the lowercase item names
+
+		static std::string GetItemKey(const char* item)
+		{
+			std::string itemKey = item;
+
+			for (char& character : itemKey) character = char(tolower(static_cast<unsigned char>(character)));
+
+			return itemKey;
+		}
+
+		bool FindItem(const char* item, std::istringstream& ss)
+		{
+			auto itemIt = itemMap.find(GetItemKey(item));
+
+			if (itemIt == itemMap.end()) return false;
+
+			ss.str(itemIt->second);
+
+			return true;
+		}
+	};
+
+	// The first bytes of the compiled configuration files, which include the format version
+	const char COMPILED_CONFIG_MAGIC[8] = { 'U', 'C', 'S', 'O', 'C', 'F', 'G', '1' };
+
+	// Checks if the vessel module is the UCSO cargo module. Orbiter accepts any case and both separators in the module name
+	inline bool IsCargoModule(std::string module)
+	{
+		for (char& character : module) character = character == '/' ? '\\' : char(tolower(static_cast<unsigned char>(character)));
+
+		return module == "ucso\\cargo";
+	}
+
+	// Gets the configuration file path from the configuration name, which is the class name without UCSO/
+	inline std::string GetConfigPath(const std::string& configName) { return "Config/Vessels/UCSO/" + configName + ".cfg"; }
+
+	// Gets the compiled configuration file path. The compiled files are kept apart, as the vessels' API lists every file in Config/Vessels/UCSO as a cargo
+	inline std::string GetCompiledConfigPath(const std::string& configName) { return "Config/UCSO_Compiled/" + configName + ".ucc"; }
+
+	// Gets the size and the modification time of the file, so a compiled configuration isn't used if its configuration file was changed
+	inline bool GetFileStamp(const std::string& fileName, int64_t& size, int64_t& time)
+	{
+		struct stat fileStat;
+
+		if (stat(fileName.c_str(), &fileStat)) return false;
+
+		size = static_cast<int64_t>(fileStat.st_size);
+		time = static_cast<int64_t>(fileStat.st_mtime);
+
+		return true;
+	}
+
+	namespace CompiledConfig
+	{
+		template<class Value> void Write(FILE* file, const Value& value) { fwrite(&value, sizeof(value), 1, file); }
+
+		inline void Write(FILE* file, const std::string& value)
+		{
+			uint32_t length = static_cast<uint32_t>(value.size());
+
+			Write(file, length);
+			fwrite(value.data(), 1, length, file);
+		}
+
+		template<class Value> bool Read(FILE* file, Value& value) { return fread(&value, sizeof(value), 1, file) == 1; }
+
+		inline bool Read(FILE* file, std::string& value)
+		{
+			uint32_t length;
+
+			if (!Read(file, length) || length > 4096) return false;
+
+			value.resize(length);
+
+			return fread(&value[0], 1, length, file) == length;
+		}
+	}
+
+	// Writes the compiled configuration with the stamp of its configuration file. Returns false if the file couldn't be written
+	inline bool WriteCompiledConfig(const std::string& fileName, const CargoConfig& config, int64_t sourceSize, int64_t sourceTime)
+	{
+		using namespace CompiledConfig;
+
+		FILE* file = fopen(fileName.c_str(), "wb");
+
+		if (!file) return false;
+
+		fwrite(COMPILED_CONFIG_MAGIC, 1, sizeof(COMPILED_CONFIG_MAGIC), file);
+
+		Write(file, sourceSize);
+		Write(file, sourceTime);
+
+		Write(file, config.packedMesh);
+		Write(file, config.netMass);
+		Write(file, config.type);
+		Write(file, config.resource);
+
+		Write(file, config.unpackingType);
+		Write(file, config.spawnCount);
+		Write(file, config.breathable);
+		Write(file, config.unpackedHeight);
+
+		Write(file, config.unpackedMesh);
+		Write(file, config.unpackedSize);
+		Write(file, config.resourceContainerMass);
+		Write(file, config.unpackedAttachPos);
+		Write(file, config.unpackedPMI);
+		Write(file, config.unpackedCS);
+
+		Write(file, config.spawnName);
+		Write(file, config.spawnModule);
+		Write(file, config.unpackingMode);
+		Write(file, config.unpackingDelay);
+
+		bool written = !ferror(file);
+
+		return !fclose(file) && written;
+	}
+
+	// Reads the compiled configuration of the configuration name.
+	// Returns false if it isn't found, it's invalid, or its configuration file was changed after it was compiled
+	inline bool ReadCompiledConfig(const std::string& configName, CargoConfig& config)
+	{
+		using namespace CompiledConfig;
+
+		int64_t sourceSize, sourceTime;
+
+		if (!GetFileStamp(GetConfigPath(configName), sourceSize, sourceTime)) return false;
+
+		FILE* file = fopen(GetCompiledConfigPath(configName).c_str(), "rb");
+
+		if (!file) return false;
+
+		char magic[sizeof(COMPILED_CONFIG_MAGIC)];
+		int64_t compiledSize, compiledTime;
+
+		CargoConfig compiledConfig;
+
+		bool read = fread(magic, 1, sizeof(magic), file) == sizeof(magic) && !memcmp(magic, COMPILED_CONFIG_MAGIC, sizeof(magic)) &&
+			Read(file, compiledSize) && Read(file, compiledTime) && compiledSize == sourceSize && compiledTime == sourceTime &&
+			Read(file, compiledConfig.packedMesh) && Read(file, compiledConfig.netMass) && Read(file, compiledConfig.type) &&
+			Read(file, compiledConfig.resource) && Read(file, compiledConfig.unpackingType) && Read(file, compiledConfig.spawnCount) &&
+			Read(file, compiledConfig.breathable) && Read(file, compiledConfig.unpackedHeight) && Read(file, compiledConfig.unpackedMesh) &&
+			Read(file, compiledConfig.unpackedSize) && Read(file, compiledConfig.resourceContainerMass) &&
+			Read(file, compiledConfig.unpackedAttachPos) && Read(file, compiledConfig.unpackedPMI) && Read(file, compiledConfig.unpackedCS) &&
+			Read(file, compiledConfig.spawnName) && Read(file, compiledConfig.spawnModule) && Read(file, compiledConfig.unpackingMode) &&
+			Read(file, compiledConfig.unpackingDelay);
+
+		fclose(file);
+
+		if (read) config = compiledConfig;
+
+		return read;
+	}
+}
@@ -0,0 +1,143 @@
+// =======================================================================================
+// CargoRuntime.cpp : The process runtime's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include <algorithm>
+
+#include "CargoRuntime.h"
+
+// The cargo DLL's exports, which are defined with the cargo class
+DLLCLBK const char* GetUCSOVersion();
+DLLCLBK UCSO::TraceFunction GetUCSOTraceFunction();
+DLLCLBK bool FlushUCSOTrace();
+DLLCLBK UCSO::RuntimeStatistics* GetUCSORuntimeStatistics();
+DLLCLBK bool GetUCSODrainUnpackedResources();
+DLLCLBK double GetUCSOContainerMass();
+
+DLLCLBK UCSO::SharedRuntime* AcquireUCSORuntime() { return UCSO::CargoRuntime::Acquire(); }
+
+DLLCLBK void ReleaseUCSORuntime() { UCSO::CargoRuntime::Release(); }
+
+UCSO::CargoRuntime* UCSO::CargoRuntime::instance = nullptr;
+int UCSO::CargoRuntime::refCount = 0;
+std::mutex UCSO::CargoRuntime::instanceMutex;
+
+UCSO::SharedRuntime* UCSO::CargoRuntime::Acquire()
+{
+	std::lock_guard<std::mutex> lock(instanceMutex);
+
+	if (!instance) instance = new CargoRuntime();
+
+	refCount++;
+
+	return instance;
+}
+
+void UCSO::CargoRuntime::Release()
+{
+	std::lock_guard<std::mutex> lock(instanceMutex);
+
+	// If another module still has the runtime
+	if (--refCount > 0) return;
+
+	delete instance;
+	instance = nullptr;
+}
+
+UCSO::CargoRuntime::CargoRuntime()
+{
+	version = GetUCSOVersion();
+
+	// Load custom cargo DLL
+	customCargoDll = LoadLibraryA("Modules/UCSO/CustomCargo.dll");
+
+	if (customCargoDll) GetCustomCargo = reinterpret_cast<CustomCargoFunction>(GetProcAddress(customCargoDll, "GetCustomCargo"));
+
+	// If the DLL isn't loaded or the function couldn't be found
+	if (!GetCustomCargo)
+	{
+		if (customCargoDll) FreeLibrary(customCargoDll);
+		customCargoDll = nullptr;
+
+		oapiWriteLog("UCSO API Warning: Couldn't load the custom cargo API");
+
+		version = nullptr;
+	}
+
+	// Set the available cargo list if UCSO is installed
+	if (version) cargoCatalog.Init();
+}
+
+UCSO::CargoRuntime::~CargoRuntime() { if (customCargoDll) FreeLibrary(customCargoDll); }
+
+UCSO::RuntimeStatistics* UCSO::CargoRuntime::GetStatistics() { return GetUCSORuntimeStatistics(); }
+
+// The settings are read by the cargo class, so the cargoes and the vessels' API use the same values
+bool UCSO::CargoRuntime::GetDrainUnpackedResources() { return GetUCSODrainUnpackedResources(); }
+
+double UCSO::CargoRuntime::GetContainerMass() { return GetUCSOContainerMass(); }
+
+UCSO::TraceFunction UCSO::CargoRuntime::GetTraceFunction() { return GetUCSOTraceFunction(); }
+
+bool UCSO::CargoRuntime::FlushTrace() { return FlushUCSOTrace(); }
+
+std::shared_ptr<const UCSO::CargoCatalog::Snapshot> UCSO::CargoRuntime::UpdateCargoCatalog()
+{
+	// The modules may update the catalog from their own threads, and the watcher has one pending request
+	std::lock_guard<std::mutex> lock(catalogMutex);
+
+	return cargoCatalog.Update();
+}
+
+void UCSO::CargoRuntime::RegisterVessel(Vessel* vessel, OBJHANDLE hVessel, int interfaceVersion)
+{
+	auto it = std::find_if(vesselList.begin(), vesselList.end(), [vessel](const RegisteredVessel& entry) { return entry.vessel == vessel; });
+
+	// If the instance is removed
+	if (!interfaceVersion)
+	{
+		if (it != vesselList.end()) vesselList.erase(it);
+		return;
+	}
+
+	if (it != vesselList.end()) *it = { vessel, hVessel, interfaceVersion };
+	else vesselList.push_back({ vessel, hVessel, interfaceVersion });
+}
+
+int UCSO::CargoRuntime::GetInterfaceVersion(Vessel* vessel)
+{
+	for (const RegisteredVessel& entry : vesselList) if (entry.vessel == vessel) return entry.interfaceVersion;
+
+	return 0;
+}
+
+UCSO::Vessel* UCSO::CargoRuntime::GetRegisteredVessel(OBJHANDLE hVessel)
+{
+	for (const RegisteredVessel& entry : vesselList) if (entry.hVessel == hVessel) return entry.vessel;
+
+	return nullptr;
+}
+
+OBJHANDLE UCSO::CargoRuntime::GetRegisteredHandle(Vessel* vessel)
+{
+	for (const RegisteredVessel& entry : vesselList) if (entry.vessel == vessel) return entry.hVessel;
+
+	return nullptr;
+}
@@ -0,0 +1,73 @@
+// =======================================================================================
+// CargoRuntime.h : The process runtime, which the cargo DLL shares with all modules' API instances.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include "..\API\SharedRuntime.h"
+
+namespace UCSO
+{
+	// Loads the custom cargo DLL and reads the available cargoes once for the whole process.
+	// It's created by the first module which acquires it and deleted with the last one.
+	class CargoRuntime : public SharedRuntime
+	{
+	public:
+		static SharedRuntime* Acquire();
+		static void Release();
+
+		const char* GetVersion() override { return version; }
+		CustomCargoFunction GetCustomCargoFunction() override { return GetCustomCargo; }
+		RuntimeStatistics* GetStatistics() override;
+		TraceFunction GetTraceFunction() override;
+		bool FlushTrace() override;
+		bool GetDrainUnpackedResources() override;
+		double GetContainerMass() override;
+
+		std::shared_ptr<const CargoCatalog::Snapshot> GetCargoSnapshot() override { return cargoCatalog.GetSnapshot(); }
+		std::shared_ptr<const CargoCatalog::Snapshot> UpdateCargoCatalog() override;
+
+		void RegisterVessel(Vessel* vessel, OBJHANDLE hVessel, int interfaceVersion) override;
+		int GetInterfaceVersion(Vessel* vessel) override;
+		Vessel* GetRegisteredVessel(OBJHANDLE hVessel) override;
+		OBJHANDLE GetRegisteredHandle(Vessel* vessel) override;
+
+	private:
+		struct RegisteredVessel
+		{
+			Vessel* vessel;
+			OBJHANDLE hVessel;
+			int interfaceVersion;
+		};
+
+		const char* version = nullptr;
+		CustomCargoFunction GetCustomCargo = nullptr;
+		HINSTANCE customCargoDll = nullptr;
+		CargoCatalog cargoCatalog;
+		std::mutex catalogMutex;
+		std::vector<RegisteredVessel> vesselList;
+
+		static CargoRuntime* instance;
+		static int refCount;
+		static std::mutex instanceMutex;
+
+		CargoRuntime();
+		~CargoRuntime();
+	};
+}
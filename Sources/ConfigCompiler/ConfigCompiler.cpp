@@ -0,0 +1,270 @@
+// =======================================================================================
+// ConfigCompiler.cpp : Checks the cargo configuration files and compiles them for the cargo DLL.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include "..\Cargo\CargoConfig.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+	namespace fs = std::filesystem;
+
+	using UCSO::CargoConfig;
+
+	struct Options
+	{
+		std::string orbiterDir = ".";
+		unsigned int threadCount = 0;
+		bool check = false;
+	};
+
+	// The result of a configuration file. The errors make the cargo DLL fail to load the class, and the warnings don't
+	struct ConfigResult
+	{
+		std::string configName;
+		bool cargo = false;
+		bool compiled = false;
+		std::vector<std::string> errors;
+		std::vector<std::string> warnings;
+	};
+
+	class Compiler
+	{
+	public:
+		Compiler(const Options& options) : options(options) { }
+
+		bool Compile()
+		{
+			std::error_code error;
+
+			// The configuration paths are relative to the Orbiter directory, as in the cargo DLL
+			fs::current_path(options.orbiterDir, error);
+
+			if (error) { fprintf(stderr, "Couldn't open the Orbiter directory %s\n", options.orbiterDir.c_str()); return false; }
+
+			if (!FindConfigs()) { fprintf(stderr, "Couldn't find Config/Vessels/UCSO in %s\n", options.orbiterDir.c_str()); return false; }
+
+			results.resize(configNames.size());
+
+			unsigned int threadCount = options.threadCount ? options.threadCount : std::max(1u, std::thread::hardware_concurrency());
+			threadCount = std::min(threadCount, std::max(1u, static_cast<unsigned int>(configNames.size())));
+
+			// Each thread takes the next configuration file until all are done
+			std::vector<std::thread> threads;
+
+			for (unsigned int thread = 0; thread < threadCount; thread++) threads.emplace_back([this]() { CompileConfigs(); });
+
+			for (std::thread& thread : threads) thread.join();
+
+			return PrintResults();
+		}
+
+	private:
+		const Options& options;
+
+		std::vector<std::string> configNames;
+		std::vector<ConfigResult> results;
+		std::atomic<size_t> nextConfig{ 0 };
+
+		bool FindConfigs()
+		{
+			std::error_code error;
+			fs::recursive_directory_iterator configIt("Config/Vessels/UCSO", error);
+
+			if (error) return false;
+
+			for (const fs::directory_entry& entry : configIt)
+			{
+				if (!entry.is_regular_file() || entry.path().extension() != ".cfg") continue;
+
+				// The configuration name is the class name without UCSO/, with the same separators as the cargo DLL
+				fs::path configPath = entry.path().lexically_relative("Config/Vessels/UCSO");
+				configPath.replace_extension();
+
+				configNames.push_back(configPath.generic_string());
+			}
+
+			// Sort the names, so the results are printed in the same order every time
+			std::sort(configNames.begin(), configNames.end());
+
+			return true;
+		}
+
+		void CompileConfigs()
+		{
+			for (size_t index = nextConfig++; index < configNames.size(); index = nextConfig++) CompileConfig(configNames[index], results[index]);
+		}
+
+		void CompileConfig(const std::string& configName, ConfigResult& result)
+		{
+			result.configName = configName;
+
+			std::string configPath = UCSO::GetConfigPath(configName);
+
+			UCSO::TextConfigReader reader;
+
+			if (!reader.Parse(configPath)) { result.errors.push_back("The file couldn't be opened"); return; }
+
+			// If the file isn't a UCSO cargo, such as a custom cargo, which is loaded by its own module
+			std::string module;
+
+			if (!reader.ReadString("Module", module) || !UCSO::IsCargoModule(module)) return;
+
+			result.cargo = true;
+
+			CargoConfig config;
+			std::vector<std::string> missingItems;
+
+			ReadCargoConfig(reader, config, missingItems);
+
+			for (const std::string& item : missingItems) result.errors.push_back("The cargo " + item + " is missing");
+
+			CheckConfig(config, result);
+
+			if (!result.errors.empty() || options.check) return;
+
+			int64_t sourceSize, sourceTime;
+
+			if (!UCSO::GetFileStamp(configPath, sourceSize, sourceTime)) { result.errors.push_back("The file stamp couldn't be read"); return; }
+
+			std::string compiledPath = UCSO::GetCompiledConfigPath(configName);
+
+			std::error_code error;
+			fs::create_directories(fs::path(compiledPath).parent_path(), error);
+
+			if (!UCSO::WriteCompiledConfig(compiledPath, config, sourceSize, sourceTime))
+			{
+				result.errors.push_back("The compiled file " + compiledPath + " couldn't be written");
+				return;
+			}
+
+			result.compiled = true;
+		}
+
+		// Checks the values which are read as numbers but used as types and modes, and the files which Orbiter loads later
+		static void CheckConfig(const CargoConfig& config, ConfigResult& result)
+		{
+			if (config.type < CargoConfig::STATIC || config.type > CargoConfig::UNPACKABLE_ONLY)
+			{
+				// If the type isn't missing, as it's reported already
+				if (config.type != -1) result.errors.push_back("The cargo type " + std::to_string(config.type) + " is invalid");
+				return;
+			}
+
+			CheckMesh(config.packedMesh, result);
+
+			if (config.type == CargoConfig::STATIC || config.type == CargoConfig::RESOURCE) return;
+
+			switch (config.unpackingType)
+			{
+			case CargoConfig::UCSO_RESOURCE:
+			case CargoConfig::UCSO_MODULE:
+				CheckMesh(config.unpackedMesh, result);
+
+				if (config.unpackedSize <= 0) result.warnings.push_back("The unpacked size isn't positive");
+
+				break;
+			case CargoConfig::ORBITER_VESSEL:
+				if (!config.spawnModule.empty() && !fs::exists("Config/Vessels/" + config.spawnModule + ".cfg") &&
+					!fs::exists("Config/" + config.spawnModule + ".cfg"))
+					result.warnings.push_back("The spawn module " + config.spawnModule + " isn't found");
+
+				if (config.unpackingMode < CargoConfig::LANDING || config.unpackingMode > CargoConfig::MANUAL)
+				{
+					if (config.unpackingMode != -1) result.errors.push_back("The unpacking mode " + std::to_string(config.unpackingMode) + " is invalid");
+				}
+				else if (config.unpackingMode == CargoConfig::DELAYING && config.unpackingDelay <= 0)
+					result.warnings.push_back("The unpacking delay isn't positive");
+
+				break;
+			default:
+				if (config.unpackingType != -1) result.errors.push_back("The unpacking type " + std::to_string(config.unpackingType) + " is invalid");
+
+				break;
+			}
+
+			if (config.type == CargoConfig::UNPACKABLE_ONLY && config.spawnCount < 1) result.warnings.push_back("The spawn count is less than 1");
+		}
+
+		static void CheckMesh(const std::string& mesh, ConfigResult& result)
+		{
+			if (!mesh.empty() && !fs::exists("Meshes/" + mesh + ".msh")) result.warnings.push_back("The mesh " + mesh + " isn't found");
+		}
+
+		// Prints the problems of all files at once. Returns false if any file has an error
+		bool PrintResults() const
+		{
+			int cargoCount = 0, compiledCount = 0, errorCount = 0, warningCount = 0;
+
+			for (const ConfigResult& result : results)
+			{
+				if (result.cargo) cargoCount++;
+				if (result.compiled) compiledCount++;
+
+				errorCount += int(result.errors.size());
+				warningCount += int(result.warnings.size());
+
+				for (const std::string& error : result.errors) printf("%s: Error: %s\n", result.configName.c_str(), error.c_str());
+
+				for (const std::string& warning : result.warnings) printf("%s: Warning: %s\n", result.configName.c_str(), warning.c_str());
+			}
+
+			printf("%d cargo files checked, %d compiled, %d errors, %d warnings\n", cargoCount, compiledCount, errorCount, warningCount);
+
+			return !errorCount;
+		}
+	};
+
+	void PrintUsage()
+	{
+		printf("Usage: ConfigCompiler [options] [Orbiter directory]\n");
+		printf("Checks the cargo configuration files in Config/Vessels/UCSO and compiles them to Config/UCSO_Compiled.\n");
+		printf("The files with errors aren't compiled, so the cargo DLL reads them as usual. The default directory is the current one.\n");
+		printf("  -check             Only check the files, without compiling them.\n");
+		printf("  -threads <count>   The files checked at the same time. The default is the processor count.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	bool hasDir = false;
+
+	for (int arg = 1; arg < argc; arg++)
+	{
+		// If the option has a value
+		bool hasValue = arg + 1 < argc;
+
+		if (!strcmp(argv[arg], "-check")) options.check = true;
+		else if (!strcmp(argv[arg], "-threads") && hasValue) options.threadCount = strtoul(argv[++arg], nullptr, 10);
+		else if (argv[arg][0] != '-' && !hasDir) { options.orbiterDir = argv[arg]; hasDir = true; }
+		else { PrintUsage(); return 1; }
+	}
+
+	return Compiler(options).Compile() ? 0 : 1;
+}
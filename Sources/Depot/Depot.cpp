@@ -0,0 +1,215 @@
+// =======================================================================================
+// Depot.cpp : The depot vessel's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+
+#include "Depot.h"
+#include <sstream>
+#include <limits>
+
+DLLCLBK VESSEL* ovcInit(OBJHANDLE hvessel, int flightmodel) { return new UCSO::Depot(hvessel, flightmodel); }
+
+DLLCLBK void ovcExit(VESSEL* vessel) { if (vessel) delete static_cast<UCSO::Depot*>(vessel); }
+
+UCSO::Depot::Depot(OBJHANDLE hObj, int fmodel) : VESSEL4(hObj, fmodel) { }
+
+void UCSO::Depot::clbkSetClassCaps(FILEHANDLE cfg)
+{
+	// The attachment which identifies the vessel as a depot for the vessels' API
+	CreateAttachment(true, { 0, -0.65, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, "UCSO_DP");
+
+	double stiffness = GetMass() * G * 1000;
+	double damping = 0.9 * (2 * sqrt(GetMass() * stiffness));
+
+	// Values are pre-set for 1.3m size, as the cargo
+	TOUCHDOWNVTX tdvtx[4] =
+	{
+	{{ 1.3, -0.65, -0.012 }, stiffness, damping, 3, 3},
+	{{ 0, -0.65, 0.65 }, stiffness, damping, 3, 3},
+	{{ -1.3, -0.65, -0.012 }, stiffness, damping, 3, 3},
+	{{ 0, 19.5, 0 }, stiffness, damping, 3, 3}
+	};
+
+	SetTouchdownPoints(tdvtx, 4);
+}
+
+void UCSO::Depot::clbkLoadStateEx(FILEHANDLE scn, void* status)
+{
+	char* line;
+
+	while (oapiReadScenario_nextline(scn, line))
+	{
+		std::istringstream ss;
+		ss.str(line);
+		std::string data;
+
+		if (ss >> data && data == "DepotCargo")
+		{
+			int count;
+			CargoRecord record;
+
+			ss >> count >> record.className;
+
+			if (!ReadCargoRecord(ss, record))
+			{
+				oapiWriteLog("UCSO Warning: Couldn't load a depot cargo from the scenario");
+				continue;
+			}
+
+			for (int index = 0; index < count; index++) StoreCargo(record);
+		}
+		else ParseScenarioLineEx(line, status);
+	}
+}
+
+void UCSO::Depot::clbkSaveState(FILEHANDLE scn)
+{
+	// Set the default state
+	VESSEL4::clbkSaveState(scn);
+
+	// Group the identical cargoes in one line, as the names aren't saved
+	std::map<std::string, int> cargoLines;
+
+	for (auto const& cargo : cargoMap)
+	{
+		std::ostringstream ss;
+		ss.precision(12);
+
+		ss << cargo.second.className << ' ';
+		WriteCargoRecord(ss, cargo.second);
+
+		cargoLines[ss.str()]++;
+	}
+
+	for (auto const& cargoLine : cargoLines)
+	{
+		std::string line = std::to_string(cargoLine.second) + ' ' + cargoLine.first;
+
+		oapiWriteScenario_string(scn, "DepotCargo", &line[0]);
+	}
+}
+
+int UCSO::Depot::GetCargoCount(const char* cargoName, const char* resource, double maxMass)
+{
+	const std::set<CargoKey>& index = GetIndex(cargoName, resource);
+
+	// If only one index is used, all its cargoes match, so only the mass is checked
+	if (!(cargoName && *cargoName && resource && *resource))
+	{
+		if (maxMass < 0) return index.size();
+
+		return std::distance(index.begin(), index.upper_bound(CargoKey(maxMass, std::numeric_limits<int>::max())));
+	}
+
+	int count = 0;
+
+	// The index is sorted by the mass, so the cargoes after the maximum mass aren't checked
+	for (const CargoKey& key : index)
+	{
+		if (maxMass >= 0 && key.first > maxMass) break;
+
+		if (MatchCargo(cargoMap[key.second], cargoName, resource)) count++;
+	}
+
+	return count;
+}
+
+bool UCSO::Depot::TakeCargo(const char* cargoName, const char* resource, double maxMass, CargoRecord& record)
+{
+	const std::set<CargoKey>& index = GetIndex(cargoName, resource);
+
+	std::set<CargoKey>::const_iterator it = index.begin();
+
+	// The index is sorted by the mass, so the first matching cargo is the lightest
+	while (it != index.end() && !MatchCargo(cargoMap[it->second], cargoName, resource)) it++;
+
+	if (it == index.end() || (maxMass >= 0 && it->first > maxMass)) return false;
+
+	// Copy the key, as the iterator is invalidated when the key is removed from its index
+	CargoKey key = *it;
+
+	record = cargoMap[key.second];
+
+	// Remove the cargo from the indexes, and remove the empty indexes
+	std::string name = GetCargoName(record.className);
+
+	nameIndex[name].erase(key);
+	if (nameIndex[name].empty()) nameIndex.erase(name);
+
+	if (!record.dataStruct.resource.empty())
+	{
+		resourceIndex[record.dataStruct.resource].erase(key);
+		if (resourceIndex[record.dataStruct.resource].empty()) resourceIndex.erase(record.dataStruct.resource);
+	}
+
+	massIndex.erase(key);
+
+	cargoMap.erase(key.second);
+
+	return true;
+}
+
+void UCSO::Depot::StoreCargo(const CargoRecord& record)
+{
+	CargoKey key(record.mass, nextId++);
+
+	cargoMap[key.second] = record;
+
+	nameIndex[GetCargoName(record.className)].insert(key);
+	if (!record.dataStruct.resource.empty()) resourceIndex[record.dataStruct.resource].insert(key);
+	massIndex.insert(key);
+}
+
+std::string UCSO::Depot::GetCargoName(const std::string& className)
+{
+	// Remove UCSO/ from the class name
+	if (className.size() > 5 && className.compare(0, 4, "UCSO") == 0) return className.substr(5);
+
+	return className;
+}
+
+const std::set<UCSO::Depot::CargoKey>& UCSO::Depot::GetIndex(const char* cargoName, const char* resource)
+{
+	static const std::set<CargoKey> emptyIndex;
+
+	// Use the name index if the name is set, as it's narrower than the resource index
+	if (cargoName && *cargoName)
+	{
+		auto it = nameIndex.find(cargoName);
+		return it != nameIndex.end() ? it->second : emptyIndex;
+	}
+
+	if (resource && *resource)
+	{
+		auto it = resourceIndex.find(resource);
+		return it != resourceIndex.end() ? it->second : emptyIndex;
+	}
+
+	return massIndex;
+}
+
+bool UCSO::Depot::MatchCargo(const CargoRecord& record, const char* cargoName, const char* resource)
+{
+	if (cargoName && *cargoName && GetCargoName(record.className) != cargoName) return false;
+
+	if (resource && *resource && record.dataStruct.resource != resource) return false;
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// =======================================================================================
+// Depot.h : The depot vessel's header.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+
+#pragma once
+#include "..\API\Helper.h"
+#include <map>
+#include <set>
+
+namespace UCSO
+{
+	class Depot : public VESSEL4
+	{
+	public:
+		Depot(OBJHANDLE hObj, int fmodel);
+
+		void clbkSetClassCaps(FILEHANDLE cfg) override;
+		void clbkLoadStateEx(FILEHANDLE scn, void* status) override;
+		void clbkSaveState(FILEHANDLE scn) override;
+
+		// Returns the count of the stored cargoes which match the cargo name (the class name without UCSO/), the resource, and the maximum mass.
+		// Pass nullptr to the name or the resource, or -1 to the mass to match any.
+		virtual int GetCargoCount(const char* cargoName, const char* resource, double maxMass);
+
+		// Removes the lightest stored cargo which matches the cargo name, the resource, and the maximum mass from the inventory.
+		// Returns true and sets the record if a cargo is found, false otherwise.
+		virtual bool TakeCargo(const char* cargoName, const char* resource, double maxMass, CargoRecord& record);
+
+		// Adds the cargo record to the inventory.
+		virtual void StoreCargo(const CargoRecord& record);
+
+	private:
+		typedef std::pair<double, int> CargoKey; // The cargo mass and ID, so the indexes are sorted by the mass
+
+		std::map<int, CargoRecord> cargoMap; // The stored cargoes by their IDs
+		int nextId = 0;
+
+		// The cargo keys indexed by the cargo name and the resource, and the keys of all cargoes
+		std::map<std::string, std::set<CargoKey>> nameIndex;
+		std::map<std::string, std::set<CargoKey>> resourceIndex;
+		std::set<CargoKey> massIndex;
+
+		static std::string GetCargoName(const std::string& className);
+
+		const std::set<CargoKey>& GetIndex(const char* cargoName, const char* resource);
+		bool MatchCargo(const CargoRecord& record, const char* cargoName, const char* resource);
+	};
+}
\ No newline at end of file
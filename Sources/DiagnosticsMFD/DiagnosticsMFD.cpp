@@ -0,0 +1,140 @@
+// =======================================================================================
+// DiagnosticsMFD.cpp : The diagnostics MFD's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#define ORBITER_MODULE
+
+#include "DiagnosticsMFD.h"
+#include <cstdio>
+#include <cstring>
+
+int UCSO::DiagnosticsMFD::openCount = 0;
+
+int mfdMode = 0;
+
+DLLCLBK void InitModule(HINSTANCE hDLL)
+{
+	static char name[] = "UCSO Diagnostics";
+
+	MFDMODESPECEX spec;
+	spec.name = name;
+	spec.key = OAPI_KEY_U;
+	spec.context = nullptr;
+	spec.msgproc = UCSO::DiagnosticsMFD::MsgProc;
+
+	mfdMode = oapiRegisterMFDMode(spec);
+}
+
+DLLCLBK void ExitModule(HINSTANCE hDLL) { oapiUnregisterMFDMode(mfdMode); }
+
+UCSO::DiagnosticsMFD::DiagnosticsMFD(DWORD w, DWORD h, VESSEL* vessel) : MFD2(w, h, vessel)
+{
+	runtime = GetRuntimeStatistics();
+
+	if (!runtime) oapiWriteLog("UCSO Warning: Couldn't load the runtime figures for the diagnostics MFD");
+
+	openCount++;
+
+	if (runtime) runtime->timing = true;
+}
+
+UCSO::DiagnosticsMFD::~DiagnosticsMFD()
+{
+	openCount--;
+
+	// Disable the timing if this is the last open diagnostics MFD
+	if (runtime && !openCount) runtime->timing = false;
+}
+
+bool UCSO::DiagnosticsMFD::Update(oapi::Sketchpad* skp)
+{
+	Title(skp, "UCSO Diagnostics");
+
+	int x = W / 24;
+	int y = H / 8;
+	int lineHeight = H / 16;
+
+	char line[64];
+
+	// Draws the line and moves to the next one
+	auto DrawLine = [&]()
+	{
+		skp->Text(x, y, line, int(strlen(line)));
+		y += lineHeight;
+	};
+
+	if (!runtime)
+	{
+		strcpy(line, "UCSO isn't installed");
+		DrawLine();
+
+		return true;
+	}
+
+	skp->SetTextColor(0x00FF00);
+
+	sprintf(line, "Carriers: %d  Slots: %d", runtime->carrierCount, runtime->slotCount);
+	DrawLine();
+
+	sprintf(line, "Static: %d  Resource: %d", runtime->cargoCount[0], runtime->cargoCount[1]);
+	DrawLine();
+
+	sprintf(line, "Packable: %d  Unpackable: %d", runtime->cargoCount[2], runtime->cargoCount[3]);
+	DrawLine();
+
+	sprintf(line, "Custom: %d", runtime->customCargoCount);
+	DrawLine();
+
+	sprintf(line, "Awake: %d  Settled: %d", runtime->awakeCount, runtime->settledCount);
+	DrawLine();
+
+	y += lineHeight;
+
+	sprintf(line, "Frame time: %.1f us", runtime->frameTime);
+	DrawLine();
+
+	if (runtime->slowestCall[0]) sprintf(line, "Slowest call: %s", runtime->slowestCall);
+	else strcpy(line, "Slowest call: None");
+	DrawLine();
+
+	sprintf(line, "Its time: %.1f us", runtime->slowestCallTime);
+	DrawLine();
+
+	y += lineHeight;
+
+	int lookups = runtime->meshCacheHits + runtime->meshCacheMisses;
+
+	if (lookups) sprintf(line, "Mesh cache hits: %.1f%% of %d", runtime->meshCacheHits * 100.0 / lookups, lookups);
+	else strcpy(line, "Mesh cache hits: No lookups");
+	DrawLine();
+
+	return true;
+}
+
+int UCSO::DiagnosticsMFD::MsgProc(UINT msg, UINT mfd, WPARAM wparam, LPARAM lparam)
+{
+	switch (msg)
+	{
+	case OAPI_MSG_MFD_OPENED:
+		return int(new DiagnosticsMFD(LOWORD(wparam), HIWORD(wparam), reinterpret_cast<VESSEL*>(lparam)));
+	}
+
+	return 0;
+}
@@ -0,0 +1,43 @@
+// =======================================================================================
+// DiagnosticsMFD.h : The diagnostics MFD's header.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include "..\API\Runtime.h"
+
+namespace UCSO
+{
+	// Shows the live runtime figures of UCSO. The API call and the frame times are measured only while a diagnostics MFD is open
+	class DiagnosticsMFD : public MFD2
+	{
+	public:
+		DiagnosticsMFD(DWORD w, DWORD h, VESSEL* vessel);
+		~DiagnosticsMFD();
+
+		bool Update(oapi::Sketchpad* skp) override;
+
+		static int MsgProc(UINT msg, UINT mfd, WPARAM wparam, LPARAM lparam);
+
+	private:
+		RuntimeStatistics* runtime;
+
+		static int openCount; // The open diagnostics MFDs, to keep the timing enabled while any of them is open
+	};
+}
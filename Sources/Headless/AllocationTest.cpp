@@ -0,0 +1,152 @@
+// =======================================================================================
+// AllocationTest.cpp : Checks that the steady-state API calls and the cargo steps don't allocate memory.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: AllocationTest [-root <Orbiter folder>]
+// The carrier holds a fuel cargo next to an unpacked life module. After a warm-up, the resource, mass, and breathable calls
+// and the simulation steps are repeated, and every allocation of the process is counted. The test fails if any is made.
+// It also checks that the API statistics count the allocations of a ground release next to a cargo, which uses the counted containers.
+
+#include "Carrier.h"
+#include "Allocations.h"
+#include <unistd.h>
+
+namespace
+{
+	const double STEP = 0.02;
+	const int WARM_UP_ITERATIONS = 10;
+	const int ITERATIONS = 100;
+
+	bool RunTest()
+	{
+		OBJHANDLE hCarrier = Headless::CreateLandedVessel("Carrier", "HeadlessCarrier", 0, 0, 2);
+
+		if (!hCarrier)
+		{
+			fprintf(stderr, "Couldn't create the carrier. Check that the root folder has the HeadlessCarrier configuration\n");
+			return false;
+		}
+
+		UCSO::Vessel* ucso = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hCarrier))->ucso;
+
+		if (!ucso->GetUCSOVersion())
+		{
+			fprintf(stderr, "UCSO isn't installed in the root folder\n");
+			return false;
+		}
+
+		Headless::CreateLandedVessel("Fuel", "UCSO\\CargoFuel", 0, 15, 0.65);
+		Headless::CreateLandedVessel("LifeModule", "UCSO\\CargoLifeModule", 3, 0, 0.65);
+		Headless::Step(STEP);
+
+		// Unpack the life module, so the breathable search finds it
+		if (!ucso->UnpackCargo())
+		{
+			fprintf(stderr, "Couldn't unpack the life module\n");
+			return false;
+		}
+
+		Headless::Step(STEP);
+
+		if (ucso->GrappleCargo(0) != UCSO::Vessel::GRAPPLE_SUCCEEDED)
+		{
+			fprintf(stderr, "Couldn't grapple the fuel cargo\n");
+			return false;
+		}
+
+		Headless::Step(STEP);
+
+		long long allocationCount = 0;
+		bool breathable = true;
+
+		for (int iteration = 0; iteration < WARM_UP_ITERATIONS + ITERATIONS; iteration++)
+		{
+			if (iteration == WARM_UP_ITERATIONS) allocationCount = Headless::GetAllocationCount();
+
+			ucso->GetCargoMass(0);
+			ucso->GetTotalCargoMass();
+			ucso->GetAvailableCargoCount();
+			ucso->DrainCargoResource("fuel", 0.001, 0);
+			ucso->DrainStationOrUnpackedResource("fuel", 0.001);
+			breathable &= ucso->GetNearestBreathableCargo() != nullptr;
+
+			Headless::Step(STEP);
+		}
+
+		allocationCount = Headless::GetAllocationCount() - allocationCount;
+
+		printf("Steady-state allocations in %d iterations: %lld\n", ITERATIONS, allocationCount);
+
+		if (!breathable)
+		{
+			fprintf(stderr, "The breathable cargo wasn't found, so the searches didn't run as expected\n");
+			return false;
+		}
+
+		// Release the fuel cargo and add another one, so the next ground release lists the fuel cargo position
+		bool released = ucso->ReleaseCargo(0) == UCSO::Vessel::RELEASE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		bool added = ucso->AddCargo(0, 0) == UCSO::Vessel::GRAPPLE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		ucso->SetStatistics(true);
+
+		released &= ucso->ReleaseCargo(0) == UCSO::Vessel::RELEASE_SUCCEEDED;
+		int releaseAllocations = ucso->GetStatistics(UCSO::Vessel::RELEASE_CARGO_METHOD).allocationCount;
+
+		printf("Counted allocations of the ground release: %d\n", releaseAllocations);
+
+		if (!released || !added || releaseAllocations == 0)
+		{
+			fprintf(stderr, "The ground releases failed, or the statistics didn't count their allocations\n");
+			return false;
+		}
+
+		return allocationCount == 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+
+	if (argc == 3 && !strcmp(argv[1], "-root")) root = argv[2];
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: AllocationTest [-root <Orbiter folder>]\n");
+		return 1;
+	}
+
+	// The modules and the configuration files are found from the Orbiter folder, as in Orbiter
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	Headless::Carrier::Register();
+
+	bool succeeded = RunTest();
+
+	Headless::CloseSimulation();
+
+	return succeeded ? 0 : 1;
+}
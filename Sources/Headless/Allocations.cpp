@@ -0,0 +1,79 @@
+// =======================================================================================
+// Allocations.cpp : The malloc replacement which counts the process allocations.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include "Allocations.h"
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+
+// The glibc allocator, which the replacement forwards to
+extern "C"
+{
+	void* __libc_malloc(size_t size);
+	void* __libc_calloc(size_t count, size_t size);
+	void* __libc_realloc(void* memory, size_t size);
+	void* __libc_memalign(size_t alignment, size_t size);
+	void __libc_free(void* memory);
+}
+
+namespace
+{
+	std::atomic<long long> allocationCount(0);
+
+	inline void CountAllocation() { allocationCount.fetch_add(1, std::memory_order_relaxed); }
+}
+
+long long Headless::GetAllocationCount() { return allocationCount.load(std::memory_order_relaxed); }
+
+extern "C" void* malloc(size_t size)
+{
+	CountAllocation();
+	return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+	CountAllocation();
+	return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* memory, size_t size)
+{
+	// Shrinking or freeing isn't an allocation
+	if (!memory || size) CountAllocation();
+	return __libc_realloc(memory, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size)
+{
+	CountAllocation();
+	return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** memory, size_t alignment, size_t size)
+{
+	CountAllocation();
+	*memory = __libc_memalign(alignment, size);
+
+	return *memory ? 0 : ENOMEM;
+}
+
+extern "C" void free(void* memory) { __libc_free(memory); }
@@ -0,0 +1,29 @@
+// =======================================================================================
+// Allocations.h : The process allocation counter of the headless benchmark and tests.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+
+namespace Headless
+{
+	// Returns the count of the heap allocations of all modules since the process started.
+	// Allocations.cpp replaces malloc in the executable, so the modules' allocations are counted too
+	long long GetAllocationCount();
+}
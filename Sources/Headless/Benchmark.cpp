@@ -0,0 +1,310 @@
+// =======================================================================================
+// Benchmark.cpp : Measures the VesselAPI methods which search the vessel list in the headless simulation.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: Benchmark [-root <Orbiter folder>] [-vessels <count>[,<count>...]] [-iterations <count>]
+// Every vessel count is measured in a new simulation with the carrier, a packed cargo next to it, an unpacked life module,
+// and filler cargoes between 2 and 4 km away, which are outside all the search ranges, so each search visits the whole vessel list.
+// Then every count is measured again as the count of the cargoes stored in a depot, for the depot inventory methods.
+// Last, a scenario with every count of mixed cargoes, a tenth as many carriers with an attached cargo, and a tenth as many cargoes
+// with a pending unpacking is made with the scenario generator, and its load and its first step are measured per loaded vessel.
+// The custom lamp cargoes of the scenario aren't loaded, as the sample isn't a part of the headless build.
+
+#include "Carrier.h"
+#include "Allocations.h"
+#include "../Depot/Depot.h"
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+	const double STEP = 0.02;
+
+	const char* fillerClasses[] = { "UCSO\\CargoContainer", "UCSO\\CargoFuel", "UCSO\\CargoSolarPanel", "UCSO\\CargoTableChairs" };
+	const char* depotResources[] = { "", "fuel", "", "oxygen" };
+
+	struct Measurement
+	{
+		const char* method;
+		int callCount = 0;
+		long long totalTime = 0;
+		long long allocationCount = 0;
+		int failureCount = 0;
+	};
+
+	template<typename Function>
+	void Measure(Measurement& measurement, Function function)
+	{
+		long long allocationCount = Headless::GetAllocationCount();
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		bool succeeded = function();
+
+		std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+		measurement.allocationCount += Headless::GetAllocationCount() - allocationCount;
+		measurement.totalTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+		measurement.callCount++;
+
+		if (!succeeded) measurement.failureCount++;
+	}
+
+	void PrintMeasurement(int count, const Measurement& measurement)
+	{
+		printf("%8d  %-32s %12.0f %16.1f", count, measurement.method,
+			double(measurement.totalTime) / measurement.callCount, double(measurement.allocationCount) / measurement.callCount);
+
+		if (measurement.failureCount) printf("  (%d of %d calls failed)", measurement.failureCount, measurement.callCount);
+
+		printf("\n");
+	}
+
+	bool RunBenchmark(int vesselCount, int iterations)
+	{
+		OBJHANDLE hCarrier = Headless::CreateLandedVessel("Carrier", "HeadlessCarrier", 0, 0, 2);
+
+		if (!hCarrier)
+		{
+			fprintf(stderr, "Couldn't create the carrier. Check that the root folder has the HeadlessCarrier configuration\n");
+			return false;
+		}
+
+		Headless::Carrier* carrier = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hCarrier));
+		UCSO::Vessel* ucso = carrier->ucso;
+
+		if (!ucso->GetUCSOVersion())
+		{
+			fprintf(stderr, "UCSO isn't installed in the root folder\n");
+			return false;
+		}
+
+		Headless::CreateLandedVessel("Cargo", "UCSO\\CargoContainer", 0, 15, 0.65);
+		Headless::CreateLandedVessel("LifeModule", "UCSO\\CargoLifeModule", 3, 0, 0.65);
+
+		for (int filler = 0; filler < vesselCount - 3; filler++)
+		{
+			// Spread the fillers on a disc with the golden angle
+			double angle = filler * 2.39996322972865332;
+			double distance = 2000 + 2000 * double(filler) / vesselCount;
+
+			std::string name = "Filler" + std::to_string(filler);
+			Headless::CreateLandedVessel(name.c_str(), fillerClasses[filler % 4], distance * cos(angle), distance * sin(angle), 0.65);
+		}
+
+		Headless::Step(STEP);
+
+		Measurement grapple, release, pack, drain, breathable;
+		grapple.method = "GrappleCargo";
+		release.method = "ReleaseCargo (ground)";
+		pack.method = "PackCargo";
+		drain.method = "DrainStationOrUnpackedResource";
+		breathable.method = "GetNearestBreathableCargo";
+
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			Measure(grapple, [&] { return ucso->GrappleCargo(0) == UCSO::Vessel::GRAPPLE_SUCCEEDED; });
+			Headless::Step(STEP);
+
+			Measure(release, [&] { return ucso->ReleaseCargo(0) == UCSO::Vessel::RELEASE_SUCCEEDED; });
+			Headless::Step(STEP);
+
+			// The life module is unpacked outside the measurement, so the other searches find a breathable cargo
+			ucso->UnpackCargo();
+			Headless::Step(STEP);
+
+			Measure(drain, [&] { ucso->DrainStationOrUnpackedResource("fuel", 1); return true; });
+			Measure(breathable, [&] { return ucso->GetNearestBreathableCargo() != nullptr; });
+
+			Measure(pack, [&] { return ucso->PackCargo(); });
+			Headless::Step(STEP);
+		}
+
+		for (const Measurement* measurement : { &grapple, &release, &pack, &drain, &breathable }) PrintMeasurement(vesselCount, *measurement);
+
+		return true;
+	}
+
+	bool RunDepotBenchmark(int cargoCount, int iterations)
+	{
+		OBJHANDLE hDepot = Headless::CreateLandedVessel("Depot", "CargoDepot", 0, 0, 0.65);
+
+		if (!hDepot)
+		{
+			fprintf(stderr, "Couldn't create the depot\n");
+			return false;
+		}
+
+		UCSO::Depot* depot = static_cast<UCSO::Depot*>(oapiGetVesselInterface(hDepot));
+
+		for (int cargo = 0; cargo < cargoCount; cargo++)
+		{
+			UCSO::CargoRecord record = { };
+			record.name = "Cargo" + std::to_string(cargo);
+			record.className = fillerClasses[cargo % 4];
+			record.dataStruct.resource = depotResources[cargo % 4];
+
+			// Spread the masses between 100 and 10100 kg, so the mass searches stop in the middle of the index
+			record.mass = 100 + double((cargo * 7919) % cargoCount) / cargoCount * 10000;
+
+			depot->StoreCargo(record);
+		}
+
+		Measurement nameCount, massCount, take, store;
+		nameCount.method = "GetCargoCount (name)";
+		massCount.method = "GetCargoCount (name, mass)";
+		take.method = "TakeCargo (resource, mass)";
+		store.method = "StoreCargo";
+
+		for (int iteration = 0; iteration < iterations; iteration++)
+		{
+			UCSO::CargoRecord record;
+
+			Measure(nameCount, [&] { return depot->GetCargoCount("CargoFuel", nullptr, -1) > 0; });
+			Measure(massCount, [&] { return depot->GetCargoCount("CargoFuel", nullptr, 5000) > 0; });
+			Measure(take, [&] { return depot->TakeCargo(nullptr, "fuel", 5000, record); });
+			Measure(store, [&] { depot->StoreCargo(record); return true; });
+		}
+
+		for (const Measurement* measurement : { &nameCount, &massCount, &take, &store }) PrintMeasurement(cargoCount, *measurement);
+
+		return true;
+	}
+
+	bool RunLoadBenchmark(int cargoCount)
+	{
+		std::string fileName = "UCSOLoad" + std::to_string(cargoCount) + ".scn";
+
+		std::string command = std::string("\"") + UCSO_SCENARIO_GENERATOR + "\" -cargoes " + std::to_string(cargoCount) +
+			" -carriers " + std::to_string(cargoCount / 10) + " -pending " + std::to_string(cargoCount / 10) + " Scenarios/" + fileName;
+
+		if (system(command.c_str()) != 0)
+		{
+			fprintf(stderr, "Couldn't generate the scenario %s\n", fileName.c_str());
+			return false;
+		}
+
+		int loadedCount = 0;
+
+		Measurement load, step;
+		load.method = "LoadScenario (per vessel)";
+		step.method = "First step (per vessel)";
+
+		Measure(load, [&] { return (loadedCount = Headless::LoadScenario(fileName.c_str())) > 0; });
+		Measure(step, [&] { Headless::Step(STEP); return true; });
+
+		if (!loadedCount)
+		{
+			fprintf(stderr, "Couldn't load the scenario %s\n", fileName.c_str());
+			return false;
+		}
+
+		// Count the measurements per loaded vessel
+		load.callCount = step.callCount = loadedCount;
+
+		for (const Measurement* measurement : { &load, &step }) PrintMeasurement(loadedCount, *measurement);
+
+		return true;
+	}
+
+	std::vector<int> ParseCounts(const std::string& counts)
+	{
+		std::vector<int> countList;
+
+		for (size_t start = 0; start < counts.size();)
+		{
+			size_t end = counts.find(',', start);
+			if (end == std::string::npos) end = counts.size();
+
+			countList.push_back(atoi(counts.substr(start, end - start).c_str()));
+
+			start = end + 1;
+		}
+
+		return countList;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+	std::vector<int> vesselCounts = { 100, 1000, 10000 };
+	int iterations = 100;
+
+	for (int arg = 1; arg + 1 < argc; arg += 2)
+	{
+		if (!strcmp(argv[arg], "-root")) root = argv[arg + 1];
+		else if (!strcmp(argv[arg], "-vessels")) vesselCounts = ParseCounts(argv[arg + 1]);
+		else if (!strcmp(argv[arg], "-iterations")) iterations = atoi(argv[arg + 1]);
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[arg]);
+			return 1;
+		}
+	}
+
+	// The modules and the configuration files are found from the Orbiter folder, as in Orbiter
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	Headless::Carrier::Register();
+
+	// The generated scenarios use the ShuttlePB carrier
+	Headless::Carrier::Register("UCSO\\ShuttlePB");
+
+	printf("%8s  %-32s %12s %16s\n", "Vessels", "Method", "ns/op", "allocations/op");
+
+	for (int vesselCount : vesselCounts)
+	{
+		bool succeeded = RunBenchmark(vesselCount, iterations);
+
+		Headless::CloseSimulation();
+
+		if (!succeeded) return 1;
+	}
+
+	printf("\n%8s  %-32s %12s %16s\n", "Cargoes", "Method", "ns/op", "allocations/op");
+
+	for (int cargoCount : vesselCounts)
+	{
+		bool succeeded = RunDepotBenchmark(cargoCount, iterations);
+
+		Headless::CloseSimulation();
+
+		if (!succeeded) return 1;
+	}
+
+	printf("\n%8s  %-32s %12s %16s\n", "Vessels", "Method", "ns/op", "allocations/op");
+
+	for (int cargoCount : vesselCounts)
+	{
+		bool succeeded = RunLoadBenchmark(cargoCount);
+
+		Headless::CloseSimulation();
+
+		if (!succeeded) return 1;
+	}
+
+	return 0;
+}
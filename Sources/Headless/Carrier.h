@@ -0,0 +1,67 @@
+// =======================================================================================
+// Carrier.h : The vessel which uses the UCSO API in the headless benchmark and tests.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include "Headless.h"
+#include "../API/Vessel.h"
+
+namespace Headless
+{
+	// A vessel with one cargo slot. Its class is HeadlessCarrier, which is in Config/Vessels of the headless root
+	class Carrier : public VESSEL4
+	{
+	public:
+		Carrier(OBJHANDLE hVessel, int flightModel) : VESSEL4(hVessel, flightModel), ucso(UCSO::Vessel::CreateInstance(this)) { }
+
+		~Carrier() { delete ucso; }
+
+		void clbkSetClassCaps(FILEHANDLE cfg) override
+		{
+			slotAttachment = CreateAttachment(false, { 0, 2, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, "UCSO");
+
+			ucso->SetSlotAttachment(0, slotAttachment);
+		}
+
+		// The module name can be another carrier module, e.g. UCSO\ShuttlePB, so the carriers of the generated scenarios can be loaded
+		static void Register(const char* moduleName = "HeadlessCarrier")
+		{
+			RegisterModule(moduleName, [](OBJHANDLE hVessel, int flightModel) -> VESSEL* { return new Carrier(hVessel, flightModel); },
+				[](VESSEL* vessel) { delete static_cast<Carrier*>(vessel); });
+		}
+
+		UCSO::Vessel* ucso;
+		ATTACHMENTHANDLE slotAttachment = nullptr;
+	};
+
+	// Creates a landed vessel at the passed distances in meters from the longitude and latitude 0
+	inline OBJHANDLE CreateLandedVessel(const char* name, const char* className, double east, double north, double height)
+	{
+		VESSELSTATUS2 status = { };
+		status.version = 2;
+		status.rbody = oapiGetObjectByName("Moon");
+		status.status = 1;
+		status.surf_lng = east / oapiGetSize(status.rbody);
+		status.surf_lat = north / oapiGetSize(status.rbody);
+		status.vrot.x = height;
+
+		return oapiCreateVesselEx(name, className, &status);
+	}
+}
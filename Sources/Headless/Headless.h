@@ -0,0 +1,46 @@
+// =======================================================================================
+// Headless.h : The control of the headless simulation, which Orbiter does in the real simulation.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#pragma once
+#include "Orbitersdk.h"
+
+namespace Headless
+{
+	typedef VESSEL* (*InitFunction)(OBJHANDLE hVessel, int flightModel);
+	typedef void (*ExitFunction)(VESSEL* vessel);
+	typedef void (*LogFunction)(const char* line);
+
+	// Makes a vessel module of the executable available to the vessel classes whose configuration file has Module = name
+	OAPIFUNC void RegisterModule(const char* name, InitFunction init, ExitFunction exit);
+
+	// Passes every log line to the function as well as Orbiter.log
+	OAPIFUNC void SetLogFunction(LogFunction function);
+
+	// Deletes the vessels which were deleted in the last step, then calls clbkPreStep and clbkPostStep of every vessel
+	OAPIFUNC void Step(double simdt);
+
+	// Loads the vessels of the scenario file in the Scenarios folder as Orbiter does: each vessel reads its block in clbkLoadStateEx,
+	// then the children are attached and clbkPostCreation is called. Returns the count of the loaded vessels
+	OAPIFUNC int LoadScenario(const char* fileName);
+
+	// Deletes all vessels, then calls ExitModule of the loaded vessel modules and frees them, as Orbiter does when the simulation is closed
+	OAPIFUNC void CloseSimulation();
+}
@@ -0,0 +1,280 @@
+// =======================================================================================
+// HelperBenchmark.cpp : Measures the ground rotation and the spawn name helpers, and checks them against the original ones.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: HelperBenchmark [-root <Orbiter folder>] [-baseline <file>] [-write-baseline <file>]
+// SetGroundRotation is measured on a sweep of latitudes, longitudes, and headings, which includes the poles and the zero angles,
+// and every rotation is compared bit by bit with the original one, which multiplied full rotation matrices.
+// SetSpawnName is measured while 10, 100, and 1000 vessels have the same name prefix, so every call probes all of them.
+// The times are printed with the ratio to the baseline file, which is HelperBaseline.txt in this folder by default.
+// The benchmark fails if a rotation differs from the original or a spawn name is wrong. The times are only reported, as they depend on the machine.
+
+#include "Headless.h"
+#include "../API/Helper.h"
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+	const int LATITUDE_STEPS = 36;
+	const int LONGITUDE_STEPS = 72;
+	const int HEADING_STEPS = 36;
+
+	// Each SetSpawnName call probes every vessel with the prefix, and each probe searches the vessel list,
+	// So the iterations of each prefix count are set to make about this many vessel comparisons
+	const long long SPAWN_NAME_WORK = 10000000;
+
+	const int prefixCounts[] = { 10, 100, 1000 };
+
+	struct Measurement
+	{
+		std::string name;
+		double time; // Nanoseconds per call
+	};
+
+	// SetGroundRotation before the single axis rotations
+	void SetOriginalGroundRotation(VESSELSTATUS2& status, double height)
+	{
+		MATRIX3 rot1 = UCSO::RotationMatrix({ 0, PI05 - status.surf_lng, 0 });
+		MATRIX3 rot2 = UCSO::RotationMatrix({ -status.surf_lat, 0, 0 });
+		MATRIX3 rot3 = UCSO::RotationMatrix({ 0, 0, PI + status.surf_hdg });
+		MATRIX3 rot4 = UCSO::RotationMatrix({ PI05, 0, 0 });
+		MATRIX3 RotMatrix_Def = mul(rot1, mul(rot2, mul(rot3, rot4)));
+
+		status.arot.x = atan2(RotMatrix_Def.m23, RotMatrix_Def.m33);
+		status.arot.y = -asin(RotMatrix_Def.m13);
+		status.arot.z = atan2(RotMatrix_Def.m12, RotMatrix_Def.m11);
+
+		status.vrot.x = height;
+	}
+
+	// SetSpawnName before the index suffix was replaced in place
+	void SetOriginalSpawnName(std::string& name)
+	{
+		for (int index = 0; ++index;)
+		{
+			std::string spawnName = name.c_str() + std::to_string(index);
+
+			if (!oapiGetVesselByName(&spawnName[0])) { name = spawnName; return; }
+		}
+	}
+
+	std::vector<VESSELSTATUS2> GetRotationSweep()
+	{
+		std::vector<VESSELSTATUS2> statusList;
+
+		for (int latitude = 0; latitude <= LATITUDE_STEPS; latitude++)
+		{
+			for (int longitude = 0; longitude <= LONGITUDE_STEPS; longitude++)
+			{
+				for (int heading = 0; heading <= HEADING_STEPS; heading++)
+				{
+					VESSELSTATUS2 status = { };
+					status.surf_lat = -PI05 + PI * latitude / LATITUDE_STEPS;
+					status.surf_lng = -PI + PI2 * longitude / LONGITUDE_STEPS;
+					status.surf_hdg = PI2 * heading / HEADING_STEPS;
+
+					statusList.push_back(status);
+				}
+			}
+		}
+
+		return statusList;
+	}
+
+	template<typename Function>
+	double MeasureSweep(std::vector<VESSELSTATUS2>& statusList, Function function)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for (VESSELSTATUS2& status : statusList) function(status, 0.65);
+
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / statusList.size();
+	}
+
+	bool MeasureRotation(std::vector<Measurement>& measurementList)
+	{
+		std::vector<VESSELSTATUS2> statusList = GetRotationSweep();
+		std::vector<VESSELSTATUS2> originalList = statusList;
+
+		measurementList.push_back({ "SetGroundRotation", MeasureSweep(statusList, UCSO::SetGroundRotation) });
+		measurementList.push_back({ "SetGroundRotation (original)", MeasureSweep(originalList, SetOriginalGroundRotation) });
+
+		int differentCount = 0;
+
+		for (size_t index = 0; index < statusList.size(); index++)
+		{
+			if (!memcmp(&statusList[index].arot, &originalList[index].arot, sizeof(VECTOR3))) continue;
+
+			if (differentCount++ < 10)
+			{
+				const VESSELSTATUS2& status = statusList[index];
+				const VESSELSTATUS2& original = originalList[index];
+
+				fprintf(stderr, "The rotation at lat %.17g, lng %.17g, hdg %.17g is (%.17g, %.17g, %.17g) instead of (%.17g, %.17g, %.17g)\n",
+					status.surf_lat, status.surf_lng, status.surf_hdg, status.arot.x, status.arot.y, status.arot.z,
+					original.arot.x, original.arot.y, original.arot.z);
+			}
+		}
+
+		if (differentCount) fprintf(stderr, "%d of %d rotations differ from the original\n", differentCount, static_cast<int>(statusList.size()));
+
+		return differentCount == 0;
+	}
+
+	bool MeasureSpawnName(int prefixCount, std::vector<Measurement>& measurementList)
+	{
+		VESSELSTATUS2 status = { };
+		status.version = 2;
+		status.rbody = oapiGetObjectByName("Moon");
+		status.status = 1;
+
+		for (int index = 1; index <= prefixCount; index++)
+		{
+			std::string name = "Cargo" + std::to_string(index);
+
+			if (!oapiCreateVesselEx(name.c_str(), "HeadlessVessel", &status))
+			{
+				fprintf(stderr, "Couldn't create the vessels. Check that the root folder has the HeadlessVessel configuration\n");
+				return false;
+			}
+		}
+
+		std::string expectedName = "Cargo" + std::to_string(prefixCount + 1);
+		int iterations = static_cast<int>(std::max(1LL, SPAWN_NAME_WORK / (static_cast<long long>(prefixCount) * prefixCount)));
+		bool succeeded = true;
+
+		for (bool original : { false, true })
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			for (int iteration = 0; iteration < iterations; iteration++)
+			{
+				std::string name = "Cargo";
+
+				if (original) SetOriginalSpawnName(name);
+				else UCSO::SetSpawnName(name);
+
+				succeeded &= name == expectedName;
+			}
+
+			double time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+			measurementList.push_back({ "SetSpawnName " + std::to_string(prefixCount) + (original ? " (original)" : ""), time });
+		}
+
+		if (!succeeded) fprintf(stderr, "SetSpawnName didn't return %s with %d vessels\n", expectedName.c_str(), prefixCount);
+
+		return succeeded;
+	}
+
+	// Each baseline line has the measurement name, a tab, and the time in nanoseconds per call
+	std::map<std::string, double> ReadBaseline(const char* fileName)
+	{
+		std::map<std::string, double> baselineMap;
+		std::ifstream file(fileName);
+		std::string line;
+
+		while (std::getline(file, line))
+		{
+			size_t tab = line.find('\t');
+			if (line.empty() || line[0] == ';' || tab == std::string::npos) continue;
+
+			baselineMap[line.substr(0, tab)] = atof(line.c_str() + tab + 1);
+		}
+
+		return baselineMap;
+	}
+
+	bool WriteBaseline(const char* fileName, const std::vector<Measurement>& measurementList)
+	{
+		std::ofstream file(fileName);
+
+		file << "; The HelperBenchmark times in nanoseconds per call, which the later runs are compared with\n";
+
+		for (const Measurement& measurement : measurementList) file << measurement.name << '\t' << measurement.time << '\n';
+
+		return file.good();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+	const char* baselineFile = UCSO_HELPER_BASELINE;
+	const char* writtenBaselineFile = nullptr;
+
+	for (int arg = 1; arg + 1 < argc; arg += 2)
+	{
+		if (!strcmp(argv[arg], "-root")) root = argv[arg + 1];
+		else if (!strcmp(argv[arg], "-baseline")) baselineFile = argv[arg + 1];
+		else if (!strcmp(argv[arg], "-write-baseline")) writtenBaselineFile = argv[arg + 1];
+		else
+		{
+			fprintf(stderr, "Unknown option %s\n", argv[arg]);
+			return 1;
+		}
+	}
+
+	// The baseline is read before the root folder is opened, as its path can be relative
+	std::map<std::string, double> baselineMap = ReadBaseline(baselineFile);
+
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	std::vector<Measurement> measurementList;
+
+	bool succeeded = MeasureRotation(measurementList);
+
+	for (int prefixCount : prefixCounts)
+	{
+		succeeded &= MeasureSpawnName(prefixCount, measurementList);
+
+		// Every prefix count is measured in a new simulation
+		Headless::CloseSimulation();
+	}
+
+	printf("%-32s %12s %12s\n", "Method", "ns/op", "baseline");
+
+	for (const Measurement& measurement : measurementList)
+	{
+		printf("%-32s %12.1f", measurement.name.c_str(), measurement.time);
+
+		auto baselineIt = baselineMap.find(measurement.name);
+		if (baselineIt != baselineMap.end() && baselineIt->second > 0) printf(" %11.2fx", measurement.time / baselineIt->second);
+
+		printf("\n");
+	}
+
+	if (writtenBaselineFile && !WriteBaseline(writtenBaselineFile, measurementList))
+	{
+		fprintf(stderr, "Couldn't write the baseline file %s\n", writtenBaselineFile);
+		return 1;
+	}
+
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+// =======================================================================================
+// ManifestTest.cpp : Checks the per-entry results of the manifest loading and the manifest file parsing.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: ManifestTest [-root <Orbiter folder>]
+// A carrier with 3 slots loads a manifest whose entries take each slot, reuse a slot taken by a previous entry, run out of slots,
+// and pass unknown cargoes and slots. The same manifest is loaded again while logging, which adds the entries one by one.
+// The test fails if any entry result or spawned name differs from the expected one, e.g. a taken spawn index is probed again.
+// Then a manifest file with comments, empty lines, and optional slots is loaded, and its results and cargoes are checked.
+
+#include "Carrier.h"
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+	const double STEP = 0.02;
+	const int SLOT_COUNT = 3;
+
+	const char* MANIFEST_FILE = "ManifestTest.txt";
+	const char* LOG_FILE = "ManifestTest.bin";
+
+	typedef UCSO::Vessel::GrappleResult GrappleResult;
+
+	struct Carrier
+	{
+		Headless::Carrier* vessel = nullptr;
+		ATTACHMENTHANDLE slotList[SLOT_COUNT] = { };
+	};
+
+	bool CreateCarrier(Carrier& carrier)
+	{
+		OBJHANDLE hCarrier = Headless::CreateLandedVessel("Carrier", "HeadlessCarrier", 0, 0, 2);
+
+		if (!hCarrier)
+		{
+			fprintf(stderr, "Couldn't create the carrier. Check that the root folder has the HeadlessCarrier configuration\n");
+			return false;
+		}
+
+		carrier.vessel = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hCarrier));
+
+		if (!carrier.vessel->ucso->GetUCSOVersion())
+		{
+			fprintf(stderr, "UCSO isn't installed in the root folder\n");
+			return false;
+		}
+
+		carrier.slotList[0] = carrier.vessel->slotAttachment;
+
+		// Add the other slots next to the first one
+		for (int slot = 1; slot < SLOT_COUNT; slot++)
+		{
+			carrier.slotList[slot] = carrier.vessel->CreateAttachment(false, { 0, 2, 3.0 * slot }, { 0, 1, 0 }, { 0, 0, 1 }, "UCSO");
+			carrier.vessel->ucso->SetSlotAttachment(slot, carrier.slotList[slot]);
+		}
+
+		Headless::Step(STEP);
+
+		return true;
+	}
+
+	// Returns the name of the cargo in the slot, or an empty string if the slot is empty
+	std::string GetSlotCargo(const Carrier& carrier, int slot)
+	{
+		OBJHANDLE hCargo = carrier.vessel->GetAttachmentStatus(carrier.slotList[slot]);
+
+		return hCargo ? oapiGetVesselInterface(hCargo)->GetName() : "";
+	}
+
+	bool CheckResults(const char* test, const GrappleResult* results, const GrappleResult* expectedResults, int count)
+	{
+		bool succeeded = true;
+
+		for (int entry = 0; entry < count; entry++)
+		{
+			if (results[entry] == expectedResults[entry]) continue;
+
+			fprintf(stderr, "%s: entry %d returned %d instead of %d\n", test, entry, results[entry], expectedResults[entry]);
+			succeeded = false;
+		}
+
+		return succeeded;
+	}
+
+	bool CheckSlots(const char* test, const Carrier& carrier, const char* const* expectedNames)
+	{
+		bool succeeded = true;
+
+		for (int slot = 0; slot < SLOT_COUNT; slot++)
+		{
+			std::string cargoName = GetSlotCargo(carrier, slot);
+
+			if (cargoName == expectedNames[slot]) continue;
+
+			fprintf(stderr, "%s: slot %d holds '%s' instead of '%s'\n", test, slot, cargoName.c_str(), expectedNames[slot]);
+			succeeded = false;
+		}
+
+		return succeeded;
+	}
+
+	bool RunManifestTest(bool logging)
+	{
+		const char* test = logging ? "LoadManifest (logging)" : "LoadManifest";
+
+		Carrier carrier;
+		if (!CreateCarrier(carrier)) return false;
+
+		UCSO::Vessel* ucso = carrier.vessel->ucso;
+
+		// Take the first spawn name, so the manifest names start from the second one
+		Headless::CreateLandedVessel("CargoFuel1", "UCSO\\CargoFuel", 1000, 0, 0.65);
+		Headless::Step(STEP);
+
+		if (logging && !ucso->SetOperationLog(LOG_FILE))
+		{
+			fprintf(stderr, "%s: couldn't open the operation log\n", test);
+			return false;
+		}
+
+		const UCSO::Vessel::ManifestEntry entries[] =
+		{
+			{ "CargoFuel", -1, -1 },       // The first empty slot
+			{ "CargoFuel", -1, 1 },        // The passed slot, with the next spawn name
+			{ "CargoContainer", -1, 1 },   // The slot taken by the previous entry
+			{ "NoSuchCargo", -1, -1 },     // An unknown cargo name
+			{ nullptr, 1000, -1 },         // An invalid index
+			{ "CargoContainer", -1, 7 },   // An undefined slot
+			{ "CargoContainer", -1, -1 },  // The last empty slot
+			{ "CargoFuel", -1, -1 }        // No empty slot is left
+		};
+
+		const GrappleResult expectedResults[] =
+		{
+			UCSO::Vessel::GRAPPLE_SUCCEEDED,
+			UCSO::Vessel::GRAPPLE_SUCCEEDED,
+			UCSO::Vessel::GRAPPLE_SLOT_OCCUPIED,
+			UCSO::Vessel::NO_CARGO_IN_RANGE,
+			UCSO::Vessel::NO_CARGO_IN_RANGE,
+			UCSO::Vessel::GRAPPLE_SLOT_UNDEFINED,
+			UCSO::Vessel::GRAPPLE_SUCCEEDED,
+			UCSO::Vessel::GRAPPLE_SLOT_OCCUPIED
+		};
+
+		const char* expectedNames[SLOT_COUNT] = { "CargoFuel2", "CargoFuel3", "CargoContainer1" };
+
+		const int count = sizeof(entries) / sizeof(entries[0]);
+		GrappleResult results[count];
+
+		int addedCount = ucso->LoadManifest(entries, count, results);
+
+		if (logging) ucso->SetOperationLog(nullptr);
+
+		Headless::Step(STEP);
+
+		bool succeeded = CheckResults(test, results, expectedResults, count);
+		succeeded &= CheckSlots(test, carrier, expectedNames);
+
+		if (addedCount != SLOT_COUNT)
+		{
+			fprintf(stderr, "%s: %d cargoes were added instead of %d\n", test, addedCount, SLOT_COUNT);
+			succeeded = false;
+		}
+
+		printf("%s: %d of %d entries added\n", test, addedCount, count);
+
+		return succeeded;
+	}
+
+	bool RunManifestFileTest()
+	{
+		const char* test = "LoadManifestFile";
+
+		Carrier carrier;
+		if (!CreateCarrier(carrier)) return false;
+
+		UCSO::Vessel* ucso = carrier.vessel->ucso;
+
+		FILE* file = fopen(MANIFEST_FILE, "w");
+
+		if (!file)
+		{
+			fprintf(stderr, "%s: couldn't write the manifest file\n", test);
+			return false;
+		}
+
+		fprintf(file, "; The manifest of the headless test\n\n");
+		fprintf(file, "CargoContainer 2\n");
+		fprintf(file, "   CargoFuel\n");
+		fprintf(file, "NoSuchCargo 1\n");
+		fprintf(file, "\tCargoLifeModule\t\n");
+		fprintf(file, "CargoFuel\n");
+		fclose(file);
+
+		const GrappleResult expectedResults[] =
+		{
+			UCSO::Vessel::GRAPPLE_SUCCEEDED,
+			UCSO::Vessel::GRAPPLE_SUCCEEDED,
+			UCSO::Vessel::NO_CARGO_IN_RANGE,
+			UCSO::Vessel::GRAPPLE_SUCCEEDED
+		};
+
+		const char* expectedNames[SLOT_COUNT] = { "CargoFuel1", "CargoLifeModule1", "CargoContainer1" };
+
+		// The last entry is outside the results array, which must be left as it is
+		const int count = sizeof(expectedResults) / sizeof(expectedResults[0]);
+		GrappleResult results[count + 1];
+		results[count] = UCSO::Vessel::GRAPPLE_FAILED;
+
+		int addedCount = ucso->LoadManifestFile(MANIFEST_FILE, results, count);
+
+		Headless::Step(STEP);
+
+		bool succeeded = CheckResults(test, results, expectedResults, count);
+		succeeded &= CheckSlots(test, carrier, expectedNames);
+
+		if (results[count] != UCSO::Vessel::GRAPPLE_FAILED)
+		{
+			fprintf(stderr, "%s: a result was written after the passed count\n", test);
+			succeeded = false;
+		}
+
+		if (addedCount != SLOT_COUNT)
+		{
+			fprintf(stderr, "%s: %d cargoes were added instead of %d\n", test, addedCount, SLOT_COUNT);
+			succeeded = false;
+		}
+
+		if (ucso->LoadManifestFile("NoSuchManifest.txt") != -1)
+		{
+			fprintf(stderr, "%s: a missing file didn't return -1\n", test);
+			succeeded = false;
+		}
+
+		printf("%s: %d entries added\n", test, addedCount);
+
+		return succeeded;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+
+	if (argc == 3 && !strcmp(argv[1], "-root")) root = argv[2];
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: ManifestTest [-root <Orbiter folder>]\n");
+		return 1;
+	}
+
+	// The modules and the configuration files are found from the Orbiter folder, as in Orbiter
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	Headless::Carrier::Register();
+
+	bool succeeded = true;
+
+	for (bool logging : { false, true })
+	{
+		succeeded &= RunManifestTest(logging);
+
+		Headless::CloseSimulation();
+	}
+
+	succeeded &= RunManifestFileTest();
+
+	Headless::CloseSimulation();
+
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,1896 @@
+// =======================================================================================
+// Orbiter.cpp : The headless simulation, which implements the SDK subset of Orbitersdk.h.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include "Headless.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Headless
+{
+	struct ObjectData
+	{
+		bool isVessel;
+		std::string name;
+		double size = 1;
+	};
+
+	// The bodies are at the origin and don't rotate, so the vessels' positions don't change unless they are set
+	struct BodyData : ObjectData
+	{
+		double mass;
+	};
+
+	struct AttachmentData
+	{
+		VesselData* owner;
+		bool toParent;
+		VECTOR3 pos, dir, rot;
+		std::string id;
+		AttachmentData* peer = nullptr; // The attachment of the attached vessel
+	};
+
+	struct Propellant
+	{
+		double maxMass;
+		double mass;
+		double efficiency;
+	};
+
+	struct MeshData
+	{
+		std::string name;
+		VECTOR3 ofs;
+		WORD visibility;
+		bool deleted;
+	};
+
+	struct ModuleData
+	{
+		HINSTANCE library = nullptr; // nullptr for the modules of the executable
+		InitFunction init = nullptr;
+		ExitFunction exit = nullptr;
+	};
+
+	struct VesselData : ObjectData
+	{
+		std::string className;
+		VESSEL* vessel = nullptr;
+		ModuleData* module = nullptr;
+
+		double emptyMass = 0;
+		std::vector<std::unique_ptr<Propellant>> propellantList;
+
+		BodyData* body = nullptr;
+		bool landed = false;
+		double lng = 0, lat = 0, hdg = 0, elevation = 0;
+
+		// The global frame if the vessel isn't attached
+		VECTOR3 pos = { };
+		VECTOR3 vel = { };
+		MATRIX3 rot = _M(1, 0, 0, 0, 1, 0, 0, 0, 1);
+
+		// The attachments are kept until the vessel is deleted, so the deleted handles don't point to freed memory
+		std::vector<std::unique_ptr<AttachmentData>> attachmentStore;
+		std::vector<AttachmentData*> parentAttachments;
+		std::vector<AttachmentData*> childAttachments;
+		AttachmentData* parentLink = nullptr; // The attachment which is attached to the parent
+
+		std::vector<MeshData> meshList;
+		bool enableFocus = true;
+		bool killed = false;
+
+		std::string attachedItem; // The ATTACHED value of a loaded scenario, which is attached after all the vessels are loaded
+	};
+}
+
+namespace
+{
+	using namespace Headless;
+
+	struct World
+	{
+		std::vector<VesselData*> vesselList;
+		std::vector<VesselData*> stepList; // The vessels of the current step, which is kept so the steps don't allocate
+		std::vector<std::unique_ptr<BodyData>> bodyList;
+		std::map<std::string, std::unique_ptr<ModuleData>> moduleMap;
+		std::map<std::string, ModuleData> registeredModules;
+		std::map<std::string, std::unique_ptr<std::string>> meshMap;
+		VesselData* focus = nullptr;
+		double simTime = 0;
+		double simStep = 0;
+		LogFunction logFunction = nullptr;
+		FILE* logFile = nullptr;
+		std::mutex logMutex;
+		std::mutex meshMutex;
+		std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		World()
+		{
+			std::unique_ptr<BodyData> moon(new BodyData);
+			moon->isVessel = false;
+			moon->name = "Moon";
+			moon->size = 1737400;
+			moon->mass = 7.347e22;
+
+			bodyList.push_back(std::move(moon));
+		}
+	};
+
+	World& GetWorld()
+	{
+		static World world;
+		return world;
+	}
+
+	thread_local DWORD lastError = 0;
+
+	std::string ToLower(std::string string)
+	{
+		for (char& c : string) c = char(tolower(static_cast<unsigned char>(c)));
+		return string;
+	}
+
+	std::string TrimString(const std::string& string)
+	{
+		size_t start = string.find_first_not_of(" \t\r\n");
+		if (start == std::string::npos) return "";
+
+		return string.substr(start, string.find_last_not_of(" \t\r\n") - start + 1);
+	}
+
+	bool PathExists(const std::string& path)
+	{
+		struct stat info;
+		return stat(path.c_str(), &info) == 0;
+	}
+
+	// Resolves the path as Windows does, which ignores the case and accepts the backslashes
+	std::string ResolvePath(std::string path)
+	{
+		std::replace(path.begin(), path.end(), '\\', '/');
+
+		if (path.empty() || PathExists(path)) return path;
+
+		std::string resolved = path[0] == '/' ? "/" : "";
+		size_t start = path[0] == '/' ? 1 : 0;
+
+		while (start <= path.size())
+		{
+			size_t end = path.find('/', start);
+			if (end == std::string::npos) end = path.size();
+
+			std::string component = path.substr(start, end - start);
+			start = end + 1;
+
+			if (component.empty() || component == ".") continue;
+
+			std::string candidate = resolved + component;
+
+			if (!PathExists(candidate))
+			{
+				DIR* dir = opendir(resolved.empty() ? "." : resolved.c_str());
+
+				if (dir)
+				{
+					while (dirent* entry = readdir(dir))
+					{
+						if (strcasecmp(entry->d_name, component.c_str()) == 0) { candidate = resolved + entry->d_name; break; }
+					}
+
+					closedir(dir);
+				}
+			}
+
+			resolved = candidate;
+			if (end < path.size()) resolved += '/';
+		}
+
+		return resolved;
+	}
+
+	const char* GetRootDir(PathRoot root)
+	{
+		switch (root)
+		{
+		case CONFIG:
+			return "Config/";
+		case SCENARIOS:
+			return "Scenarios/";
+		case TEXTURES:
+			return "Textures/";
+		case TEXTURES2:
+			return "Textures2/";
+		case MESHES:
+			return "Meshes/";
+		case MODULES:
+			return "Modules/";
+		default:
+			return "";
+		}
+	}
+
+	ObjectData* GetObject(OBJHANDLE hObj) { return static_cast<ObjectData*>(hObj); }
+
+	OBJHANDLE GetObjectHandle(ObjectData* object) { return static_cast<OBJHANDLE>(object); }
+
+	VesselData* GetVessel(OBJHANDLE hVessel)
+	{
+		ObjectData* object = GetObject(hVessel);
+
+		return object && object->isVessel ? static_cast<VesselData*>(object) : nullptr;
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// The frames
+	// ---------------------------------------------------------------------------------------
+
+	void GetHorizonFrame(double lng, double lat, VECTOR3& east, VECTOR3& up, VECTOR3& north)
+	{
+		east = _V(-sin(lng), 0, cos(lng));
+		up = _V(cos(lat) * cos(lng), sin(lat), cos(lat) * sin(lng));
+		north = _V(-sin(lat) * cos(lng), cos(lat), -sin(lat) * sin(lng));
+	}
+
+	MATRIX3 GetColumnMatrix(const VECTOR3& x, const VECTOR3& y, const VECTOR3& z) { return _M(x.x, y.x, z.x, x.y, y.y, z.y, x.z, y.z, z.z); }
+
+	MATRIX3 GetTransposed(const MATRIX3& m) { return _M(m.m11, m.m21, m.m31, m.m12, m.m22, m.m32, m.m13, m.m23, m.m33); }
+
+	// The inverse of the Euler angles which Orbiter writes in the scenarios and the status
+	MATRIX3 GetRotation(const VECTOR3& arot)
+	{
+		double sinX = sin(arot.x), cosX = cos(arot.x);
+		double sinY = sin(arot.y), cosY = cos(arot.y);
+		double sinZ = sin(arot.z), cosZ = cos(arot.z);
+
+		return mul(_M(1, 0, 0, 0, cosX, sinX, 0, -sinX, cosX), mul(_M(cosY, 0, -sinY, 0, 1, 0, sinY, 0, cosY), _M(cosZ, sinZ, 0, -sinZ, cosZ, 0, 0, 0, 1)));
+	}
+
+	VECTOR3 GetEulerAngles(const MATRIX3& rot) { return _V(atan2(rot.m23, rot.m33), -asin(rot.m13), atan2(rot.m12, rot.m11)); }
+
+	void SetLandedFrame(VesselData* vessel)
+	{
+		VECTOR3 east, up, north;
+		GetHorizonFrame(vessel->lng, vessel->lat, east, up, north);
+
+		VECTOR3 right = east * cos(vessel->hdg) - north * sin(vessel->hdg);
+		VECTOR3 forward = north * cos(vessel->hdg) + east * sin(vessel->hdg);
+
+		vessel->pos = up * (vessel->body->size + vessel->elevation);
+		vessel->rot = GetColumnMatrix(right, up, forward);
+		vessel->vel = { };
+	}
+
+	// The attachment frame: the direction, the rotation which is made orthogonal to it, and their cross product
+	MATRIX3 GetAttachmentFrame(const VECTOR3& dir, const VECTOR3& rot)
+	{
+		VECTOR3 x = dir;
+		normalise(x);
+
+		VECTOR3 y = rot - x * dotp(rot, x);
+		normalise(y);
+
+		return GetColumnMatrix(x, y, crossp(x, y));
+	}
+
+	// Gets the global frame. The attached vessels are placed at the parent's attachment point with the directions opposite, as in Orbiter
+	void GetFrame(const VesselData* vessel, VECTOR3& pos, MATRIX3& rot)
+	{
+		if (!vessel->parentLink)
+		{
+			pos = vessel->pos;
+			rot = vessel->rot;
+			return;
+		}
+
+		const AttachmentData* childAttachment = vessel->parentLink;
+		const AttachmentData* parentAttachment = childAttachment->peer;
+
+		VECTOR3 parentPos;
+		MATRIX3 parentRot;
+		GetFrame(parentAttachment->owner, parentPos, parentRot);
+
+		MATRIX3 relativeRot = mul(GetAttachmentFrame(-parentAttachment->dir, parentAttachment->rot),
+			GetTransposed(GetAttachmentFrame(childAttachment->dir, childAttachment->rot)));
+
+		rot = mul(parentRot, relativeRot);
+		pos = parentPos + mul(parentRot, parentAttachment->pos - mul(relativeRot, childAttachment->pos));
+	}
+
+	void GetSurfacePos(const VECTOR3& pos, const MATRIX3& rot, double& lng, double& lat, double& hdg)
+	{
+		lng = atan2(pos.z, pos.x);
+		lat = asin(pos.y / length(pos));
+
+		VECTOR3 east, up, north;
+		GetHorizonFrame(lng, lat, east, up, north);
+
+		VECTOR3 forward = _V(rot.m13, rot.m23, rot.m33);
+
+		hdg = atan2(dotp(forward, east), dotp(forward, north));
+		if (hdg < 0) hdg += PI2;
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// The vessels
+	// ---------------------------------------------------------------------------------------
+
+	void Attach(AttachmentData* parentAttachment, AttachmentData* childAttachment)
+	{
+		parentAttachment->peer = childAttachment;
+		childAttachment->peer = parentAttachment;
+
+		VesselData* child = childAttachment->owner;
+		child->parentLink = childAttachment;
+		child->landed = false;
+	}
+
+	// Detaches the child at its current position
+	void Detach(AttachmentData* parentAttachment, double vel)
+	{
+		AttachmentData* childAttachment = parentAttachment->peer;
+		VesselData* child = childAttachment->owner;
+
+		VECTOR3 parentPos;
+		MATRIX3 parentRot;
+		GetFrame(parentAttachment->owner, parentPos, parentRot);
+
+		GetFrame(child, child->pos, child->rot);
+		child->vel = parentAttachment->owner->vel + mul(parentRot, parentAttachment->dir) * vel;
+		child->landed = false;
+		child->parentLink = nullptr;
+
+		parentAttachment->peer = nullptr;
+		childAttachment->peer = nullptr;
+	}
+
+	void DetachAll(VesselData* vessel)
+	{
+		for (AttachmentData* attachment : vessel->childAttachments) if (attachment->peer) Detach(attachment, 0);
+
+		if (vessel->parentLink) Detach(vessel->parentLink->peer, 0);
+	}
+
+	ModuleData* LoadModule(const std::string& name)
+	{
+		World& world = GetWorld();
+		std::string key = ToLower(name);
+		std::replace(key.begin(), key.end(), '\\', '/');
+
+		auto registeredIt = world.registeredModules.find(key);
+		if (registeredIt != world.registeredModules.end()) return &registeredIt->second;
+
+		auto moduleIt = world.moduleMap.find(key);
+		if (moduleIt != world.moduleMap.end()) return moduleIt->second.get();
+
+		HINSTANCE library = LoadLibraryA(("Modules/" + name + ".dll").c_str());
+
+		if (!library)
+		{
+			oapiWriteLogV("Headless: Couldn't load the vessel module %s", name.c_str());
+			return nullptr;
+		}
+
+		std::unique_ptr<ModuleData> module(new ModuleData);
+		module->library = library;
+		module->init = reinterpret_cast<InitFunction>(GetProcAddress(library, "ovcInit"));
+		module->exit = reinterpret_cast<ExitFunction>(GetProcAddress(library, "ovcExit"));
+
+		typedef void (*ModuleFunction)(HINSTANCE);
+		ModuleFunction InitModule = reinterpret_cast<ModuleFunction>(GetProcAddress(library, "InitModule"));
+
+		if (InitModule) InitModule(library);
+
+		return (world.moduleMap[key] = std::move(module)).get();
+	}
+
+	void DeleteVessel(VesselData* vessel)
+	{
+		World& world = GetWorld();
+
+		DetachAll(vessel);
+
+		if (vessel->module && vessel->module->exit) vessel->module->exit(vessel->vessel);
+		else delete vessel->vessel;
+
+		world.vesselList.erase(std::find(world.vesselList.begin(), world.vesselList.end(), vessel));
+
+		if (world.focus == vessel) world.focus = world.vesselList.empty() ? nullptr : world.vesselList.front();
+
+		delete vessel;
+	}
+
+	void DeleteKilledVessels()
+	{
+		World& world = GetWorld();
+
+		std::vector<VesselData*> killedList;
+
+		for (VesselData* vessel : world.vesselList) if (vessel->killed) killedList.push_back(vessel);
+
+		// The vessels deleted by the deleted vessels are deleted in the next step
+		for (VesselData* vessel : killedList) DeleteVessel(vessel);
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// The files
+	// ---------------------------------------------------------------------------------------
+
+	struct FileData
+	{
+		FileAccessMode mode;
+		std::vector<std::string> lineList;
+		size_t nextLine = 0;
+		std::string currentLine;
+		FILE* file = nullptr;
+	};
+
+	// Finds the item's value. The comments start with ';', and the item names aren't case-sensitive
+	bool FindItem(FILEHANDLE f, const char* item, std::string& value)
+	{
+		FileData* fileData = static_cast<FileData*>(f);
+		if (!fileData) return false;
+
+		for (const std::string& line : fileData->lineList)
+		{
+			std::string content = line.substr(0, line.find(';'));
+
+			size_t equalPos = content.find('=');
+			if (equalPos == std::string::npos) continue;
+
+			if (strcasecmp(TrimString(content.substr(0, equalPos)).c_str(), item) != 0) continue;
+
+			value = TrimString(content.substr(equalPos + 1));
+			return true;
+		}
+
+		return false;
+	}
+
+	void WriteFileLine(FILEHANDLE f, const std::string& line)
+	{
+		FileData* fileData = static_cast<FileData*>(f);
+
+		if (fileData && fileData->file) fprintf(fileData->file, "%s\n", line.c_str());
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// The Win32 handles
+	// ---------------------------------------------------------------------------------------
+
+	struct HandleData
+	{
+		virtual ~HandleData() = default;
+	};
+
+	struct ThreadState
+	{
+		LPTHREAD_START_ROUTINE start;
+		LPVOID parameter;
+		jmp_buf exitJump;
+		HMODULE freedModule = nullptr;
+	};
+
+	struct ThreadHandle : HandleData
+	{
+		pthread_t thread;
+		bool joined = false;
+
+		~ThreadHandle() { if (!joined) pthread_detach(thread); }
+	};
+
+	struct FindHandle : HandleData
+	{
+		std::vector<WIN32_FIND_DATAA> entryList;
+		size_t nextEntry = 1;
+	};
+
+	struct FileHandle : HandleData
+	{
+		int descriptor;
+
+		~FileHandle() { close(descriptor); }
+	};
+
+	struct MappingHandle : HandleData
+	{
+		int descriptor;
+		size_t size;
+
+		~MappingHandle() { close(descriptor); }
+	};
+
+	struct EventHandle : HandleData { };
+
+	thread_local ThreadState* currentThread = nullptr;
+
+	std::mutex viewMutex;
+	std::map<const void*, size_t> viewMap;
+
+	void* RunThread(void* parameter)
+	{
+		ThreadState* state = static_cast<ThreadState*>(parameter);
+		currentThread = state;
+
+		if (!setjmp(state->exitJump)) state->start(state->parameter);
+
+		// FreeLibraryAndExitThread jumps here, so the module is freed after its code has left the stack
+		if (state->freedModule) dlclose(state->freedModule);
+
+		currentThread = nullptr;
+		delete state;
+
+		return nullptr;
+	}
+}
+
+// ---------------------------------------------------------------------------------------
+// The Win32 subset
+// ---------------------------------------------------------------------------------------
+
+HINSTANCE LoadLibraryA(const char* fileName)
+{
+	std::string path = ResolvePath(fileName);
+
+	if (!PathExists(path))
+	{
+		lastError = ERROR_FILE_NOT_FOUND;
+		return nullptr;
+	}
+
+	// The path must have a slash, otherwise dlopen searches the library paths
+	if (path.find('/') == std::string::npos) path = "./" + path;
+
+	HINSTANCE module = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+	if (!module)
+	{
+		fprintf(stderr, "Headless: %s\n", dlerror());
+		lastError = ERROR_FILE_NOT_FOUND;
+	}
+
+	return module;
+}
+
+FARPROC GetProcAddress(HINSTANCE module, const char* procName) { return dlsym(module, procName); }
+
+BOOL FreeLibrary(HINSTANCE module) { return dlclose(module) == 0; }
+
+void FreeLibraryAndExitThread(HMODULE module, DWORD)
+{
+	if (currentThread)
+	{
+		currentThread->freedModule = module;
+		longjmp(currentThread->exitJump, 1);
+	}
+
+	dlclose(module);
+	pthread_exit(nullptr);
+}
+
+HANDLE CreateThread(void*, size_t, LPTHREAD_START_ROUTINE startAddress, LPVOID parameter, DWORD, DWORD* threadId)
+{
+	ThreadState* state = new ThreadState;
+	state->start = startAddress;
+	state->parameter = parameter;
+
+	ThreadHandle* handle = new ThreadHandle;
+
+	if (pthread_create(&handle->thread, nullptr, RunThread, state) != 0)
+	{
+		handle->joined = true;
+		delete handle;
+		delete state;
+		return nullptr;
+	}
+
+	if (threadId) *threadId = 0;
+
+	return handle;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+	ThreadHandle* thread = dynamic_cast<ThreadHandle*>(static_cast<HandleData*>(handle));
+
+	// The events are never signaled by the system, so only the threads can be waited for
+	if (!thread) return WAIT_FAILED;
+
+	if (thread->joined) return WAIT_OBJECT_0;
+
+	if (milliseconds == INFINITE)
+	{
+		if (pthread_join(thread->thread, nullptr) != 0) return WAIT_FAILED;
+	}
+	else
+	{
+		timespec timeout;
+		clock_gettime(CLOCK_REALTIME, &timeout);
+
+		timeout.tv_sec += milliseconds / 1000;
+		timeout.tv_nsec += long(milliseconds % 1000) * 1000000;
+
+		if (timeout.tv_nsec >= 1000000000) { timeout.tv_sec++; timeout.tv_nsec -= 1000000000; }
+
+		if (pthread_timedjoin_np(thread->thread, nullptr, &timeout) != 0) return WAIT_TIMEOUT;
+	}
+
+	thread->joined = true;
+
+	return WAIT_OBJECT_0;
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+	if (!handle || handle == INVALID_HANDLE_VALUE) return FALSE;
+
+	delete static_cast<HandleData*>(handle);
+
+	return TRUE;
+}
+
+DWORD GetCurrentThreadId() { return DWORD(syscall(SYS_gettid)); }
+
+DWORD GetCurrentProcessId() { return DWORD(getpid()); }
+
+DWORD GetLastError() { return lastError; }
+
+void Sleep(DWORD milliseconds) { usleep(useconds_t(milliseconds) * 1000); }
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* count)
+{
+	timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+
+	count->QuadPart = LONGLONG(time.tv_sec) * 1000000000 + time.tv_nsec;
+
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+
+	return TRUE;
+}
+
+HANDLE FindFirstFileA(const char* fileName, WIN32_FIND_DATAA* findData)
+{
+	std::string path = fileName;
+	std::replace(path.begin(), path.end(), '\\', '/');
+
+	size_t slashPos = path.rfind('/');
+	std::string dirPath = slashPos == std::string::npos ? "." : ResolvePath(path.substr(0, slashPos));
+	std::string pattern = slashPos == std::string::npos ? path : path.substr(slashPos + 1);
+
+	DIR* dir = opendir(dirPath.c_str());
+
+	if (!dir)
+	{
+		lastError = ERROR_FILE_NOT_FOUND;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	FindHandle* handle = new FindHandle;
+
+	while (dirent* entry = readdir(dir))
+	{
+		if (fnmatch(pattern.c_str(), entry->d_name, FNM_CASEFOLD) != 0) continue;
+
+		WIN32_FIND_DATAA entryData = { };
+		snprintf(entryData.cFileName, MAX_PATH, "%s", entry->d_name);
+
+		struct stat info;
+		bool isDir = stat((dirPath + "/" + entry->d_name).c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+		entryData.dwFileAttributes = isDir ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+
+		handle->entryList.push_back(entryData);
+	}
+
+	closedir(dir);
+
+	if (handle->entryList.empty())
+	{
+		delete handle;
+		lastError = ERROR_FILE_NOT_FOUND;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	// Sort the files as NTFS lists them
+	std::sort(handle->entryList.begin(), handle->entryList.end(), [](const WIN32_FIND_DATAA& first, const WIN32_FIND_DATAA& second)
+		{ return strcasecmp(first.cFileName, second.cFileName) < 0; });
+
+	*findData = handle->entryList.front();
+
+	return handle;
+}
+
+BOOL FindNextFileA(HANDLE findHandle, WIN32_FIND_DATAA* findData)
+{
+	FindHandle* handle = static_cast<FindHandle*>(static_cast<HandleData*>(findHandle));
+
+	if (handle->nextEntry >= handle->entryList.size())
+	{
+		lastError = ERROR_FILE_NOT_FOUND;
+		return FALSE;
+	}
+
+	*findData = handle->entryList[handle->nextEntry++];
+
+	return TRUE;
+}
+
+BOOL FindClose(HANDLE findHandle) { return CloseHandle(findHandle); }
+
+DWORD GetCurrentDirectoryA(DWORD bufferLength, char* buffer)
+{
+	char path[4096];
+	if (!getcwd(path, sizeof(path))) return 0;
+
+	DWORD length = DWORD(strlen(path));
+
+	// If the buffer is too small, return the required length with the null character
+	if (length >= bufferLength) return length + 1;
+
+	memcpy(buffer, path, length + 1);
+
+	return length;
+}
+
+HANDLE CreateFileA(const char* fileName, DWORD, DWORD, void*, DWORD, DWORD, HANDLE)
+{
+	std::string path = ResolvePath(fileName);
+
+	struct stat info;
+
+	if (stat(path.c_str(), &info) != 0)
+	{
+		lastError = ERROR_FILE_NOT_FOUND;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	if (S_ISDIR(info.st_mode))
+	{
+		lastError = ERROR_NOT_SUPPORTED;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	int descriptor = open(path.c_str(), O_RDONLY);
+
+	if (descriptor < 0)
+	{
+		lastError = ERROR_FILE_NOT_FOUND;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	FileHandle* handle = new FileHandle;
+	handle->descriptor = descriptor;
+
+	return handle;
+}
+
+BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* fileSize)
+{
+	struct stat info;
+
+	if (fstat(static_cast<FileHandle*>(static_cast<HandleData*>(file))->descriptor, &info) != 0) return FALSE;
+
+	fileSize->QuadPart = info.st_size;
+
+	return TRUE;
+}
+
+HANDLE CreateFileMappingA(HANDLE file, void*, DWORD, DWORD, DWORD, const char*)
+{
+	LARGE_INTEGER fileSize;
+
+	// The empty files can't be mapped, as in Windows
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return nullptr;
+
+	MappingHandle* handle = new MappingHandle;
+	handle->descriptor = dup(static_cast<FileHandle*>(static_cast<HandleData*>(file))->descriptor);
+	handle->size = size_t(fileSize.QuadPart);
+
+	return handle;
+}
+
+void* MapViewOfFile(HANDLE mapping, DWORD, DWORD offsetHigh, DWORD offsetLow, size_t bytes)
+{
+	MappingHandle* handle = static_cast<MappingHandle*>(static_cast<HandleData*>(mapping));
+
+	off_t offset = (off_t(offsetHigh) << 32) | offsetLow;
+	size_t size = bytes ? bytes : handle->size - size_t(offset);
+
+	void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, handle->descriptor, offset);
+	if (view == MAP_FAILED) return nullptr;
+
+	std::lock_guard<std::mutex> lock(viewMutex);
+	viewMap[view] = size;
+
+	return view;
+}
+
+BOOL UnmapViewOfFile(const void* address)
+{
+	std::lock_guard<std::mutex> lock(viewMutex);
+
+	auto viewIt = viewMap.find(address);
+	if (viewIt == viewMap.end()) return FALSE;
+
+	munmap(const_cast<void*>(address), viewIt->second);
+	viewMap.erase(viewIt);
+
+	return TRUE;
+}
+
+HANDLE CreateEventA(void*, BOOL, BOOL, const char*) { return new EventHandle; }
+
+BOOL ResetEvent(HANDLE) { return TRUE; }
+
+BOOL CancelIo(HANDLE) { return FALSE; }
+
+BOOL GetOverlappedResult(HANDLE, OVERLAPPED*, DWORD*, BOOL)
+{
+	lastError = ERROR_NOT_SUPPORTED;
+	return FALSE;
+}
+
+BOOL ReadDirectoryChangesW(HANDLE, void*, DWORD, BOOL, DWORD, DWORD*, OVERLAPPED*, void*)
+{
+	lastError = ERROR_NOT_SUPPORTED;
+	return FALSE;
+}
+
+int WideCharToMultiByte(UINT, DWORD, const WCHAR* wideString, int wideLength, char* string, int length, const char*, BOOL*)
+{
+	int count = std::min(wideLength, length);
+
+	for (int i = 0; i < count; i++) string[i] = char(wideString[i]);
+
+	return count;
+}
+
+// ---------------------------------------------------------------------------------------
+// The vessel classes
+// ---------------------------------------------------------------------------------------
+
+VESSEL::VESSEL(OBJHANDLE hVessel, int) : vessel(GetVessel(hVessel)) { }
+
+VESSEL::~VESSEL() { }
+
+OBJHANDLE VESSEL::GetHandle() const { return GetObjectHandle(vessel); }
+
+const char* VESSEL::GetName() const { return vessel->name.c_str(); }
+
+char* VESSEL::GetClassNameA() const { return const_cast<char*>(vessel->className.c_str()); }
+
+double VESSEL::GetSize() const { return vessel->size; }
+
+void VESSEL::SetSize(double size) const { vessel->size = size; }
+
+double VESSEL::GetMass() const
+{
+	double mass = vessel->emptyMass;
+
+	for (const std::unique_ptr<Headless::Propellant>& propellant : vessel->propellantList) mass += propellant->mass;
+
+	return mass;
+}
+
+double VESSEL::GetEmptyMass() const { return vessel->emptyMass; }
+
+void VESSEL::SetEmptyMass(double emptyMass) const { vessel->emptyMass = emptyMass; }
+
+void VESSEL::SetPMI(const VECTOR3&) const { }
+
+void VESSEL::SetCrossSections(const VECTOR3&) const { }
+
+void VESSEL::SetEnableFocus(bool enable) const { vessel->enableFocus = enable; }
+
+void VESSEL::SetTouchdownPoints(const TOUCHDOWNVTX*, DWORD) const { }
+
+PROPELLANT_HANDLE VESSEL::CreatePropellantResource(double maxmass, double mass, double efficiency) const
+{
+	vessel->propellantList.emplace_back(new Headless::Propellant{ maxmass, mass < 0 ? maxmass : mass, efficiency });
+
+	return vessel->propellantList.back().get();
+}
+
+PROPELLANT_HANDLE VESSEL::GetPropellantHandleByIndex(DWORD index) const
+{
+	return index < vessel->propellantList.size() ? vessel->propellantList[index].get() : nullptr;
+}
+
+double VESSEL::GetPropellantMass(PROPELLANT_HANDLE ph) const { return static_cast<Headless::Propellant*>(ph)->mass; }
+
+void VESSEL::SetPropellantMass(PROPELLANT_HANDLE ph, double mass) const
+{
+	Headless::Propellant* propellant = static_cast<Headless::Propellant*>(ph);
+
+	propellant->mass = std::max(0.0, std::min(mass, propellant->maxMass));
+}
+
+double VESSEL::GetPropellantMaxMass(PROPELLANT_HANDLE ph) const { return static_cast<Headless::Propellant*>(ph)->maxMass; }
+
+double VESSEL::GetFuelMass() const { return vessel->propellantList.empty() ? 0 : vessel->propellantList.front()->mass; }
+
+void VESSEL::SetFuelMass(double mass) const { if (!vessel->propellantList.empty()) SetPropellantMass(vessel->propellantList.front().get(), mass); }
+
+double VESSEL::GetMaxFuelMass() const { return vessel->propellantList.empty() ? 0 : vessel->propellantList.front()->maxMass; }
+
+bool VESSEL::GroundContact() const { return vessel->landed; }
+
+int VESSEL::GetFlightStatus() const { return (vessel->landed ? 1 : 0) | (vessel->parentLink ? 2 : 0); }
+
+void VESSEL::GetStatusEx(void* status) const
+{
+	VESSELSTATUS2* vesselStatus = static_cast<VESSELSTATUS2*>(status);
+
+	VECTOR3 pos;
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+
+	vesselStatus->rbody = GetObjectHandle(vessel->body);
+	vesselStatus->base = nullptr;
+	vesselStatus->port = 0;
+	vesselStatus->status = vessel->landed ? 1 : 0;
+	vesselStatus->rpos = pos;
+	vesselStatus->rvel = vessel->vel;
+	vesselStatus->vrot = vessel->landed ? _V(vessel->elevation, 0, 0) : _V(0, 0, 0);
+	vesselStatus->arot = GetEulerAngles(rot);
+
+	if (vessel->landed)
+	{
+		vesselStatus->surf_lng = vessel->lng;
+		vesselStatus->surf_lat = vessel->lat;
+		vesselStatus->surf_hdg = vessel->hdg;
+	}
+	else GetSurfacePos(pos, rot, vesselStatus->surf_lng, vesselStatus->surf_lat, vesselStatus->surf_hdg);
+}
+
+void VESSEL::DefSetStateEx(const void* status) const
+{
+	const VESSELSTATUS2* vesselStatus = static_cast<const VESSELSTATUS2*>(status);
+
+	ObjectData* body = GetObject(vesselStatus->rbody);
+	vessel->body = body && !body->isVessel ? static_cast<BodyData*>(body) : GetWorld().bodyList.front().get();
+
+	if (vesselStatus->status == 1)
+	{
+		vessel->landed = true;
+		vessel->lng = vesselStatus->surf_lng;
+		vessel->lat = vesselStatus->surf_lat;
+		vessel->hdg = vesselStatus->surf_hdg;
+		vessel->elevation = vesselStatus->vrot.x;
+
+		SetLandedFrame(vessel);
+	}
+	else
+	{
+		vessel->landed = false;
+		vessel->pos = vesselStatus->rpos;
+		vessel->vel = vesselStatus->rvel;
+		vessel->rot = GetRotation(vesselStatus->arot);
+	}
+}
+
+bool VESSEL::ParseScenarioLineEx(char* line, void* status) const
+{
+	VESSELSTATUS2* vesselStatus = static_cast<VESSELSTATUS2*>(status);
+
+	std::istringstream lineStream(line);
+	std::string item;
+	lineStream >> item;
+
+	if (!_stricmp(item.c_str(), "STATUS"))
+	{
+		std::string state, body;
+		lineStream >> state >> body;
+
+		vesselStatus->status = _stricmp(state.c_str(), "Landed") ? 0 : 1;
+		vesselStatus->rbody = oapiGetObjectByName(body.c_str());
+	}
+	else if (!_stricmp(item.c_str(), "POS"))
+	{
+		lineStream >> vesselStatus->surf_lng >> vesselStatus->surf_lat;
+
+		vesselStatus->surf_lng *= RAD;
+		vesselStatus->surf_lat *= RAD;
+	}
+	else if (!_stricmp(item.c_str(), "HEADING"))
+	{
+		lineStream >> vesselStatus->surf_hdg;
+		vesselStatus->surf_hdg *= RAD;
+	}
+	else if (!_stricmp(item.c_str(), "ALT")) lineStream >> vesselStatus->vrot.x;
+	else if (!_stricmp(item.c_str(), "ATTACHED")) lineStream >> vessel->attachedItem;
+	else if (!_stricmp(item.c_str(), "RPOS")) lineStream >> vesselStatus->rpos.x >> vesselStatus->rpos.y >> vesselStatus->rpos.z;
+	else if (!_stricmp(item.c_str(), "RVEL")) lineStream >> vesselStatus->rvel.x >> vesselStatus->rvel.y >> vesselStatus->rvel.z;
+	else if (!_stricmp(item.c_str(), "AROT"))
+	{
+		lineStream >> vesselStatus->arot.x >> vesselStatus->arot.y >> vesselStatus->arot.z;
+		vesselStatus->arot = vesselStatus->arot * RAD;
+	}
+	else return false;
+
+	return true;
+}
+
+void VESSEL::GetGlobalPos(VECTOR3& pos) const
+{
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+}
+
+void VESSEL::GetRelativePos(OBJHANDLE hRef, VECTOR3& pos) const
+{
+	VECTOR3 refPos;
+	oapiGetGlobalPos(hRef, &refPos);
+
+	GetGlobalPos(pos);
+	pos -= refPos;
+}
+
+void VESSEL::Global2Local(const VECTOR3& glob, VECTOR3& loc) const
+{
+	VECTOR3 pos;
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+
+	loc = tmul(rot, glob - pos);
+}
+
+void VESSEL::Local2Global(const VECTOR3& loc, VECTOR3& glob) const
+{
+	VECTOR3 pos;
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+
+	glob = pos + mul(rot, loc);
+}
+
+void VESSEL::HorizonRot(const VECTOR3& loc, VECTOR3& hor) const
+{
+	VECTOR3 pos;
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+
+	double lng, lat, hdg;
+	GetSurfacePos(pos, rot, lng, lat, hdg);
+
+	VECTOR3 east, up, north;
+	GetHorizonFrame(lng, lat, east, up, north);
+
+	VECTOR3 glob = mul(rot, loc);
+
+	hor = _V(dotp(glob, east), dotp(glob, up), dotp(glob, north));
+}
+
+OBJHANDLE VESSEL::GetSurfaceRef() const { return GetObjectHandle(vessel->body); }
+
+OBJHANDLE VESSEL::GetEquPos(double& longitude, double& latitude, double& radius) const
+{
+	VECTOR3 pos;
+	MATRIX3 rot;
+	GetFrame(vessel, pos, rot);
+
+	double hdg;
+	GetSurfacePos(pos, rot, longitude, latitude, hdg);
+	radius = length(pos);
+
+	return GetObjectHandle(vessel->body);
+}
+
+ATTACHMENTHANDLE VESSEL::CreateAttachment(bool toparent, const VECTOR3& pos, const VECTOR3& dir, const VECTOR3& rot, const char* id, bool) const
+{
+	Headless::AttachmentData* attachment = new Headless::AttachmentData{ vessel, toparent, pos, dir, rot, id };
+	vessel->attachmentStore.emplace_back(attachment);
+
+	(toparent ? vessel->parentAttachments : vessel->childAttachments).push_back(attachment);
+
+	return attachment;
+}
+
+bool VESSEL::DelAttachment(ATTACHMENTHANDLE attachment) const
+{
+	Headless::AttachmentData* attachmentData = static_cast<Headless::AttachmentData*>(attachment);
+	std::vector<Headless::AttachmentData*>& attachmentList = attachmentData->toParent ? vessel->parentAttachments : vessel->childAttachments;
+
+	auto attachmentIt = std::find(attachmentList.begin(), attachmentList.end(), attachmentData);
+	if (attachmentIt == attachmentList.end()) return false;
+
+	if (attachmentData->peer) Detach(attachmentData->toParent ? attachmentData->peer : attachmentData, 0);
+
+	attachmentList.erase(attachmentIt);
+
+	return true;
+}
+
+void VESSEL::ClearAttachments() const
+{
+	DetachAll(vessel);
+
+	vessel->parentAttachments.clear();
+	vessel->childAttachments.clear();
+}
+
+void VESSEL::SetAttachmentParams(ATTACHMENTHANDLE attachment, const VECTOR3& pos, const VECTOR3& dir, const VECTOR3& rot) const
+{
+	Headless::AttachmentData* attachmentData = static_cast<Headless::AttachmentData*>(attachment);
+
+	attachmentData->pos = pos;
+	attachmentData->dir = dir;
+	attachmentData->rot = rot;
+}
+
+void VESSEL::GetAttachmentParams(ATTACHMENTHANDLE attachment, VECTOR3& pos, VECTOR3& dir, VECTOR3& rot) const
+{
+	const Headless::AttachmentData* attachmentData = static_cast<const Headless::AttachmentData*>(attachment);
+
+	pos = attachmentData->pos;
+	dir = attachmentData->dir;
+	rot = attachmentData->rot;
+}
+
+const char* VESSEL::GetAttachmentId(ATTACHMENTHANDLE attachment) const { return static_cast<Headless::AttachmentData*>(attachment)->id.c_str(); }
+
+OBJHANDLE VESSEL::GetAttachmentStatus(ATTACHMENTHANDLE attachment) const
+{
+	const Headless::AttachmentData* attachmentData = static_cast<const Headless::AttachmentData*>(attachment);
+
+	return attachmentData && attachmentData->peer ? GetObjectHandle(attachmentData->peer->owner) : nullptr;
+}
+
+DWORD VESSEL::AttachmentCount(bool toparent) const { return DWORD((toparent ? vessel->parentAttachments : vessel->childAttachments).size()); }
+
+DWORD VESSEL::GetAttachmentIndex(ATTACHMENTHANDLE attachment) const
+{
+	for (const std::vector<Headless::AttachmentData*>* attachmentList : { &vessel->parentAttachments, &vessel->childAttachments })
+	{
+		auto attachmentIt = std::find(attachmentList->begin(), attachmentList->end(), attachment);
+
+		if (attachmentIt != attachmentList->end()) return DWORD(attachmentIt - attachmentList->begin());
+	}
+
+	throw std::invalid_argument("The attachment isn't one of the vessel's attachments");
+}
+
+ATTACHMENTHANDLE VESSEL::GetAttachmentHandle(bool toparent, DWORD i) const
+{
+	const std::vector<Headless::AttachmentData*>& attachmentList = toparent ? vessel->parentAttachments : vessel->childAttachments;
+
+	return i < attachmentList.size() ? attachmentList[i] : nullptr;
+}
+
+bool VESSEL::AttachChild(OBJHANDLE child, ATTACHMENTHANDLE attachment, ATTACHMENTHANDLE child_attachment) const
+{
+	VesselData* childData = GetVessel(child);
+	Headless::AttachmentData* parentAttachment = static_cast<Headless::AttachmentData*>(attachment);
+	Headless::AttachmentData* childAttachment = static_cast<Headless::AttachmentData*>(child_attachment);
+
+	if (!childData || childData == vessel || !parentAttachment || !childAttachment) return false;
+
+	if (parentAttachment->owner != vessel || parentAttachment->toParent || parentAttachment->peer) return false;
+
+	if (childAttachment->owner != childData || !childAttachment->toParent || childAttachment->peer || childData->parentLink) return false;
+
+	// The child can't be attached to its own child
+	for (const VesselData* parent = vessel; parent->parentLink; parent = parent->parentLink->peer->owner)
+		if (parent->parentLink->peer->owner == childData) return false;
+
+	Attach(parentAttachment, childAttachment);
+
+	return true;
+}
+
+bool VESSEL::DetachChild(ATTACHMENTHANDLE attachment, double vel) const
+{
+	Headless::AttachmentData* attachmentData = static_cast<Headless::AttachmentData*>(attachment);
+
+	if (!attachmentData || attachmentData->owner != vessel || attachmentData->toParent || !attachmentData->peer) return false;
+
+	Detach(attachmentData, vel);
+
+	return true;
+}
+
+UINT VESSEL::AddMesh(const char* meshname, const VECTOR3* ofs) const
+{
+	// Use the first deleted index, as Orbiter does
+	UINT index = 0;
+	while (index < vessel->meshList.size() && !vessel->meshList[index].deleted) index++;
+
+	return InsertMesh(meshname, index, ofs);
+}
+
+UINT VESSEL::AddMesh(MESHHANDLE hMesh, const VECTOR3* ofs) const { return AddMesh(static_cast<std::string*>(hMesh)->c_str(), ofs); }
+
+UINT VESSEL::InsertMesh(const char* meshname, UINT idx, const VECTOR3* ofs) const
+{
+	if (idx >= vessel->meshList.size()) vessel->meshList.resize(idx + 1, { "", { }, MESHVIS_EXTERNAL, true });
+
+	vessel->meshList[idx] = { meshname, ofs ? *ofs : _V(0, 0, 0), MESHVIS_EXTERNAL, false };
+
+	return idx;
+}
+
+UINT VESSEL::InsertMesh(MESHHANDLE hMesh, UINT idx, const VECTOR3* ofs) const { return InsertMesh(static_cast<std::string*>(hMesh)->c_str(), idx, ofs); }
+
+bool VESSEL::DelMesh(UINT idx, bool) const
+{
+	if (idx >= vessel->meshList.size() || vessel->meshList[idx].deleted) return false;
+
+	vessel->meshList[idx].deleted = true;
+
+	return true;
+}
+
+void VESSEL::ClearMeshes() const { vessel->meshList.clear(); }
+
+void VESSEL::ClearMeshes(bool) const { ClearMeshes(); }
+
+void VESSEL::SetMeshVisibilityMode(UINT idx, WORD mode) const { if (idx < vessel->meshList.size()) vessel->meshList[idx].visibility = mode; }
+
+bool VESSEL::ShiftMesh(UINT idx, const VECTOR3& ofs) const
+{
+	if (idx >= vessel->meshList.size() || vessel->meshList[idx].deleted) return false;
+
+	vessel->meshList[idx].ofs += ofs;
+
+	return true;
+}
+
+UINT VESSEL::GetMeshCount() const { return UINT(vessel->meshList.size()); }
+
+VESSEL2::VESSEL2(OBJHANDLE hVessel, int fmodel) : VESSEL(hVessel, fmodel) { }
+
+void VESSEL2::clbkSetClassCaps(FILEHANDLE) { }
+
+void VESSEL2::clbkSaveState(FILEHANDLE scn)
+{
+	VESSELSTATUS2 status = { };
+	status.version = 2;
+	GetStatusEx(&status);
+
+	char value[256];
+
+	if (status.status == 1)
+	{
+		oapiWriteScenario_string(scn, "STATUS", "Landed Moon");
+
+		snprintf(value, sizeof(value), "%0.10f %0.10f", status.surf_lng * DEG, status.surf_lat * DEG);
+		oapiWriteScenario_string(scn, "POS", value);
+
+		oapiWriteScenario_float(scn, "HEADING", status.surf_hdg * DEG);
+	}
+	else
+	{
+		oapiWriteScenario_string(scn, "STATUS", "Orbiting Moon");
+		oapiWriteScenario_vec(scn, "RPOS", status.rpos);
+		oapiWriteScenario_vec(scn, "RVEL", status.rvel);
+		oapiWriteScenario_vec(scn, "AROT", status.arot * DEG);
+	}
+}
+
+void VESSEL2::clbkLoadStateEx(FILEHANDLE scn, void* status)
+{
+	char* line;
+
+	while (oapiReadScenario_nextline(scn, line)) ParseScenarioLineEx(line, status);
+}
+
+void VESSEL2::clbkSetStateEx(const void* status) { DefSetStateEx(status); }
+
+void VESSEL2::clbkPostCreation() { }
+
+void VESSEL2::clbkPreStep(double, double, double) { }
+
+void VESSEL2::clbkPostStep(double, double, double) { }
+
+int VESSEL2::clbkConsumeBufferedKey(DWORD, bool, char*) { return 0; }
+
+VESSEL3::VESSEL3(OBJHANDLE hVessel, int fmodel) : VESSEL2(hVessel, fmodel) { }
+
+VESSEL4::VESSEL4(OBJHANDLE hVessel, int fmodel) : VESSEL3(hVessel, fmodel) { }
+
+// ---------------------------------------------------------------------------------------
+// The API functions
+// ---------------------------------------------------------------------------------------
+
+void oapiWriteLog(const char* line)
+{
+	World& world = GetWorld();
+	std::lock_guard<std::mutex> lock(world.logMutex);
+
+	if (!world.logFile) world.logFile = fopen("Orbiter.log", "w");
+
+	if (world.logFile)
+	{
+		fprintf(world.logFile, "%s\n", line);
+		fflush(world.logFile);
+	}
+
+	if (world.logFunction) world.logFunction(line);
+}
+
+void oapiWriteLogV(const char* format, ...)
+{
+	char line[1024];
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+
+	oapiWriteLog(line);
+}
+
+double oapiGetSimTime() { return GetWorld().simTime; }
+
+double oapiGetSimStep() { return GetWorld().simStep; }
+
+double oapiGetSysTime() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - GetWorld().startTime).count(); }
+
+DWORD oapiGetVesselCount() { return DWORD(GetWorld().vesselList.size()); }
+
+OBJHANDLE oapiGetVesselByIndex(int index)
+{
+	World& world = GetWorld();
+
+	return index >= 0 && size_t(index) < world.vesselList.size() ? GetObjectHandle(world.vesselList[index]) : nullptr;
+}
+
+OBJHANDLE oapiGetVesselByName(const char* name)
+{
+	for (VesselData* vessel : GetWorld().vesselList) if (!strcasecmp(vessel->name.c_str(), name)) return GetObjectHandle(vessel);
+
+	return nullptr;
+}
+
+VESSEL* oapiGetVesselInterface(OBJHANDLE hVessel)
+{
+	VesselData* vessel = GetVessel(hVessel);
+
+	return vessel ? vessel->vessel : nullptr;
+}
+
+OBJHANDLE oapiGetFocusObject() { return GetObjectHandle(GetWorld().focus); }
+
+VESSEL* oapiGetFocusInterface() { return GetWorld().focus ? GetWorld().focus->vessel : nullptr; }
+
+OBJHANDLE oapiSetFocusObject(OBJHANDLE hVessel)
+{
+	World& world = GetWorld();
+	VesselData* vessel = GetVessel(hVessel);
+
+	if (!vessel || !vessel->enableFocus) return nullptr;
+
+	OBJHANDLE oldFocus = GetObjectHandle(world.focus);
+	world.focus = vessel;
+
+	return oldFocus;
+}
+
+bool oapiIsVessel(OBJHANDLE hVessel)
+{
+	for (VesselData* vessel : GetWorld().vesselList) if (GetObjectHandle(vessel) == hVessel) return true;
+
+	return false;
+}
+
+namespace
+{
+	// Creates the vessel and calls clbkSetClassCaps. The vessel isn't added to the vessel list until its state is set
+	VesselData* CreateVessel(const char* name, const char* classname)
+	{
+		World& world = GetWorld();
+
+		if (!name || !*name || oapiGetVesselByName(name))
+		{
+			oapiWriteLogV("Headless: Couldn't create the vessel %s, as the name is used", name ? name : "");
+			return nullptr;
+		}
+
+		std::string className = classname;
+		std::replace(className.begin(), className.end(), '/', '\\');
+
+		std::string configPath = "Vessels/" + className + ".cfg";
+		FILEHANDLE cfg = oapiOpenFile(configPath.c_str(), FILE_IN_ZEROONFAIL, CONFIG);
+
+		if (!cfg)
+		{
+			configPath = className + ".cfg";
+			cfg = oapiOpenFile(configPath.c_str(), FILE_IN_ZEROONFAIL, CONFIG);
+		}
+
+		if (!cfg)
+		{
+			oapiWriteLogV("Headless: Couldn't find the vessel class %s", classname);
+			return nullptr;
+		}
+
+		char value[256];
+		ModuleData* module = nullptr;
+
+		if (oapiReadItem_string(cfg, "Module", value))
+		{
+			module = LoadModule(value);
+
+			if (!module || !module->init)
+			{
+				oapiCloseFile(cfg, FILE_IN);
+				return nullptr;
+			}
+		}
+
+		VesselData* vessel = new VesselData;
+		vessel->isVessel = true;
+		vessel->name = name;
+		vessel->className = className;
+		vessel->module = module;
+		vessel->body = world.bodyList.front().get();
+
+		vessel->vessel = module ? module->init(GetObjectHandle(vessel), 1) : new VESSEL2(GetObjectHandle(vessel), 1);
+
+		// Read the generic items before the class reads its own
+		double size, mass;
+		if (oapiReadItem_float(cfg, "Size", size)) vessel->size = size;
+		if (oapiReadItem_float(cfg, "Mass", mass)) vessel->emptyMass = mass;
+		if (oapiReadItem_string(cfg, "MeshName", value)) vessel->vessel->AddMesh(value);
+
+		static_cast<VESSEL2*>(vessel->vessel)->clbkSetClassCaps(cfg);
+		oapiCloseFile(cfg, FILE_IN);
+
+		return vessel;
+	}
+
+	void AddVessel(VesselData* vessel)
+	{
+		World& world = GetWorld();
+
+		world.vesselList.push_back(vessel);
+		if (!world.focus && vessel->enableFocus) world.focus = vessel;
+	}
+}
+
+OBJHANDLE oapiCreateVesselEx(const char* name, const char* classname, const void* status)
+{
+	VesselData* vessel = CreateVessel(name, classname);
+
+	if (!vessel) return nullptr;
+
+	VESSEL2* vessel2 = static_cast<VESSEL2*>(vessel->vessel);
+
+	vessel2->clbkSetStateEx(status);
+
+	AddVessel(vessel);
+
+	vessel2->clbkPostCreation();
+
+	return GetObjectHandle(vessel);
+}
+
+bool oapiDeleteVessel(OBJHANDLE hVessel, OBJHANDLE hAlternativeCameraTarget)
+{
+	World& world = GetWorld();
+	VesselData* vessel = GetVessel(hVessel);
+
+	if (!vessel || vessel->killed) return false;
+
+	vessel->killed = true;
+
+	if (world.focus == vessel)
+	{
+		VesselData* alternative = GetVessel(hAlternativeCameraTarget);
+		world.focus = alternative && !alternative->killed ? alternative : nullptr;
+	}
+
+	return true;
+}
+
+OBJHANDLE oapiGetObjectByName(const char* name)
+{
+	if (OBJHANDLE hVessel = oapiGetVesselByName(name)) return hVessel;
+
+	for (const std::unique_ptr<BodyData>& body : GetWorld().bodyList) if (!strcasecmp(body->name.c_str(), name)) return GetObjectHandle(body.get());
+
+	return nullptr;
+}
+
+void oapiGetObjectName(OBJHANDLE hObj, char* name, int n) { snprintf(name, size_t(n), "%s", GetObject(hObj)->name.c_str()); }
+
+double oapiGetMass(OBJHANDLE hObj)
+{
+	ObjectData* object = GetObject(hObj);
+
+	return object->isVessel ? static_cast<VesselData*>(object)->vessel->GetMass() : static_cast<BodyData*>(object)->mass;
+}
+
+double oapiGetSize(OBJHANDLE hObj) { return GetObject(hObj)->size; }
+
+void oapiGetGlobalPos(OBJHANDLE hObj, VECTOR3* pos)
+{
+	VesselData* vessel = GetVessel(hObj);
+
+	if (vessel)
+	{
+		MATRIX3 rot;
+		GetFrame(vessel, *pos, rot);
+	}
+	else *pos = _V(0, 0, 0);
+}
+
+void oapiGetRelativePos(OBJHANDLE hObj, OBJHANDLE hRef, VECTOR3* pos)
+{
+	VECTOR3 refPos;
+	oapiGetGlobalPos(hObj, pos);
+	oapiGetGlobalPos(hRef, &refPos);
+
+	*pos -= refPos;
+}
+
+void oapiEquToGlobal(OBJHANDLE, double lng, double lat, double rad, VECTOR3* glob)
+{
+	VECTOR3 east, up, north;
+	GetHorizonFrame(lng, lat, east, up, north);
+
+	*glob = up * rad;
+}
+
+MESHHANDLE oapiLoadMeshGlobal(const char* fname)
+{
+	World& world = GetWorld();
+	std::lock_guard<std::mutex> lock(world.meshMutex);
+
+	std::string key = ToLower(fname);
+	std::replace(key.begin(), key.end(), '\\', '/');
+
+	auto meshIt = world.meshMap.find(key);
+	if (meshIt != world.meshMap.end()) return meshIt->second.get();
+
+	if (!PathExists(ResolvePath(std::string("Meshes/") + fname + ".msh")))
+	{
+		oapiWriteLogV("Headless: Couldn't find the mesh %s", fname);
+		return nullptr;
+	}
+
+	return (world.meshMap[key] = std::unique_ptr<std::string>(new std::string(fname))).get();
+}
+
+FILEHANDLE oapiOpenFile(const char* fname, FileAccessMode mode, PathRoot root)
+{
+	std::string path = std::string(GetRootDir(root)) + fname;
+	std::replace(path.begin(), path.end(), '\\', '/');
+
+	FileData* fileData = new FileData;
+	fileData->mode = mode;
+
+	if (mode == FILE_IN || mode == FILE_IN_ZEROONFAIL)
+	{
+		std::ifstream file(ResolvePath(path));
+
+		if (!file.is_open() && mode == FILE_IN_ZEROONFAIL)
+		{
+			delete fileData;
+			return nullptr;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (!line.empty() && line.back() == '\r') line.pop_back();
+			fileData->lineList.push_back(line);
+		}
+	}
+	else
+	{
+		// Resolve the directory, and the file if it exists
+		size_t slashPos = path.rfind('/');
+		std::string resolved = slashPos == std::string::npos ? path : ResolvePath(path.substr(0, slashPos)) + path.substr(slashPos);
+
+		if (!PathExists(resolved)) resolved = ResolvePath(path);
+		else resolved = ResolvePath(resolved);
+
+		fileData->file = fopen(resolved.c_str(), mode == FILE_APP ? "a" : "w");
+
+		if (!fileData->file)
+		{
+			delete fileData;
+			return nullptr;
+		}
+	}
+
+	return fileData;
+}
+
+void oapiCloseFile(FILEHANDLE f, FileAccessMode)
+{
+	FileData* fileData = static_cast<FileData*>(f);
+	if (!fileData) return;
+
+	if (fileData->file) fclose(fileData->file);
+
+	delete fileData;
+}
+
+bool oapiReadItem_string(FILEHANDLE f, const char* item, char* string)
+{
+	std::string value;
+	if (!FindItem(f, item, value)) return false;
+
+	memcpy(string, value.c_str(), value.size() + 1);
+
+	return true;
+}
+
+bool oapiReadItem_float(FILEHANDLE f, const char* item, double& val)
+{
+	std::string value;
+
+	return FindItem(f, item, value) && sscanf(value.c_str(), "%lf", &val) == 1;
+}
+
+bool oapiReadItem_int(FILEHANDLE f, const char* item, int& val)
+{
+	std::string value;
+
+	return FindItem(f, item, value) && sscanf(value.c_str(), "%d", &val) == 1;
+}
+
+bool oapiReadItem_bool(FILEHANDLE f, const char* item, bool& val)
+{
+	std::string value;
+	if (!FindItem(f, item, value)) return false;
+
+	val = !_strnicmp(value.c_str(), "true", 4);
+
+	return true;
+}
+
+bool oapiReadItem_vec(FILEHANDLE f, const char* item, VECTOR3& val)
+{
+	std::string value;
+
+	return FindItem(f, item, value) && sscanf(value.c_str(), "%lf %lf %lf", &val.x, &val.y, &val.z) == 3;
+}
+
+void oapiWriteItem_string(FILEHANDLE f, const char* item, const char* string) { WriteFileLine(f, std::string(item) + " = " + string); }
+
+void oapiWriteItem_float(FILEHANDLE f, const char* item, double val)
+{
+	char value[64];
+	snprintf(value, sizeof(value), "%g", val);
+
+	oapiWriteItem_string(f, item, value);
+}
+
+void oapiWriteItem_int(FILEHANDLE f, const char* item, int val) { oapiWriteItem_string(f, item, std::to_string(val).c_str()); }
+
+void oapiWriteItem_bool(FILEHANDLE f, const char* item, bool val) { oapiWriteItem_string(f, item, val ? "TRUE" : "FALSE"); }
+
+void oapiWriteItem_vec(FILEHANDLE f, const char* item, const VECTOR3& val)
+{
+	char value[128];
+	snprintf(value, sizeof(value), "%g %g %g", val.x, val.y, val.z);
+
+	oapiWriteItem_string(f, item, value);
+}
+
+void oapiWriteLine(FILEHANDLE f, const char* line) { WriteFileLine(f, line); }
+
+bool oapiReadScenario_nextline(FILEHANDLE scn, char*& line)
+{
+	FileData* fileData = static_cast<FileData*>(scn);
+
+	if (!fileData || fileData->nextLine >= fileData->lineList.size()) return false;
+
+	fileData->currentLine = TrimString(fileData->lineList[fileData->nextLine++]);
+
+	// The vessel's block ends with END
+	if (!_strnicmp(fileData->currentLine.c_str(), "END", 3)) return false;
+
+	line = &fileData->currentLine[0];
+
+	return true;
+}
+
+void oapiWriteScenario_string(FILEHANDLE scn, const char* item, const char* string) { WriteFileLine(scn, std::string("  ") + item + " " + string); }
+
+void oapiWriteScenario_int(FILEHANDLE scn, const char* item, int i) { oapiWriteScenario_string(scn, item, std::to_string(i).c_str()); }
+
+void oapiWriteScenario_float(FILEHANDLE scn, const char* item, double d)
+{
+	char value[64];
+	snprintf(value, sizeof(value), "%0.4f", d);
+
+	oapiWriteScenario_string(scn, item, value);
+}
+
+void oapiWriteScenario_vec(FILEHANDLE scn, const char* item, const VECTOR3& vec)
+{
+	char value[128];
+	snprintf(value, sizeof(value), "%0.4f %0.4f %0.4f", vec.x, vec.y, vec.z);
+
+	oapiWriteScenario_string(scn, item, value);
+}
+
+// ---------------------------------------------------------------------------------------
+// The simulation control
+// ---------------------------------------------------------------------------------------
+
+void Headless::RegisterModule(const char* name, InitFunction init, ExitFunction exit)
+{
+	std::string key = ToLower(name);
+	std::replace(key.begin(), key.end(), '\\', '/');
+
+	ModuleData& module = GetWorld().registeredModules[key];
+	module.init = init;
+	module.exit = exit;
+}
+
+void Headless::SetLogFunction(LogFunction function)
+{
+	World& world = GetWorld();
+	std::lock_guard<std::mutex> lock(world.logMutex);
+
+	world.logFunction = function;
+}
+
+void Headless::Step(double simdt)
+{
+	World& world = GetWorld();
+
+	DeleteKilledVessels();
+
+	world.simStep = simdt;
+	world.simTime += simdt;
+
+	double mjd = 51544.5 + world.simTime / 86400;
+
+	// The vessels created in this step are stepped in the next one
+	world.stepList = world.vesselList;
+
+	for (VesselData* vessel : world.stepList) if (!vessel->killed) static_cast<VESSEL2*>(vessel->vessel)->clbkPreStep(world.simTime, simdt, mjd);
+
+	for (VesselData* vessel : world.stepList) if (!vessel->killed) static_cast<VESSEL2*>(vessel->vessel)->clbkPostStep(world.simTime, simdt, mjd);
+}
+
+int Headless::LoadScenario(const char* fileName)
+{
+	FILEHANDLE scn = oapiOpenFile(fileName, FILE_IN_ZEROONFAIL, SCENARIOS);
+
+	if (!scn)
+	{
+		oapiWriteLogV("Headless: Couldn't open the scenario %s", fileName);
+		return 0;
+	}
+
+	FileData* fileData = static_cast<FileData*>(scn);
+	std::vector<VesselData*> loadedList;
+	bool shipsBlock = false;
+
+	while (fileData->nextLine < fileData->lineList.size())
+	{
+		std::string line = TrimString(fileData->lineList[fileData->nextLine++]);
+
+		if (!shipsBlock) { shipsBlock = !_stricmp(line.c_str(), "BEGIN_SHIPS"); continue; }
+
+		if (!_stricmp(line.c_str(), "END_SHIPS")) break;
+
+		// Each vessel block starts with Name:Class, and the vessel reads its items until END
+		size_t colonPos = line.find(':');
+		if (colonPos == std::string::npos) continue;
+
+		VesselData* vessel = CreateVessel(line.substr(0, colonPos).c_str(), line.substr(colonPos + 1).c_str());
+
+		VESSELSTATUS2 status = { };
+		status.version = 2;
+
+		if (vessel) static_cast<VESSEL2*>(vessel->vessel)->clbkLoadStateEx(scn, &status);
+
+		// Skip the rest of the block, if the vessel wasn't created or didn't read it until END
+		char* blockLine;
+		if (_strnicmp(TrimString(fileData->lineList[fileData->nextLine - 1]).c_str(), "END", 3)) while (oapiReadScenario_nextline(scn, blockLine));
+
+		if (!vessel) continue;
+
+		vessel->vessel->DefSetStateEx(&status);
+
+		AddVessel(vessel);
+		loadedList.push_back(vessel);
+	}
+
+	oapiCloseFile(scn, FILE_IN);
+
+	// The children are attached after all the vessels are loaded, as their parents can be loaded after them
+	for (VesselData* vessel : loadedList)
+	{
+		if (vessel->attachedItem.empty()) continue;
+
+		// The item is <child attachment>:<parent attachment>,<parent name>
+		int childIndex = 0, parentIndex = 0;
+		size_t commaPos = vessel->attachedItem.find(',');
+
+		OBJHANDLE hParent = commaPos == std::string::npos ? nullptr : oapiGetVesselByName(&vessel->attachedItem[commaPos + 1]);
+
+		if (!hParent || sscanf(vessel->attachedItem.c_str(), "%d:%d", &childIndex, &parentIndex) != 2)
+		{
+			oapiWriteLogV("Headless: Couldn't attach the vessel %s to %s", vessel->name.c_str(), vessel->attachedItem.c_str());
+			continue;
+		}
+
+		VESSEL* parent = oapiGetVesselInterface(hParent);
+
+		parent->AttachChild(GetObjectHandle(vessel), parent->GetAttachmentHandle(false, parentIndex), vessel->vessel->GetAttachmentHandle(true, childIndex));
+
+		vessel->attachedItem.clear();
+	}
+
+	for (VesselData* vessel : loadedList) static_cast<VESSEL2*>(vessel->vessel)->clbkPostCreation();
+
+	return int(loadedList.size());
+}
+
+void Headless::CloseSimulation()
+{
+	World& world = GetWorld();
+
+	// The vessels deleted while deleting the others are deleted in the next pass
+	for (int pass = 0; pass < 8 && !world.vesselList.empty(); pass++)
+	{
+		for (VesselData* vessel : world.vesselList) vessel->killed = true;
+
+		DeleteKilledVessels();
+	}
+
+	typedef void (*ModuleFunction)(HINSTANCE);
+
+	for (auto& module : world.moduleMap)
+	{
+		ModuleFunction ExitModule = reinterpret_cast<ModuleFunction>(GetProcAddress(module.second->library, "ExitModule"));
+
+		if (ExitModule) ExitModule(module.second->library);
+
+		FreeLibrary(module.second->library);
+	}
+
+	world.moduleMap.clear();
+	world.focus = nullptr;
+	world.simTime = 0;
+	world.simStep = 0;
+}
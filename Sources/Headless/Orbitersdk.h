@@ -0,0 +1,451 @@
+// =======================================================================================
+// Orbitersdk.h : A headless stand-in for the subset of the Orbiter SDK which UCSO uses.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// This header replaces the Orbiter SDK in the headless build, so the UCSO modules can be built and measured on Linux.
+// It declares only what UCSO uses, with the same names and signatures as the SDK, and the few Win32 functions which UCSO calls.
+// The vessel list, the attachments, the states and the files are implemented in Orbiter.cpp. The costs follow Orbiter:
+// the vessel list is indexed, the name lookup is a linear search, and the configuration files are read from the disk on every open.
+
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstdarg>
+#include <cmath>
+#include <strings.h>
+
+#define OAPIFUNC __attribute__((visibility("default")))
+#define DLLCLBK extern "C" __attribute__((visibility("default")))
+#define WINAPI
+#define CALLBACK
+
+// ---------------------------------------------------------------------------------------
+// The Win32 subset
+// ---------------------------------------------------------------------------------------
+
+typedef uint32_t DWORD;
+typedef int BOOL;
+typedef unsigned int UINT;
+typedef long LONG;
+typedef unsigned short WORD;
+typedef unsigned char BYTE;
+typedef char CHAR;
+typedef wchar_t WCHAR;
+typedef int64_t LONGLONG;
+typedef uint64_t ULONGLONG;
+typedef void* LPVOID;
+typedef void* HANDLE;
+typedef void* HINSTANCE;
+typedef void* HMODULE;
+typedef void* FARPROC;
+typedef uintptr_t WPARAM;
+typedef intptr_t LPARAM;
+
+typedef union
+{
+	struct { DWORD LowPart; LONG HighPart; };
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef DWORD (*LPTHREAD_START_ROUTINE)(LPVOID);
+
+#define TRUE 1
+#define FALSE 0
+#define MAX_PATH 260
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+#define WAIT_TIMEOUT 258
+#define WAIT_FAILED 0xFFFFFFFF
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(intptr_t(-1)))
+
+#define ERROR_FILE_NOT_FOUND 2L
+#define ERROR_NOT_SUPPORTED 50L
+#define ERROR_IO_INCOMPLETE 996L
+
+#define GENERIC_READ 0x80000000
+#define FILE_LIST_DIRECTORY 1
+#define FILE_SHARE_READ 1
+#define FILE_SHARE_WRITE 2
+#define FILE_SHARE_DELETE 4
+#define OPEN_EXISTING 3
+#define FILE_ATTRIBUTE_DIRECTORY 0x10
+#define FILE_ATTRIBUTE_NORMAL 0x80
+#define FILE_FLAG_BACKUP_SEMANTICS 0x02000000
+#define FILE_FLAG_OVERLAPPED 0x40000000
+#define PAGE_READONLY 2
+#define FILE_MAP_READ 4
+
+#define FILE_ACTION_ADDED 1
+#define FILE_ACTION_REMOVED 2
+#define FILE_ACTION_MODIFIED 3
+#define FILE_ACTION_RENAMED_OLD_NAME 4
+#define FILE_ACTION_RENAMED_NEW_NAME 5
+#define FILE_NOTIFY_CHANGE_FILE_NAME 1
+#define FILE_NOTIFY_CHANGE_DIR_NAME 2
+#define FILE_NOTIFY_CHANGE_LAST_WRITE 0x10
+#define CP_ACP 0
+
+struct EXCEPTION_POINTERS;
+typedef void (*_se_translator_function)(unsigned int, EXCEPTION_POINTERS*);
+
+typedef struct
+{
+	DWORD dwFileAttributes;
+	char cFileName[MAX_PATH];
+} WIN32_FIND_DATAA;
+
+typedef struct
+{
+	uintptr_t Internal;
+	uintptr_t InternalHigh;
+	DWORD Offset;
+	DWORD OffsetHigh;
+	HANDLE hEvent;
+} OVERLAPPED;
+
+typedef struct
+{
+	DWORD NextEntryOffset;
+	DWORD Action;
+	DWORD FileNameLength;
+	WCHAR FileName[1];
+} FILE_NOTIFY_INFORMATION;
+
+// The modules are loaded with dlopen, so the DLL paths of the sources work with the .dll files of the headless build
+OAPIFUNC HINSTANCE LoadLibraryA(const char* fileName);
+OAPIFUNC FARPROC GetProcAddress(HINSTANCE module, const char* procName);
+OAPIFUNC BOOL FreeLibrary(HINSTANCE module);
+OAPIFUNC void FreeLibraryAndExitThread(HMODULE module, DWORD exitCode);
+
+OAPIFUNC HANDLE CreateThread(void* attributes, size_t stackSize, LPTHREAD_START_ROUTINE startAddress, LPVOID parameter, DWORD flags, DWORD* threadId);
+OAPIFUNC DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+OAPIFUNC BOOL CloseHandle(HANDLE handle);
+OAPIFUNC DWORD GetCurrentThreadId();
+OAPIFUNC DWORD GetCurrentProcessId();
+OAPIFUNC DWORD GetLastError();
+OAPIFUNC void Sleep(DWORD milliseconds);
+
+OAPIFUNC BOOL QueryPerformanceCounter(LARGE_INTEGER* count);
+OAPIFUNC BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+
+OAPIFUNC HANDLE FindFirstFileA(const char* fileName, WIN32_FIND_DATAA* findData);
+OAPIFUNC BOOL FindNextFileA(HANDLE findHandle, WIN32_FIND_DATAA* findData);
+OAPIFUNC BOOL FindClose(HANDLE findHandle);
+OAPIFUNC DWORD GetCurrentDirectoryA(DWORD bufferLength, char* buffer);
+
+// Only the files can be opened. The directories can't be watched, so CreateFileA fails for them with ERROR_NOT_SUPPORTED
+OAPIFUNC HANDLE CreateFileA(const char* fileName, DWORD access, DWORD shareMode, void* security, DWORD creation, DWORD flags, HANDLE templateFile);
+OAPIFUNC BOOL GetFileSizeEx(HANDLE file, LARGE_INTEGER* fileSize);
+OAPIFUNC HANDLE CreateFileMappingA(HANDLE file, void* security, DWORD protect, DWORD maximumSizeHigh, DWORD maximumSizeLow, const char* name);
+OAPIFUNC void* MapViewOfFile(HANDLE mapping, DWORD access, DWORD offsetHigh, DWORD offsetLow, size_t bytes);
+OAPIFUNC BOOL UnmapViewOfFile(const void* address);
+
+OAPIFUNC HANDLE CreateEventA(void* security, BOOL manualReset, BOOL initialState, const char* name);
+OAPIFUNC BOOL ResetEvent(HANDLE event);
+OAPIFUNC BOOL CancelIo(HANDLE file);
+OAPIFUNC BOOL GetOverlappedResult(HANDLE file, OVERLAPPED* overlapped, DWORD* bytes, BOOL wait);
+OAPIFUNC BOOL ReadDirectoryChangesW(HANDLE directory, void* buffer, DWORD bufferLength, BOOL watchSubtree, DWORD filter, DWORD* bytes,
+	OVERLAPPED* overlapped, void* completionRoutine);
+OAPIFUNC int WideCharToMultiByte(UINT codePage, DWORD flags, const WCHAR* wideString, int wideLength, char* string, int length,
+	const char* defaultChar, BOOL* usedDefaultChar);
+
+// The structured exceptions don't exist on Linux. The invalid attachments throw a C++ exception instead
+inline _se_translator_function _set_se_translator(_se_translator_function) { return nullptr; }
+
+inline char* _strdup(const char* string) { return strdup(string); }
+inline int _stricmp(const char* first, const char* second) { return strcasecmp(first, second); }
+inline int _strnicmp(const char* first, const char* second, size_t count) { return strncasecmp(first, second, count); }
+
+// ---------------------------------------------------------------------------------------
+// The Orbiter types
+// ---------------------------------------------------------------------------------------
+
+const double PI = 3.14159265358979323846;
+const double PI05 = 1.57079632679489661923;
+const double PI2 = 6.28318530717958647693;
+const double RAD = PI / 180.0;
+const double DEG = 180.0 / PI;
+const double G = 9.81;           // The gravitational acceleration at the Earth mean radius
+const double GGRAV = 6.67259e-11;
+
+typedef void* OBJHANDLE;
+typedef void* FILEHANDLE;
+typedef void* ATTACHMENTHANDLE;
+typedef void* MESHHANDLE;
+typedef void* PROPELLANT_HANDLE;
+
+typedef union
+{
+	double data[3];
+	struct { double x, y, z; };
+} VECTOR3;
+
+typedef union
+{
+	double data[9];
+	struct { double m11, m12, m13, m21, m22, m23, m31, m32, m33; };
+} MATRIX3;
+
+inline VECTOR3 _V(double x, double y, double z) { VECTOR3 v = { { x, y, z } }; return v; }
+
+inline MATRIX3 _M(double m11, double m12, double m13, double m21, double m22, double m23, double m31, double m32, double m33)
+{
+	MATRIX3 m = { { m11, m12, m13, m21, m22, m23, m31, m32, m33 } };
+	return m;
+}
+
+inline VECTOR3 operator+(const VECTOR3& a, const VECTOR3& b) { return _V(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline VECTOR3 operator-(const VECTOR3& a, const VECTOR3& b) { return _V(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline VECTOR3 operator-(const VECTOR3& a) { return _V(-a.x, -a.y, -a.z); }
+inline VECTOR3 operator*(const VECTOR3& a, double f) { return _V(a.x * f, a.y * f, a.z * f); }
+inline VECTOR3 operator/(const VECTOR3& a, double f) { return _V(a.x / f, a.y / f, a.z / f); }
+inline VECTOR3& operator+=(VECTOR3& a, const VECTOR3& b) { a.x += b.x; a.y += b.y; a.z += b.z; return a; }
+inline VECTOR3& operator-=(VECTOR3& a, const VECTOR3& b) { a.x -= b.x; a.y -= b.y; a.z -= b.z; return a; }
+
+inline double dotp(const VECTOR3& a, const VECTOR3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline VECTOR3 crossp(const VECTOR3& a, const VECTOR3& b) { return _V(a.y * b.z - b.y * a.z, a.z * b.x - b.z * a.x, a.x * b.y - b.x * a.y); }
+inline double length(const VECTOR3& a) { return sqrt(dotp(a, a)); }
+inline void normalise(VECTOR3& a) { a = a / length(a); }
+
+inline MATRIX3 mul(const MATRIX3& a, const MATRIX3& b)
+{
+	return _M(
+		a.m11 * b.m11 + a.m12 * b.m21 + a.m13 * b.m31, a.m11 * b.m12 + a.m12 * b.m22 + a.m13 * b.m32, a.m11 * b.m13 + a.m12 * b.m23 + a.m13 * b.m33,
+		a.m21 * b.m11 + a.m22 * b.m21 + a.m23 * b.m31, a.m21 * b.m12 + a.m22 * b.m22 + a.m23 * b.m32, a.m21 * b.m13 + a.m22 * b.m23 + a.m23 * b.m33,
+		a.m31 * b.m11 + a.m32 * b.m21 + a.m33 * b.m31, a.m31 * b.m12 + a.m32 * b.m22 + a.m33 * b.m32, a.m31 * b.m13 + a.m32 * b.m23 + a.m33 * b.m33);
+}
+
+inline VECTOR3 mul(const MATRIX3& a, const VECTOR3& b)
+{
+	return _V(a.m11 * b.x + a.m12 * b.y + a.m13 * b.z, a.m21 * b.x + a.m22 * b.y + a.m23 * b.z, a.m31 * b.x + a.m32 * b.y + a.m33 * b.z);
+}
+
+// Multiplies the vector by the transposed matrix, which is the inverse rotation
+inline VECTOR3 tmul(const MATRIX3& a, const VECTOR3& b)
+{
+	return _V(a.m11 * b.x + a.m21 * b.y + a.m31 * b.z, a.m12 * b.x + a.m22 * b.y + a.m32 * b.z, a.m13 * b.x + a.m23 * b.y + a.m33 * b.z);
+}
+
+typedef struct
+{
+	DWORD version;
+	DWORD flag;
+	OBJHANDLE rbody;
+	OBJHANDLE base;
+	int port;
+	int status;    // 0 = free flight, 1 = landed
+	VECTOR3 rpos;
+	VECTOR3 rvel;
+	VECTOR3 vrot;  // The height above the ground in vrot.x if landed
+	VECTOR3 arot;
+	double surf_lng;
+	double surf_lat;
+	double surf_hdg;
+	DWORD nfuel;
+	void* fuel;
+	DWORD nthruster;
+	void* thruster;
+	DWORD ndockinfo;
+	void* dockinfo;
+	DWORD xpdr;
+} VESSELSTATUS2;
+
+typedef struct
+{
+	VECTOR3 pos;
+	double stiffness;
+	double damping;
+	double mu;
+	double mu_lng;
+} TOUCHDOWNVTX;
+
+enum FileAccessMode { FILE_IN, FILE_OUT, FILE_APP, FILE_IN_ZEROONFAIL };
+
+enum PathRoot { ROOT, CONFIG, SCENARIOS, TEXTURES, TEXTURES2, MESHES, MODULES };
+
+#define MESHVIS_NEVER 0x00
+#define MESHVIS_EXTERNAL 0x01
+#define MESHVIS_COCKPIT 0x02
+#define MESHVIS_ALWAYS (MESHVIS_EXTERNAL | MESHVIS_COCKPIT)
+#define MESHVIS_VC 0x04
+
+namespace Headless { struct VesselData; }
+
+// ---------------------------------------------------------------------------------------
+// The vessel classes
+// ---------------------------------------------------------------------------------------
+
+class OAPIFUNC VESSEL
+{
+public:
+	VESSEL(OBJHANDLE hVessel, int fmodel = 1);
+	virtual ~VESSEL();
+
+	OBJHANDLE GetHandle() const;
+	const char* GetName() const;
+	char* GetClassNameA() const;
+
+	double GetSize() const;
+	void SetSize(double size) const;
+	double GetMass() const;
+	double GetEmptyMass() const;
+	void SetEmptyMass(double emptyMass) const;
+	void SetPMI(const VECTOR3& pmi) const;
+	void SetCrossSections(const VECTOR3& cs) const;
+	void SetEnableFocus(bool enable) const;
+	void SetTouchdownPoints(const TOUCHDOWNVTX* tdvtx, DWORD ntdvtx) const;
+
+	PROPELLANT_HANDLE CreatePropellantResource(double maxmass, double mass = -1.0, double efficiency = 1.0) const;
+	PROPELLANT_HANDLE GetPropellantHandleByIndex(DWORD index) const;
+	double GetPropellantMass(PROPELLANT_HANDLE ph) const;
+	void SetPropellantMass(PROPELLANT_HANDLE ph, double mass) const;
+	double GetPropellantMaxMass(PROPELLANT_HANDLE ph) const;
+	double GetFuelMass() const;
+	void SetFuelMass(double mass) const;
+	double GetMaxFuelMass() const;
+
+	bool GroundContact() const;
+	int GetFlightStatus() const;
+	void GetStatusEx(void* status) const;
+	void DefSetStateEx(const void* status) const;
+	bool ParseScenarioLineEx(char* line, void* status) const;
+
+	void GetGlobalPos(VECTOR3& pos) const;
+	void GetRelativePos(OBJHANDLE hRef, VECTOR3& pos) const;
+	void Global2Local(const VECTOR3& glob, VECTOR3& loc) const;
+	void Local2Global(const VECTOR3& loc, VECTOR3& glob) const;
+	void HorizonRot(const VECTOR3& loc, VECTOR3& hor) const;
+	OBJHANDLE GetSurfaceRef() const;
+	OBJHANDLE GetEquPos(double& longitude, double& latitude, double& radius) const;
+
+	ATTACHMENTHANDLE CreateAttachment(bool toparent, const VECTOR3& pos, const VECTOR3& dir, const VECTOR3& rot, const char* id, bool loose = false) const;
+	bool DelAttachment(ATTACHMENTHANDLE attachment) const;
+	void ClearAttachments() const;
+	void SetAttachmentParams(ATTACHMENTHANDLE attachment, const VECTOR3& pos, const VECTOR3& dir, const VECTOR3& rot) const;
+	void GetAttachmentParams(ATTACHMENTHANDLE attachment, VECTOR3& pos, VECTOR3& dir, VECTOR3& rot) const;
+	const char* GetAttachmentId(ATTACHMENTHANDLE attachment) const;
+	OBJHANDLE GetAttachmentStatus(ATTACHMENTHANDLE attachment) const;
+	DWORD AttachmentCount(bool toparent) const;
+	// Throws an exception if the attachment isn't one of this vessel's, where Orbiter raises an access violation
+	DWORD GetAttachmentIndex(ATTACHMENTHANDLE attachment) const;
+	ATTACHMENTHANDLE GetAttachmentHandle(bool toparent, DWORD i) const;
+	bool AttachChild(OBJHANDLE child, ATTACHMENTHANDLE attachment, ATTACHMENTHANDLE child_attachment) const;
+	bool DetachChild(ATTACHMENTHANDLE attachment, double vel = 0.0) const;
+
+	UINT AddMesh(const char* meshname, const VECTOR3* ofs = nullptr) const;
+	UINT AddMesh(MESHHANDLE hMesh, const VECTOR3* ofs = nullptr) const;
+	UINT InsertMesh(const char* meshname, UINT idx, const VECTOR3* ofs = nullptr) const;
+	UINT InsertMesh(MESHHANDLE hMesh, UINT idx, const VECTOR3* ofs = nullptr) const;
+	bool DelMesh(UINT idx, bool retain_anim = false) const;
+	void ClearMeshes() const;
+	void ClearMeshes(bool retain_anim) const;
+	void SetMeshVisibilityMode(UINT idx, WORD mode) const;
+	bool ShiftMesh(UINT idx, const VECTOR3& ofs) const;
+	UINT GetMeshCount() const;
+
+protected:
+	Headless::VesselData* vessel;
+};
+
+// The callbacks are in VESSEL2 as in the SDK. Every vessel of the headless simulation is a VESSEL2
+class OAPIFUNC VESSEL2 : public VESSEL
+{
+public:
+	VESSEL2(OBJHANDLE hVessel, int fmodel = 1);
+
+	virtual void clbkSetClassCaps(FILEHANDLE cfg);
+	virtual void clbkSaveState(FILEHANDLE scn);
+	virtual void clbkLoadStateEx(FILEHANDLE scn, void* status);
+	virtual void clbkSetStateEx(const void* status);
+	virtual void clbkPostCreation();
+	virtual void clbkPreStep(double simt, double simdt, double mjd);
+	virtual void clbkPostStep(double simt, double simdt, double mjd);
+	virtual int clbkConsumeBufferedKey(DWORD key, bool down, char* kstate);
+};
+
+class OAPIFUNC VESSEL3 : public VESSEL2
+{
+public:
+	VESSEL3(OBJHANDLE hVessel, int fmodel = 1);
+};
+
+class OAPIFUNC VESSEL4 : public VESSEL3
+{
+public:
+	VESSEL4(OBJHANDLE hVessel, int fmodel = 1);
+};
+
+// ---------------------------------------------------------------------------------------
+// The API functions. The string parameters are const, so the SDK calls with literals build without warnings
+// ---------------------------------------------------------------------------------------
+
+OAPIFUNC void oapiWriteLog(const char* line);
+OAPIFUNC void oapiWriteLogV(const char* format, ...);
+
+OAPIFUNC double oapiGetSimTime();
+OAPIFUNC double oapiGetSimStep();
+OAPIFUNC double oapiGetSysTime();
+
+OAPIFUNC DWORD oapiGetVesselCount();
+OAPIFUNC OBJHANDLE oapiGetVesselByIndex(int index);
+OAPIFUNC OBJHANDLE oapiGetVesselByName(const char* name);
+OAPIFUNC VESSEL* oapiGetVesselInterface(OBJHANDLE hVessel);
+OAPIFUNC OBJHANDLE oapiGetFocusObject();
+OAPIFUNC VESSEL* oapiGetFocusInterface();
+OAPIFUNC OBJHANDLE oapiSetFocusObject(OBJHANDLE hVessel);
+OAPIFUNC bool oapiIsVessel(OBJHANDLE hVessel);
+OAPIFUNC OBJHANDLE oapiCreateVesselEx(const char* name, const char* classname, const void* status);
+// The vessel is deleted at the start of the next step, as in Orbiter. It stays in the vessel list until then
+OAPIFUNC bool oapiDeleteVessel(OBJHANDLE hVessel, OBJHANDLE hAlternativeCameraTarget = nullptr);
+
+OAPIFUNC OBJHANDLE oapiGetObjectByName(const char* name);
+OAPIFUNC void oapiGetObjectName(OBJHANDLE hObj, char* name, int n);
+OAPIFUNC double oapiGetMass(OBJHANDLE hObj);
+OAPIFUNC double oapiGetSize(OBJHANDLE hObj);
+OAPIFUNC void oapiGetGlobalPos(OBJHANDLE hObj, VECTOR3* pos);
+OAPIFUNC void oapiGetRelativePos(OBJHANDLE hObj, OBJHANDLE hRef, VECTOR3* pos);
+OAPIFUNC void oapiEquToGlobal(OBJHANDLE hObj, double lng, double lat, double rad, VECTOR3* glob);
+
+// The meshes aren't read. A mesh template is a handle to its name, and it's returned only if the mesh file exists
+OAPIFUNC MESHHANDLE oapiLoadMeshGlobal(const char* fname);
+
+OAPIFUNC FILEHANDLE oapiOpenFile(const char* fname, FileAccessMode mode, PathRoot root = ROOT);
+OAPIFUNC void oapiCloseFile(FILEHANDLE f, FileAccessMode mode);
+OAPIFUNC bool oapiReadItem_string(FILEHANDLE f, const char* item, char* string);
+OAPIFUNC bool oapiReadItem_float(FILEHANDLE f, const char* item, double& val);
+OAPIFUNC bool oapiReadItem_int(FILEHANDLE f, const char* item, int& val);
+OAPIFUNC bool oapiReadItem_bool(FILEHANDLE f, const char* item, bool& val);
+OAPIFUNC bool oapiReadItem_vec(FILEHANDLE f, const char* item, VECTOR3& val);
+OAPIFUNC void oapiWriteItem_string(FILEHANDLE f, const char* item, const char* string);
+OAPIFUNC void oapiWriteItem_float(FILEHANDLE f, const char* item, double val);
+OAPIFUNC void oapiWriteItem_int(FILEHANDLE f, const char* item, int val);
+OAPIFUNC void oapiWriteItem_bool(FILEHANDLE f, const char* item, bool val);
+OAPIFUNC void oapiWriteItem_vec(FILEHANDLE f, const char* item, const VECTOR3& val);
+OAPIFUNC void oapiWriteLine(FILEHANDLE f, const char* line);
+
+OAPIFUNC bool oapiReadScenario_nextline(FILEHANDLE scn, char*& line);
+OAPIFUNC void oapiWriteScenario_string(FILEHANDLE scn, const char* item, const char* string);
+OAPIFUNC void oapiWriteScenario_int(FILEHANDLE scn, const char* item, int i);
+OAPIFUNC void oapiWriteScenario_float(FILEHANDLE scn, const char* item, double d);
+OAPIFUNC void oapiWriteScenario_vec(FILEHANDLE scn, const char* item, const VECTOR3& vec);
+
+#define GetClassName GetClassNameA
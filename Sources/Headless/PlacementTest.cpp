@@ -0,0 +1,255 @@
+// =======================================================================================
+// PlacementTest.cpp : Checks the ground release positions against the original placement search.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: PlacementTest [-root <Orbiter folder>]
+// For several row lengths and vessel counts, the carrier releases cargoes on the ground one by one until the release area is full.
+// The release area has a few cargoes at random positions, and the other vessels are 2 to 4 km away. Each released cargo position
+// is compared with the position chosen by the original search, which restarted its scan after every collision, on the same ground cargoes.
+// The time of every release is measured, and the test fails if any position differs.
+
+#include "Carrier.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+	const double STEP = 0.02;
+	const double TOLERANCE = 1e-3;
+	const int OBSTACLE_COUNT = 3;
+
+	const int rowLengths[] = { 4, 10, 25 };
+	const int vesselCounts[] = { 10, 100, 1000 };
+
+	// The ground cargoes near the release position, in the carrier coordinates, as GetGroundList finds them
+	std::vector<VECTOR3> GetGroundList(VESSEL* carrier, VECTOR3 initialPos, int rowLength)
+	{
+		std::vector<VECTOR3> groundList;
+
+		for (DWORD vesselIndex = 0; vesselIndex < oapiGetVesselCount(); vesselIndex++)
+		{
+			VESSEL* cargo = oapiGetVesselInterface(oapiGetVesselByIndex(vesselIndex));
+
+			if (!cargo->GroundContact() || strncmp(cargo->GetClassNameA(), "UCSO", 4) != 0) continue;
+
+			VECTOR3 cargoPos;
+			cargo->GetGlobalPos(cargoPos);
+			carrier->Global2Local(cargoPos, cargoPos);
+
+			VECTOR3 subtract = cargoPos - initialPos;
+
+			if (subtract.x <= 11 && subtract.x >= 3.5 && subtract.z <= rowLength) groundList.push_back(cargoPos);
+		}
+
+		return groundList;
+	}
+
+	// The search before the release placement was bounded, which restarts the scan of the ground cargoes after every collision
+	bool GetOriginalLocation(const std::vector<VECTOR3>& groundList, VECTOR3& initialPos, int rowLength)
+	{
+		initialPos.x += 5;
+
+		double length = 0;
+
+		VECTOR3 releasePos = initialPos;
+
+	loop:
+		for (const VECTOR3& cargoPos : groundList)
+		{
+			VECTOR3 subtract = releasePos - cargoPos;
+
+			if (sqrt(subtract.x * subtract.x + subtract.z * subtract.z) >= 1.5) continue;
+
+			releasePos = initialPos;
+			length += 1.5;
+			releasePos.z += static_cast<int>(length / 6) * 1.5;
+			releasePos.x += length - (static_cast<int>(length / 6) * 6.0);
+			goto loop;
+		}
+
+		if (releasePos.z - initialPos.z > rowLength) return false;
+
+		initialPos = releasePos;
+
+		return true;
+	}
+
+	bool RunTest(int rowLength, int vesselCount)
+	{
+		OBJHANDLE hCarrier = Headless::CreateLandedVessel("Carrier", "HeadlessCarrier", 0, 0, 2);
+
+		if (!hCarrier)
+		{
+			fprintf(stderr, "Couldn't create the carrier. Check that the root folder has the HeadlessCarrier configuration\n");
+			return false;
+		}
+
+		Headless::Carrier* carrier = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hCarrier));
+		UCSO::Vessel* ucso = carrier->ucso;
+
+		if (!ucso->GetUCSOVersion())
+		{
+			fprintf(stderr, "UCSO isn't installed in the root folder\n");
+			return false;
+		}
+
+		ucso->SetCargoRowLength(rowLength);
+
+		int cargoIndex = -1;
+		for (int index = 0; index < ucso->GetAvailableCargoCount(); index++) if (!strcmp(ucso->GetAvailableCargoName(index), "CargoContainer")) cargoIndex = index;
+
+		// The same obstacles for every vessel count of a row length, so only the scanned vessels change
+		std::mt19937 random(rowLength);
+		std::uniform_real_distribution<double> eastDistribution(5, 10);
+		std::uniform_real_distribution<double> northDistribution(0, rowLength);
+
+		for (int obstacle = 0; obstacle < OBSTACLE_COUNT; obstacle++)
+		{
+			std::string name = "Obstacle" + std::to_string(obstacle);
+			Headless::CreateLandedVessel(name.c_str(), "UCSO\\CargoContainer", eastDistribution(random), northDistribution(random), 0.65);
+		}
+
+		for (int filler = 0; filler < vesselCount - OBSTACLE_COUNT - 1; filler++)
+		{
+			double angle = filler * 2.39996322972865332;
+			double distance = 2000 + 2000 * double(filler) / vesselCount;
+
+			std::string name = "Filler" + std::to_string(filler);
+			Headless::CreateLandedVessel(name.c_str(), "UCSO\\CargoFuel", distance * cos(angle), distance * sin(angle), 0.65);
+		}
+
+		Headless::Step(STEP);
+
+		VECTOR3 slotPos, slotDir, slotRot;
+		carrier->GetAttachmentParams(carrier->slotAttachment, slotPos, slotDir, slotRot);
+
+		int releaseCount = 0;
+		double totalTime = 0, maxTime = 0;
+
+		// Fill the release area cell by cell, until the release finds no empty position. The area has 4 cells per 1.5 meters of the row length
+		for (;;)
+		{
+			if (releaseCount > (rowLength / 1.5 + 1) * 4)
+			{
+				fprintf(stderr, "Row length %d, %d vessels: the releases didn't stop at the row length\n", rowLength, vesselCount);
+				return false;
+			}
+
+			if (ucso->AddCargo(cargoIndex, 0) != UCSO::Vessel::GRAPPLE_SUCCEEDED)
+			{
+				fprintf(stderr, "Couldn't add a cargo\n");
+				return false;
+			}
+
+			Headless::Step(STEP);
+
+			OBJHANDLE hCargo = carrier->GetAttachmentStatus(carrier->slotAttachment);
+
+			VECTOR3 expectedPos = slotPos;
+			bool expectedFound = GetOriginalLocation(GetGroundList(carrier, slotPos, rowLength), expectedPos, rowLength);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+			UCSO::Vessel::ReleaseResult result = ucso->ReleaseCargo(0);
+
+			double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+			totalTime += time;
+			maxTime = std::max(maxTime, time);
+
+			if (result == UCSO::Vessel::NO_EMPTY_POSITION)
+			{
+				if (expectedFound)
+				{
+					fprintf(stderr, "Row length %d, %d vessels: release %d found no position, but the original search found (%g, %g)\n",
+						rowLength, vesselCount, releaseCount, expectedPos.x, expectedPos.z);
+					return false;
+				}
+
+				break;
+			}
+
+			if (result != UCSO::Vessel::RELEASE_SUCCEEDED)
+			{
+				fprintf(stderr, "Row length %d, %d vessels: release %d failed with %d\n", rowLength, vesselCount, releaseCount, result);
+				return false;
+			}
+
+			VECTOR3 releasedPos;
+			oapiGetVesselInterface(hCargo)->GetGlobalPos(releasedPos);
+			carrier->Global2Local(releasedPos, releasedPos);
+
+			if (!expectedFound || fabs(releasedPos.x - expectedPos.x) > TOLERANCE || fabs(releasedPos.z - expectedPos.z) > TOLERANCE)
+			{
+				fprintf(stderr, "Row length %d, %d vessels: release %d is at (%g, %g), but the original search %s (%g, %g)\n", rowLength,
+					vesselCount, releaseCount, releasedPos.x, releasedPos.z, expectedFound ? "chose" : "found no position, last tried", expectedPos.x, expectedPos.z);
+				return false;
+			}
+
+			releaseCount++;
+			Headless::Step(STEP);
+		}
+
+		// The last call is the release which found no position
+		printf("%10d %8d %9d %12.1f %12.1f\n", rowLength, vesselCount, releaseCount, totalTime / (releaseCount + 1), maxTime);
+
+		return releaseCount > 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+
+	if (argc == 3 && !strcmp(argv[1], "-root")) root = argv[2];
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: PlacementTest [-root <Orbiter folder>]\n");
+		return 1;
+	}
+
+	// The modules and the configuration files are found from the Orbiter folder, as in Orbiter
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	Headless::Carrier::Register();
+
+	printf("%10s %8s %9s %12s %12s\n", "RowLength", "Vessels", "Releases", "us/release", "max us");
+
+	bool succeeded = true;
+
+	for (int rowLength : rowLengths)
+	{
+		for (int vesselCount : vesselCounts)
+		{
+			succeeded &= RunTest(rowLength, vesselCount);
+
+			// Every configuration runs in a new simulation
+			Headless::CloseSimulation();
+		}
+	}
+
+	return succeeded ? 0 : 1;
+}
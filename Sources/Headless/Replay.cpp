@@ -0,0 +1,236 @@
+// =======================================================================================
+// Replay.cpp : Records the API calls of two carriers and checks that their replay gives the same results.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: Replay [-root <Orbiter folder>]
+// Two carriers record a scripted run to their operation logs: added cargoes, transfers between them, a release, a grapple, and a drain.
+// Then the same scene is created in a new simulation and both logs are replayed. The test fails if the replay reports a mismatch,
+// or if the vessels and the cargo masses at the end differ from the recorded run.
+
+#include "Carrier.h"
+#include <map>
+#include <string>
+#include <unistd.h>
+
+namespace
+{
+	const double STEP = 0.1;
+	const int MAX_REPLAY_STEPS = 100;
+
+	const char* logNames[] = { "ReplayFirst.bin", "ReplaySecond.bin" };
+
+	int warningCount = 0;
+	int finishedCount = 0;
+
+	void CountReplayLines(const char* line)
+	{
+		if (!strncmp(line, "UCSO API Warning", 16) && strstr(line, "replayed")) warningCount++;
+		else if (strstr(line, "finished with 0 mismatches")) finishedCount++;
+	}
+
+	struct Scene
+	{
+		UCSO::Vessel* first = nullptr;
+		UCSO::Vessel* second = nullptr;
+	};
+
+	bool CreateScene(Scene& scene)
+	{
+		OBJHANDLE hFirst = Headless::CreateLandedVessel("First", "HeadlessCarrier", 0, 0, 2);
+		OBJHANDLE hSecond = Headless::CreateLandedVessel("Second", "HeadlessCarrier", 3, 0, 2);
+
+		if (!hFirst || !hSecond)
+		{
+			fprintf(stderr, "Couldn't create the carriers. Check that the root folder has the HeadlessCarrier configuration\n");
+			return false;
+		}
+
+		scene.first = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hFirst))->ucso;
+		scene.second = static_cast<Headless::Carrier*>(oapiGetVesselInterface(hSecond))->ucso;
+
+		if (!scene.first->GetUCSOVersion())
+		{
+			fprintf(stderr, "UCSO isn't installed in the root folder\n");
+			return false;
+		}
+
+		Headless::Step(STEP);
+
+		return true;
+	}
+
+	int GetCargoIndex(UCSO::Vessel* ucso, const char* cargoName)
+	{
+		for (int index = 0; index < ucso->GetAvailableCargoCount(); index++) if (!strcmp(ucso->GetAvailableCargoName(index), cargoName)) return index;
+
+		return -1;
+	}
+
+	// The vessel names with their masses and the cargoes in the carrier slots, which are compared between the recorded run and the replay
+	std::map<std::string, std::string> GetSceneState()
+	{
+		std::map<std::string, std::string> stateMap;
+
+		for (DWORD index = 0; index < oapiGetVesselCount(); index++)
+		{
+			VESSEL* vessel = oapiGetVesselInterface(oapiGetVesselByIndex(index));
+			std::string& state = stateMap[vessel->GetName()];
+
+			state = std::to_string(vessel->GetMass()) + " kg";
+
+			if (strcmp(vessel->GetClassNameA(), "HeadlessCarrier")) continue;
+
+			OBJHANDLE hCargo = vessel->GetAttachmentStatus(static_cast<Headless::Carrier*>(vessel)->slotAttachment);
+
+			state += ", holding ";
+			state += hCargo ? oapiGetVesselInterface(hCargo)->GetName() : "nothing";
+		}
+
+		return stateMap;
+	}
+
+	bool Record(std::map<std::string, std::string>& stateMap)
+	{
+		Scene scene;
+		if (!CreateScene(scene)) return false;
+
+		if (!scene.first->SetOperationLog(logNames[0]) || !scene.second->SetOperationLog(logNames[1]))
+		{
+			fprintf(stderr, "Couldn't open the operation logs\n");
+			return false;
+		}
+
+		// Each call is made in its own step, so the replay order between the carriers doesn't depend on their step order
+		bool succeeded = scene.first->AddCargo(GetCargoIndex(scene.first, "CargoFuel"), 0) == UCSO::Vessel::GRAPPLE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		succeeded &= scene.first->TransferCargo(scene.second, 0, 0) == UCSO::Vessel::TRANSFER_SUCCEEDED;
+		Headless::Step(STEP);
+
+		succeeded &= scene.second->ReleaseCargo(0) == UCSO::Vessel::RELEASE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		succeeded &= scene.first->AddCargo(GetCargoIndex(scene.first, "CargoContainer"), 0) == UCSO::Vessel::GRAPPLE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		succeeded &= scene.second->GrappleCargo(0) == UCSO::Vessel::GRAPPLE_SUCCEEDED;
+		Headless::Step(STEP);
+
+		// The target slot is occupied, so the transfer fails and the cargo returns to the source slot
+		succeeded &= scene.first->TransferCargo(scene.second, 0, 0) == UCSO::Vessel::TRANSFER_SLOT_OCCUPIED;
+		Headless::Step(STEP);
+
+		succeeded &= scene.second->DrainCargoResource("fuel", 10, 0) > 0;
+		Headless::Step(STEP);
+
+		scene.first->SetOperationLog(nullptr);
+		scene.second->SetOperationLog(nullptr);
+
+		if (!succeeded)
+		{
+			fprintf(stderr, "The recorded calls didn't return the expected results\n");
+			return false;
+		}
+
+		stateMap = GetSceneState();
+
+		return true;
+	}
+
+	bool Replay(std::map<std::string, std::string>& stateMap)
+	{
+		Scene scene;
+		if (!CreateScene(scene)) return false;
+
+		if (!scene.first->StartReplay(logNames[0]) || !scene.second->StartReplay(logNames[1]))
+		{
+			fprintf(stderr, "Couldn't load the operation logs\n");
+			return false;
+		}
+
+		for (int step = 0; step < MAX_REPLAY_STEPS; step++)
+		{
+			Headless::Step(STEP);
+
+			int leftCount = scene.first->UpdateReplay();
+			leftCount += scene.second->UpdateReplay();
+
+			if (!leftCount) break;
+		}
+
+		stateMap = GetSceneState();
+
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* root = UCSO_HEADLESS_ROOT;
+
+	if (argc == 3 && !strcmp(argv[1], "-root")) root = argv[2];
+	else if (argc != 1)
+	{
+		fprintf(stderr, "Usage: Replay [-root <Orbiter folder>]\n");
+		return 1;
+	}
+
+	// The modules and the configuration files are found from the Orbiter folder, as in Orbiter
+	if (chdir(root) != 0)
+	{
+		fprintf(stderr, "Couldn't open the root folder %s\n", root);
+		return 1;
+	}
+
+	Headless::Carrier::Register();
+	Headless::SetLogFunction(CountReplayLines);
+
+	std::map<std::string, std::string> recordedMap;
+	bool succeeded = Record(recordedMap);
+
+	Headless::CloseSimulation();
+
+	if (!succeeded) return 1;
+
+	// Count only the warnings of the replay
+	warningCount = 0;
+
+	std::map<std::string, std::string> replayedMap;
+	succeeded = Replay(replayedMap);
+
+	Headless::CloseSimulation();
+
+	if (!succeeded) return 1;
+
+	printf("Recorded vessels: %d, replayed vessels: %d, replay warnings: %d\n", static_cast<int>(recordedMap.size()),
+		static_cast<int>(replayedMap.size()), warningCount);
+
+	if (replayedMap != recordedMap || warningCount > 0 || finishedCount != 2)
+	{
+		fprintf(stderr, "The replay differs from the recorded run\n");
+
+		for (const auto& [name, state] : recordedMap) fprintf(stderr, "Recorded %s: %s\n", name.c_str(), state.c_str());
+		for (const auto& [name, state] : replayedMap) fprintf(stderr, "Replayed %s: %s\n", name.c_str(), state.c_str());
+
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,136 @@
+// =======================================================================================
+// SnapshotTest.cpp : Checks that the inventory snapshots read back the written cargo records.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+// Usage: SnapshotTest
+// The records of every cargo type are written to a snapshot and read back, and every field is compared.
+// Every truncation of the snapshot must be rejected, and the escaped vessel names must be safe file names.
+
+#include "../API/Helper.h"
+#include <cstdio>
+
+namespace
+{
+	UCSO::CargoRecord MakeRecord(const char* name, const char* className, double mass, int type)
+	{
+		UCSO::CargoRecord record = { };
+		record.name = name;
+		record.className = className;
+		record.mass = mass;
+
+		UCSO::DataStruct& dataStruct = record.dataStruct;
+		dataStruct.type = type;
+		dataStruct.netMass = mass - 85;
+		dataStruct.unpackingType = UCSO::Vessel::ORBITER_VESSEL;
+		dataStruct.unpackedHeight = 1.25;
+		dataStruct.unpackingMode = UCSO::Vessel::DELAYING;
+		dataStruct.unpackingDelay = 30;
+
+		return record;
+	}
+
+	bool IsSameRecord(const UCSO::CargoRecord& first, const UCSO::CargoRecord& second)
+	{
+		const UCSO::DataStruct& firstData = first.dataStruct;
+		const UCSO::DataStruct& secondData = second.dataStruct;
+
+		return first.name == second.name && first.className == second.className && first.mass == second.mass &&
+			firstData.type == secondData.type && firstData.netMass == secondData.netMass && firstData.resource == secondData.resource &&
+			firstData.unpackingType == secondData.unpackingType && firstData.spawnCount == secondData.spawnCount &&
+			firstData.unpacked == secondData.unpacked && firstData.breathable == secondData.breathable &&
+			firstData.unpackedHeight == secondData.unpackedHeight && firstData.spawnName == secondData.spawnName &&
+			firstData.spawnModule == secondData.spawnModule && firstData.unpackingMode == secondData.unpackingMode &&
+			firstData.unpackingDelay == secondData.unpackingDelay;
+	}
+
+	bool RunTest()
+	{
+		std::map<int, UCSO::CargoRecord> recordMap;
+
+		recordMap[0] = MakeRecord("Container 1", "UCSO/CargoContainer", 200, UCSO::Vessel::STATIC);
+
+		recordMap[2] = MakeRecord("Fuel", "UCSO/CargoFuel", 1085.5, UCSO::Vessel::RESOURCE);
+		recordMap[2].dataStruct.resource = "fuel";
+
+		recordMap[5] = MakeRecord("Life module", "UCSO/CargoLifeModule", 785, UCSO::Vessel::PACKABLE_UNPACKABLE);
+		recordMap[5].dataStruct.unpacked = true;
+		recordMap[5].dataStruct.breathable = true;
+		recordMap[5].dataStruct.spawnCount = 3;
+		recordMap[5].dataStruct.spawnName = "Rover";
+		recordMap[5].dataStruct.spawnModule = "UCSO\\Rover";
+
+		recordMap[-1] = MakeRecord("", "", 0, UCSO::Vessel::UNPACKABLE_ONLY);
+
+		std::string snapshot = UCSO::WriteInventorySnapshot(recordMap);
+
+		std::map<int, UCSO::CargoRecord> readMap;
+
+		if (!UCSO::ReadInventorySnapshot(snapshot.data(), snapshot.size(), readMap) || readMap.size() != recordMap.size())
+		{
+			fprintf(stderr, "The snapshot wasn't read back\n");
+			return false;
+		}
+
+		for (auto const& recordPair : recordMap)
+		{
+			auto readIt = readMap.find(recordPair.first);
+
+			if (readIt == readMap.end() || !IsSameRecord(recordPair.second, readIt->second))
+			{
+				fprintf(stderr, "The record of slot %d wasn't read back as written\n", recordPair.first);
+				return false;
+			}
+		}
+
+		// A truncated snapshot is rejected, and the read records are left unchanged
+		for (size_t size = 0; size < snapshot.size(); size++)
+		{
+			if (UCSO::ReadInventorySnapshot(snapshot.data(), size, readMap) || readMap.size() != recordMap.size())
+			{
+				fprintf(stderr, "The snapshot truncated to %zu bytes wasn't rejected\n", size);
+				return false;
+			}
+		}
+
+		const char* names[][2] = { { "GL-01", "GL-01" }, { "My ship", "My%20ship" }, { "A_B", "A%5FB" }, { "..\\..\\x/y:z", "..%5C..%5Cx%2Fy%3Az" } };
+
+		for (auto const& name : names)
+		{
+			std::string escapedName = UCSO::EscapeFileName(name[0]);
+
+			if (escapedName != name[1])
+			{
+				fprintf(stderr, "The name %s was escaped as %s instead of %s\n", name[0], escapedName.c_str(), name[1]);
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main()
+{
+	if (!RunTest()) return 1;
+
+	printf("The inventory snapshot was read back as written\n");
+
+	return 0;
+}
@@ -0,0 +1,229 @@
+// =======================================================================================
+// Pallet.cpp : The pallet vessel's class.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+
+#include "Pallet.h"
+#include <algorithm>
+#include <sstream>
+
+DLLCLBK VESSEL* ovcInit(OBJHANDLE hvessel, int flightmodel) { return new UCSO::Pallet(hvessel, flightmodel); }
+
+DLLCLBK void ovcExit(VESSEL* vessel) { if (vessel) delete static_cast<UCSO::Pallet*>(vessel); }
+
+std::map<std::string, std::string> UCSO::Pallet::packedMeshMap;
+
+UCSO::Pallet::Pallet(OBJHANDLE hObj, int fmodel) : VESSEL4(hObj, fmodel) { }
+
+void UCSO::Pallet::clbkSetClassCaps(FILEHANDLE cfg)
+{
+	oapiReadItem_float(cfg, "Mass", palletMass);
+
+	// The attachment which identifies the vessel as a pallet for the vessels' API
+	CreateAttachment(true, { 0, -0.65, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, "UCSO_PL");
+
+	SetPalletCaps(false);
+}
+
+void UCSO::Pallet::clbkLoadStateEx(FILEHANDLE scn, void* status)
+{
+	char* line;
+
+	while (oapiReadScenario_nextline(scn, line))
+	{
+		std::istringstream ss;
+		ss.str(line);
+		std::string data;
+
+		if (ss >> data && data == "PalletCargo")
+		{
+			VECTOR3 pos = { 0, 0, 0 };
+			CargoRecord record;
+
+			ss >> pos.x >> pos.z >> record.className >> record.name;
+
+			if (!ReadCargoRecord(ss, record))
+			{
+				oapiWriteLog("UCSO Warning: Couldn't load a pallet cargo from the scenario");
+				continue;
+			}
+
+			InsertItem(record, pos);
+		}
+		else ParseScenarioLineEx(line, status);
+	}
+
+	SetPalletCaps(false);
+}
+
+void UCSO::Pallet::clbkSaveState(FILEHANDLE scn)
+{
+	// Set the default state
+	VESSEL4::clbkSaveState(scn);
+
+	for (Item& item : itemList)
+	{
+		std::ostringstream ss;
+		ss.precision(12);
+
+		ss << item.pos.x << ' ' << item.pos.z << ' ' << item.record.className << ' ' << item.record.name << ' ';
+		WriteCargoRecord(ss, item.record);
+
+		std::string line = ss.str();
+
+		oapiWriteScenario_string(scn, "PalletCargo", &line[0]);
+	}
+}
+
+int UCSO::Pallet::GetItemCount() { return itemList.size(); }
+
+bool UCSO::Pallet::GetItem(int index, CargoRecord& record, VECTOR3& pos)
+{
+	if (index < 0 || index >= static_cast<int>(itemList.size())) return false;
+
+	record = itemList[index].record;
+	pos = itemList[index].pos;
+
+	return true;
+}
+
+void UCSO::Pallet::AddItem(const CargoRecord& record, VECTOR3 pos)
+{
+	InsertItem(record, pos);
+
+	SetPalletCaps();
+}
+
+void UCSO::Pallet::RemoveItem(int index)
+{
+	if (index < 0 || index >= static_cast<int>(itemList.size())) return;
+
+	DelMesh(itemList[index].meshIndex);
+
+	itemList.erase(itemList.begin() + index);
+
+	SetPalletCaps();
+}
+
+std::string UCSO::Pallet::GetPackedMesh(const std::string& className)
+{
+	RuntimeStatistics* runtime = GetRuntimeStatistics();
+
+	auto meshIt = packedMeshMap.find(className);
+
+	if (meshIt != packedMeshMap.end())
+	{
+		if (runtime) runtime->meshCacheHits++;
+
+		return meshIt->second;
+	}
+
+	if (runtime) runtime->meshCacheMisses++;
+
+	std::string configFile = "Vessels/";
+	configFile += className;
+	configFile += ".cfg";
+
+	std::string packedMesh;
+
+	FILEHANDLE configHandle = oapiOpenFile(configFile.c_str(), FILE_IN_ZEROONFAIL, CONFIG);
+
+	if (configHandle)
+	{
+		char buffer[512];
+
+		if (oapiReadItem_string(configHandle, "PackedMesh", buffer)) packedMesh = buffer;
+
+		oapiCloseFile(configHandle, FILE_IN_ZEROONFAIL);
+	}
+
+	if (packedMesh.empty()) oapiWriteLogV("UCSO Warning: Couldn't read the packed mesh of %s for the pallet", className.c_str());
+
+	packedMeshMap[className] = packedMesh;
+
+	return packedMesh;
+}
+
+void UCSO::Pallet::InsertItem(const CargoRecord& record, VECTOR3 pos)
+{
+	pos.y = 0;
+
+	std::string packedMesh = GetPackedMesh(record.className);
+
+	// Add the cargo mesh at its position, so the cargo looks the same as before
+	UINT meshIndex = packedMesh.empty() ? static_cast<UINT>(-1) : AddMesh(packedMesh.c_str(), &pos);
+
+	itemList.push_back({ record, pos, meshIndex });
+}
+
+void UCSO::Pallet::SetPalletCaps(bool init)
+{
+	double mass = palletMass;
+
+	// The pallet bounds, which are the cargo bounds as every cargo is 1.3m size
+	double minX = -0.65, maxX = 0.65, minZ = -0.65, maxZ = 0.65;
+
+	for (Item& item : itemList)
+	{
+		mass += item.record.mass;
+
+		minX = std::min(minX, item.pos.x - 0.65);
+		maxX = std::max(maxX, item.pos.x + 0.65);
+		minZ = std::min(minZ, item.pos.z - 0.65);
+		maxZ = std::max(maxZ, item.pos.z + 0.65);
+	}
+
+	SetEmptyMass(mass);
+
+	SetSize(std::max(std::max(-minX, maxX), std::max(-minZ, maxZ)));
+
+	VESSELSTATUS2 status;
+
+	// If Orbiter is initiated, which means a cargo was added or removed
+	if (init)
+	{
+		memset(&status, 0, sizeof(status));
+		status.version = 2;
+		GetStatusEx(&status);
+	}
+
+	double stiffness = GetMass() * G * 1000;
+	double damping = 0.9 * (2 * sqrt(GetMass() * stiffness));
+
+	// The bounds always contain the origin, which is the center of gravity. The front point is at x = 0 so the triangle contains it too,
+	// otherwise the pallet would tip over when the cargoes are on one side
+	TOUCHDOWNVTX tdvtx[4] =
+	{
+	{{ maxX, -0.65, minZ }, stiffness, damping, 3, 3},
+	{{ 0, -0.65, maxZ }, stiffness, damping, 3, 3},
+	{{ minX, -0.65, minZ }, stiffness, damping, 3, 3},
+	{{ 0, 19.5, 0 }, stiffness, damping, 3, 3}
+	};
+
+	SetTouchdownPoints(tdvtx, 4);
+
+	// If the pallet is landed, set the status again as the touchdown points changed
+	if (init && status.status)
+	{
+		SetGroundRotation(status, 0.65);
+
+		DefSetStateEx(&status);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+// =======================================================================================
+// Pallet.h : The pallet vessel's header.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+
+#pragma once
+#include "..\API\Helper.h"
+#include <vector>
+#include <map>
+
+namespace UCSO
+{
+	class Pallet : public VESSEL4
+	{
+	public:
+		Pallet(OBJHANDLE hObj, int fmodel);
+
+		void clbkSetClassCaps(FILEHANDLE cfg) override;
+		void clbkLoadStateEx(FILEHANDLE scn, void* status) override;
+		void clbkSaveState(FILEHANDLE scn) override;
+
+		// Returns the count of the cargoes on the pallet.
+		virtual int GetItemCount();
+
+		// Gets the cargo record and its position in the pallet frame. Returns false if the index is invalid.
+		virtual bool GetItem(int index, CargoRecord& record, VECTOR3& pos);
+
+		// Adds the cargo to the pallet at the passed position in the pallet frame.
+		virtual void AddItem(const CargoRecord& record, VECTOR3 pos);
+
+		// Removes the cargo from the pallet.
+		virtual void RemoveItem(int index);
+
+	private:
+		struct Item
+		{
+			CargoRecord record;
+			VECTOR3 pos;
+			UINT meshIndex;
+		};
+
+		std::vector<Item> itemList;
+		double palletMass = 50;
+
+		static std::map<std::string, std::string> packedMeshMap; // The packed meshes by the class names, so every configuration file is read once
+
+		static std::string GetPackedMesh(const std::string& className);
+		void InsertItem(const CargoRecord& record, VECTOR3 pos);
+		void SetPalletCaps(bool init = true);
+	};
+}
\ No newline at end of file
@@ -20,12 +20,16 @@
 // =======================================================================================
 
 #include "LampCargo.h"
-#include <sstream>
+#include <string>
+#include <cstdlib>
 
 DLLCLBK VESSEL* ovcInit(OBJHANDLE hvessel, int flightmodel) { return new LampCargo(hvessel, flightmodel); }
 
 DLLCLBK void ovcExit(VESSEL* vessel) { if (vessel) delete static_cast<LampCargo*>(vessel); }
 
+MESHHANDLE LampCargo::packedMesh = nullptr;
+MESHHANDLE LampCargo::unpackedMesh = nullptr;
+
 LampCargo::LampCargo(OBJHANDLE hVessel, int flightmodel) : VESSEL4(hVessel, flightmodel)
 {
 	// Set cargo information
@@ -46,6 +50,16 @@ void LampCargo::clbkSetClassCaps(FILEHANDLE cfg)
 		spotStruct.att0, spotStruct.att1, spotStruct.att2, spotStruct.umbra, spotStruct.penumbra,
 		spotStruct.diffuse, spotStruct.specular, spotStruct.ambient));
 
+	// Load the meshes if this is the first instance
+	if (!packedMesh) packedMesh = oapiLoadMeshGlobal("UCSO/Container3");
+	if (!unpackedMesh) unpackedMesh = oapiLoadMeshGlobal("UCSO/Lamp");
+
+	packedMeshIndex = AddMesh(packedMesh);
+	unpackedMeshIndex = AddMesh(unpackedMesh);
+
+	// Hide the unpacked mesh, as the cargo is packed by default
+	SetMeshVisibilityMode(unpackedMeshIndex, MESHVIS_NEVER);
+
 	// Set the cargo properties. 
 	// It is set here (not in clbkLoadStateEx) because that method won't be called if the vessel is spawned in the simulator.
 	// So if it is spawned in the simulator, set its default properties which is a packed cargo.
@@ -55,22 +69,16 @@ void LampCargo::clbkSetClassCaps(FILEHANDLE cfg)
 void LampCargo::clbkLoadStateEx(FILEHANDLE scn, void* status)
 {
 	char* line;
+	const char* value;
 
 	while (oapiReadScenario_nextline(scn, line))
 	{
-		std::istringstream ss;
-		ss.str(line);
-		std::string data;
-
-		if (ss >> data)
-		{
-			if (data == "Unpacked") ss >> cargoInfo.unpacked;
-			else ParseScenarioLineEx(line, status);
-
-			if (cargoInfo.unpacked) SetUnpackedCaps(false);
-		}
+		// Compare the key in place, so no string or stream is made for every line
+		if ((value = GetScenarioItem(line, "Unpacked"))) cargoInfo.unpacked = strtol(value, nullptr, 10) != 0;
 		else ParseScenarioLineEx(line, status);
 	}
+
+	if (cargoInfo.unpacked) SetUnpackedCaps(false);
 }
 
 void LampCargo::clbkPreStep(double simt, double simdt, double mjd)
@@ -142,7 +150,8 @@ void LampCargo::SetPackedCaps()
 	spotLight->Activate(false);
 
 	// Replace the unpacked mesh with the packed mesh
-	InsertMesh("UCSO/Container3", 0);
+	SetMeshVisibilityMode(unpackedMeshIndex, MESHVIS_NEVER);
+	SetMeshVisibilityMode(packedMeshIndex, MESHVIS_EXTERNAL);
 
 	SetEmptyMass(325);
 
@@ -185,7 +194,9 @@ void LampCargo::SetUnpackedCaps(bool init)
 	beaconStruct.beaconSpec.active = true;
 	spotLight->Activate(true);
 		
-	InsertMesh("UCSO/Lamp", 0);
+	// Replace the packed mesh with the unpacked mesh
+	SetMeshVisibilityMode(packedMeshIndex, MESHVIS_NEVER);
+	SetMeshVisibilityMode(unpackedMeshIndex, MESHVIS_EXTERNAL);
 
 	SetSize(UNPACKED_SIZE);
 
@@ -56,6 +56,14 @@ private:
 	UCSO::CustomCargo::CargoInfo cargoInfo;
 	ATTACHMENTHANDLE attachmentHandle = nullptr;
 
+	// The meshes are loaded once as global templates for all instances. Each instance inserts both meshes,
+	// and only switches their visibility when packing and unpacking, so no mesh file is loaded then.
+	static MESHHANDLE packedMesh;
+	static MESHHANDLE unpackedMesh;
+
+	UINT packedMeshIndex = 0;
+	UINT unpackedMeshIndex = 0;
+
 	void SetPackedCaps();
 	void SetUnpackedCaps(bool init = true);
 };
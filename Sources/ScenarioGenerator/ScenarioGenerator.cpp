@@ -0,0 +1,395 @@
+// =======================================================================================
+// ScenarioGenerator.cpp : Generates UCSO stress test scenarios from a seed.
+// Copyright  2020-2021 Abdullah Radwan. All rights reserved.
+//
+// This file is part of UCSO.
+//
+// UCSO is free software : you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// UCSO is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with UCSO. If not, see <https://www.gnu.org/licenses/>.
+//
+// =======================================================================================
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <map>
+
+namespace
+{
+	const double PI = 3.14159265358979323846;
+	const double MOON_RADIUS = 1737400;
+
+	// The base positions and the dates are the same as the shipped scenarios
+	const double BASE_LNG = -16.4530000;
+	const double BASE_LAT = 22.1020000;
+	const double SURFACE_MJD = 58710.4993091673;
+
+	const double BASE_RPOS[3] = { -3139470.461, 226082.591, 5960138.414 };
+	const double BASE_RVEL[3] = { -6799.0937, -485.8713, -3522.3854 };
+	const double ORBIT_MJD = 58710.4862212984;
+
+	const double PACKED_HEIGHT = 0.65;
+	const double CARRIER_HEIGHT = 1.465;
+
+	enum CargoType
+	{
+		STATIC = 0,
+		RESOURCE,
+		PACKABLE_UNPACKABLE,
+		UNPACKABLE_ONLY,
+		CUSTOM
+	};
+
+	enum UnpackingType
+	{
+		NO_UNPACKING = -1,
+		UCSO_RESOURCE = 0,
+		UCSO_MODULE,
+		ORBITER_VESSEL
+	};
+
+	// The shipped cargoes, as set in their configuration files
+	struct CargoClass
+	{
+		const char* name;
+		int type;
+		int unpackingType;
+		double unpackedHeight;
+		bool resource;
+	};
+
+	const CargoClass cargoClasses[] =
+	{
+		{ "CargoContainer", STATIC, NO_UNPACKING, 0, false },
+		{ "CargoFuel", RESOURCE, NO_UNPACKING, 0, true },
+		{ "CargoFlagChina", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagEgypt", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagEurope", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagIndia", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagJapan", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagRussia", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoFlagUS", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.45, false },
+		{ "CargoLifeModule", PACKABLE_UNPACKABLE, UCSO_MODULE, 1.95, false },
+		{ "CargoTableChairs", PACKABLE_UNPACKABLE, UCSO_MODULE, 0.68, false },
+		{ "CargoFuelTank", UNPACKABLE_ONLY, UCSO_RESOURCE, 1.25, true },
+		{ "CargoSolarPanel", UNPACKABLE_ONLY, UCSO_MODULE, 0.55, false },
+		{ "CargoShuttlePB", UNPACKABLE_ONLY, ORBITER_VESSEL, 0, false },
+		{ "CargoCustomLamp", CUSTOM, UCSO_MODULE, 2.9, false }
+	};
+
+	const CargoClass& pendingClass = cargoClasses[13];
+
+	struct Options
+	{
+		unsigned int seed = 1;
+		int cargoCount = 100;
+		int stationCount = 0;
+		std::string stationClass;
+		double stationHeight = 0;
+		int carrierCount = 0;
+		int pendingCount = 0;
+		bool orbit = false;
+		double spacing = 5;
+		std::string fileName;
+	};
+
+	// The grid position relative to the base in meters, x to the east and z to the north on the surface
+	struct Position
+	{
+		double x;
+		double z;
+		double heading;
+	};
+
+	class Generator
+	{
+	public:
+		Generator(const Options& options) : options(options), random(options.seed)
+		{
+			// Group the cargo classes by the type and the unpacking type, so each combination is equally likely
+			for (const CargoClass& cargoClass : cargoClasses)
+				classGroups[cargoClass.type * 10 + cargoClass.unpackingType].push_back(&cargoClass);
+		}
+
+		bool Generate()
+		{
+			file = fopen(options.fileName.c_str(), "w");
+
+			if (!file) { fprintf(stderr, "Couldn't open %s\n", options.fileName.c_str()); return false; }
+
+			InitGrid(1 + options.cargoCount + options.carrierCount + options.pendingCount);
+
+			WriteHeader();
+
+			fprintf(file, "BEGIN_SHIPS\n");
+
+			BeginVessel("ShuttlePB", "ShuttlePB_UCSO");
+			WriteStatus(NextPosition(), CARRIER_HEIGHT);
+			fprintf(file, "  AFCMODE 7\n  PRPLEVEL 0:1.000000\nEND\n");
+
+			for (int station = 0; station < options.stationCount; station++) WriteStation(station);
+
+			for (int carrier = 0; carrier < options.carrierCount; carrier++) WriteCarrier();
+
+			for (int cargo = 0; cargo < options.cargoCount; cargo++) WriteCargo(PickCargoClass(), NextPosition(), nullptr);
+
+			for (int cargo = 0; cargo < options.pendingCount; cargo++) WritePendingCargo();
+
+			fprintf(file, "END_SHIPS\n");
+
+			fclose(file);
+
+			return true;
+		}
+
+	private:
+		const Options& options;
+		std::mt19937 random;
+		FILE* file = nullptr;
+
+		std::map<int, std::vector<const CargoClass*>> classGroups;
+		std::map<std::string, int> nameCounts;
+		std::vector<Position> grid;
+		size_t gridIndex = 0;
+		double gridSize = 0;
+
+		// The standard distributions aren't the same between compilers, so the random values are taken directly from the engine
+		double Uniform(double min, double max) { return min + (max - min) * (random() / 4294967296.0); }
+
+		int Index(int count) { return static_cast<int>(random() % static_cast<uint32_t>(count)); }
+
+		void InitGrid(int count)
+		{
+			// Use twice the needed cells, so the vessels are spread with gaps between them
+			int rowLength = static_cast<int>(ceil(sqrt(count * 2.0)));
+			gridSize = rowLength * options.spacing;
+
+			for (int row = 0; row < rowLength; row++)
+				for (int column = 0; column < rowLength; column++)
+					grid.push_back({ (column - rowLength / 2) * options.spacing, (row - rowLength / 2) * options.spacing, 0 });
+
+			// Shuffle the cells, as std::shuffle isn't the same between compilers
+			for (int index = static_cast<int>(grid.size()) - 1; index > 0; index--) std::swap(grid[index], grid[Index(index + 1)]);
+
+			for (Position& position : grid) position.heading = 90 * Index(4);
+		}
+
+		Position NextPosition() { return grid[gridIndex++]; }
+
+		const CargoClass& PickCargoClass()
+		{
+			std::map<int, std::vector<const CargoClass*>>::iterator group = classGroups.begin();
+			std::advance(group, Index(static_cast<int>(classGroups.size())));
+
+			return *group->second[Index(static_cast<int>(group->second.size()))];
+		}
+
+		std::string GetName(const std::string& baseName) { return baseName + std::to_string(++nameCounts[baseName]); }
+
+		void WriteHeader()
+		{
+			fprintf(file, "BEGIN_DESC\n");
+			fprintf(file, "UCSO stress scenario generated from seed %u: %d cargoes, %d stations, %d carriers, %d pending unpacks %s.\n",
+				options.seed, options.cargoCount, options.stationCount, options.carrierCount, options.pendingCount,
+				options.orbit ? "in low Earth orbit" : "on the Moon");
+			fprintf(file, "END_DESC\n\n");
+
+			fprintf(file, "BEGIN_ENVIRONMENT\n  System Sol\n  Date MJD %.10f\nEND_ENVIRONMENT\n\n", options.orbit ? ORBIT_MJD : SURFACE_MJD);
+
+			fprintf(file, "BEGIN_FOCUS\n  Ship ShuttlePB\nEND_FOCUS\n\n");
+
+			fprintf(file, "BEGIN_CAMERA\n  TARGET ShuttlePB\n  MODE Extern\n  FOV 50.00\nEND_CAMERA\n\n");
+
+			fprintf(file, "BEGIN_HUD\n  TYPE %s\nEND_HUD\n\n", options.orbit ? "Orbit" : "Surface");
+		}
+
+		void BeginVessel(const std::string& name, const std::string& className) { fprintf(file, "%s:%s\n", name.c_str(), className.c_str()); }
+
+		void WriteStatus(const Position& position, double height)
+		{
+			if (options.orbit)
+			{
+				// Spread the vessels on a plane in the orbit, with the same velocity
+				fprintf(file, "  STATUS Orbiting Earth\n");
+				fprintf(file, "  RPOS %.3f %.3f %.3f\n", BASE_RPOS[0] + position.x, BASE_RPOS[1], BASE_RPOS[2] + position.z);
+				fprintf(file, "  RVEL %.4f %.4f %.4f\n", BASE_RVEL[0], BASE_RVEL[1], BASE_RVEL[2]);
+				fprintf(file, "  AROT 0.000 0.000 %.3f\n", position.heading);
+
+				return;
+			}
+
+			double lat = BASE_LAT + position.z / MOON_RADIUS * 180 / PI;
+			double lng = BASE_LNG + position.x / (MOON_RADIUS * cos(BASE_LAT * PI / 180)) * 180 / PI;
+
+			double arot[3];
+			GetGroundRotation(lng * PI / 180, lat * PI / 180, position.heading * PI / 180, arot);
+
+			fprintf(file, "  STATUS Landed Moon\n");
+			fprintf(file, "  POS %.7f %.7f\n", lng, lat);
+			fprintf(file, "  HEADING %.2f\n", position.heading);
+			fprintf(file, "  ALT %.3f\n", height);
+			fprintf(file, "  AROT %.3f %.3f %.3f\n", arot[0] * 180 / PI, arot[1] * 180 / PI, arot[2] * 180 / PI);
+		}
+
+		void WriteStation(int station)
+		{
+			// Place the stations around the grid, so they don't overlap the cargoes
+			double angle = 2 * PI * station / options.stationCount;
+			double range = gridSize / 2 + 100;
+
+			BeginVessel(GetName("Station"), options.stationClass);
+			WriteStatus({ range * cos(angle), range * sin(angle), Uniform(0, 360) }, options.stationHeight);
+			fprintf(file, "  AFCMODE 7\nEND\n");
+		}
+
+		void WriteCarrier()
+		{
+			std::string name = GetName("Carrier");
+			Position position = NextPosition();
+
+			BeginVessel(name, "ShuttlePB_UCSO");
+			WriteStatus(position, CARRIER_HEIGHT);
+			fprintf(file, "  AFCMODE 7\n  PRPLEVEL 0:1.000000\nEND\n");
+
+			// Fill the carrier slot
+			WriteCargo(PickCargoClass(), position, &name);
+		}
+
+		void WriteCargo(const CargoClass& cargoClass, const Position& position, const std::string* carrier)
+		{
+			bool unpacked = false;
+
+			// Attached cargoes are always packed
+			if (!carrier && cargoClass.type != STATIC && cargoClass.type != RESOURCE && cargoClass.unpackingType != ORBITER_VESSEL)
+				unpacked = Index(2) == 1;
+
+			BeginVessel(GetName(cargoClass.name), std::string("UCSO\\") + cargoClass.name);
+			WriteStatus(position, carrier ? CARRIER_HEIGHT : (unpacked ? cargoClass.unpackedHeight : PACKED_HEIGHT));
+
+			if (carrier) fprintf(file, "  ATTACHED 0:0,%s\n", carrier->c_str());
+
+			fprintf(file, "  AFCMODE 7\n");
+
+			if (cargoClass.resource) fprintf(file, "  PRPLEVEL 0:1.000000\n");
+
+			if (cargoClass.type != STATIC && cargoClass.type != RESOURCE && cargoClass.unpackingType != ORBITER_VESSEL)
+				fprintf(file, "  Unpacked %d\n", unpacked);
+
+			fprintf(file, "END\n");
+		}
+
+		void WritePendingCargo()
+		{
+			BeginVessel(GetName(pendingClass.name), std::string("UCSO\\") + pendingClass.name);
+			WriteStatus(NextPosition(), PACKED_HEIGHT);
+			fprintf(file, "  AFCMODE 7\n");
+
+			// Half of the cargoes wait for the landing, and the other half wait for the delay timer
+			if (Index(2) == 0) fprintf(file, "  Landing 1\n  Timing 0\n  Timer 0\n");
+			else fprintf(file, "  Landing 0\n  Timing 1\n  Timer %.2f\n", Uniform(0, 25));
+
+			fprintf(file, "END\n");
+		}
+
+		// The same rotation as UCSO::SetGroundRotation, so the landed vessels don't move on the first frame
+		static void GetGroundRotation(double lng, double lat, double hdg, double arot[3])
+		{
+			double m[3][3];
+			double rot1[3][3], rot2[3][3], rot3[3][3], rot4[3][3], temp1[3][3], temp2[3][3];
+
+			RotationMatrix(0, PI / 2 - lng, 0, rot1);
+			RotationMatrix(-lat, 0, 0, rot2);
+			RotationMatrix(0, 0, PI + hdg, rot3);
+			RotationMatrix(PI / 2, 0, 0, rot4);
+
+			Multiply(rot3, rot4, temp1);
+			Multiply(rot2, temp1, temp2);
+			Multiply(rot1, temp2, m);
+
+			arot[0] = atan2(m[1][2], m[2][2]);
+			arot[1] = -asin(m[0][2]);
+			arot[2] = atan2(m[0][1], m[0][0]);
+		}
+
+		static void RotationMatrix(double x, double y, double z, double m[3][3])
+		{
+			double rx[3][3] = { { 1, 0, 0 }, { 0, cos(x), -sin(x) }, { 0, sin(x), cos(x) } };
+			double ry[3][3] = { { cos(y), 0, sin(y) }, { 0, 1, 0 }, { -sin(y), 0, cos(y) } };
+			double rz[3][3] = { { cos(z), -sin(z), 0 }, { sin(z), cos(z), 0 }, { 0, 0, 1 } };
+			double temp[3][3];
+
+			Multiply(ry, rz, temp);
+			Multiply(rx, temp, m);
+		}
+
+		static void Multiply(const double a[3][3], const double b[3][3], double m[3][3])
+		{
+			for (int row = 0; row < 3; row++)
+				for (int column = 0; column < 3; column++)
+					m[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column];
+		}
+	};
+
+	void PrintUsage()
+	{
+		printf("Usage: ScenarioGenerator [options] <scenario file>\n");
+		printf("  -seed <number>           The random seed. The same seed and options generate the same scenario. The default is 1.\n");
+		printf("  -cargoes <count>         The free cargoes of mixed types. The default is 100.\n");
+		printf("  -stations <count>        The UCSO stations, which requires -station-class.\n");
+		printf("  -station-class <class>   The station vessel class, which must have a UCSO_ST attachment.\n");
+		printf("  -station-height <meters> The station height above the ground. The default is 0.\n");
+		printf("  -carriers <count>        The ShuttlePB carriers, each with a cargo in its slot.\n");
+		printf("  -pending <count>         The ShuttlePB cargoes with a pending landing or delaying unpacking.\n");
+		printf("  -spacing <meters>        The grid spacing between the vessels. The default is 5 meters.\n");
+		printf("  -orbit                   Place the vessels in low Earth orbit instead of a base on the Moon.\n");
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+
+	for (int arg = 1; arg < argc; arg++)
+	{
+		// If the option has a value
+		bool hasValue = arg + 1 < argc;
+
+		if (!strcmp(argv[arg], "-orbit")) options.orbit = true;
+		else if (!strcmp(argv[arg], "-seed") && hasValue) options.seed = strtoul(argv[++arg], nullptr, 10);
+		else if (!strcmp(argv[arg], "-cargoes") && hasValue) options.cargoCount = atoi(argv[++arg]);
+		else if (!strcmp(argv[arg], "-stations") && hasValue) options.stationCount = atoi(argv[++arg]);
+		else if (!strcmp(argv[arg], "-station-class") && hasValue) options.stationClass = argv[++arg];
+		else if (!strcmp(argv[arg], "-station-height") && hasValue) options.stationHeight = atof(argv[++arg]);
+		else if (!strcmp(argv[arg], "-carriers") && hasValue) options.carrierCount = atoi(argv[++arg]);
+		else if (!strcmp(argv[arg], "-pending") && hasValue) options.pendingCount = atoi(argv[++arg]);
+		else if (!strcmp(argv[arg], "-spacing") && hasValue) options.spacing = atof(argv[++arg]);
+		else if (argv[arg][0] != '-' && options.fileName.empty()) options.fileName = argv[arg];
+		else { PrintUsage(); return 1; }
+	}
+
+	if (options.fileName.empty() || options.cargoCount < 0 || options.stationCount < 0 || options.carrierCount < 0 ||
+		options.pendingCount < 0 || options.spacing <= 0 || (options.stationCount > 0 && options.stationClass.empty()))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	return Generator(options).Generate() ? 0 : 1;
+}